@@ -3,7 +3,7 @@ rem launch this from msvs-enabled console
 
 set CXXFLAGS=/std:c++17 /O2 /FC /Zi /W4 /WX /wd4458 /wd4996 /nologo
 set INCLUDES=/I SDL2\include
-set LIBS=SDL2\lib\x64\SDL2.lib SDL2\lib\x64\SDL2main.lib Shell32.lib
+set LIBS=SDL2\lib\x64\SDL2.lib SDL2\lib\x64\SDL2main.lib Shell32.lib Ws2_32.lib
 
 cl.exe %CXXFLAGS% %INCLUDES% src/config_typer.cpp
 config_typer assets\vars.conf > config_types.hpp
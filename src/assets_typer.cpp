@@ -4,6 +4,62 @@ using namespace aids;
 
 #include "./something_parsers.hpp"
 
+const size_t IDS_TABLE_SEED_ATTEMPTS = 1000000;
+const size_t IDS_TABLE_MAX_SIZE = 1 << 16;
+
+// NOTE: Finds the seed of asset_id_hash() that puts all of the ids
+// into different slots of a table that is at least twice as big as
+// the amount of ids, and prints the table. The empty slots are -1.
+void print_ids_table(const char *prefix, Dynamic_Array<String_View> ids)
+{
+    size_t size = 1;
+    while (size < ids.size * 2) {
+        size *= 2;
+    }
+
+    int *slots = (int*) malloc(sizeof(*slots) * size);
+    assert(slots != NULL);
+    defer(free(slots));
+
+    for (;;) {
+        for (uint32_t seed = 0; seed < IDS_TABLE_SEED_ATTEMPTS; ++seed) {
+            bool collided = false;
+            for (size_t i = 0; i < size; ++i) {
+                slots[i] = -1;
+            }
+
+            for (size_t i = 0; !collided && i < ids.size; ++i) {
+                const size_t slot = asset_id_hash(ids.data[i], seed) & (size - 1);
+                if (slots[slot] >= 0) {
+                    collided = true;
+                } else {
+                    slots[slot] = (int) i;
+                }
+            }
+
+            if (!collided) {
+                println(stdout, "const uint32_t ", prefix, "_IDS_SEED = ", seed, ";");
+                print(stdout, "const int ", prefix, "_IDS_SLOTS[", size, "] = {");
+                for (size_t i = 0; i < size; ++i) {
+                    print(stdout, i == 0 ? "" : ", ", slots[i]);
+                }
+                println(stdout, "};");
+                return;
+            }
+        }
+
+        if (size >= IDS_TABLE_MAX_SIZE) {
+            println(stderr, "ERROR: could not find a seed that puts all of the ",
+                    prefix, " ids into a table of ", IDS_TABLE_MAX_SIZE, " slots");
+            exit(1);
+        }
+
+        size *= 2;
+        slots = (int*) realloc(slots, sizeof(*slots) * size);
+        assert(slots != NULL);
+    }
+}
+
 void usage(FILE *stream)
 {
     println(stream, "Usage: ./assets_typer <assets.conf>");
@@ -25,24 +81,37 @@ int main(int argc, char *argv[])
         read_file_as_string_view(assets_filepath),
         "Could not read file `", assets_filepath, "`");
 
-    int textures_count = 0;
-    int sounds_count = 0;
-    int animats_count = 0;
+    Dynamic_Array<String_View> textures_ids = {};
+    Dynamic_Array<String_View> sounds_ids = {};
+    Dynamic_Array<String_View> animats_ids = {};
+    // NOTE: the ids of all of the types share the namespace of the
+    // generated #defines, and two equal ids would never end up in
+    // different slots of the ids tables
+    Dynamic_Array<String_View> all_ids = {};
 
     println(stdout, "// Generated by ", __FILE__, " from ", assets_filepath);
     parse_vars_conf(assets_content, [&](auto line_number, auto id, auto type, auto) {
+        for (size_t i = 0; i < all_ids.size; ++i) {
+            if (all_ids.data[i] == id) {
+                println(stderr, assets_filepath, ":", line_number, ": ",
+                        "duplicate id ", id);
+                exit(1);
+            }
+        }
+        all_ids.push(id);
+
         if (type == "texture"_sv) {
-            println(stdout, "#define ", id, "_INDEX (Texture_Index {", textures_count, "})");
-            println(stdout, "#define ", id, " assets.textures[", textures_count, "].unwrap");
-            textures_count++;
+            println(stdout, "#define ", id, "_INDEX (Texture_Index {", textures_ids.size, "})");
+            println(stdout, "#define ", id, " assets.textures[", textures_ids.size, "].unwrap");
+            textures_ids.push(id);
         } else if (type == "sound"_sv) {
-            println(stdout, "#define ", id, "_INDEX (Sample_S16_Index {", sounds_count, "})");
-            println(stdout, "#define ", id, " assets.sounds[", sounds_count, "].unwrap");
-            sounds_count++;
+            println(stdout, "#define ", id, "_INDEX (Sample_S16_Index {", sounds_ids.size, "})");
+            println(stdout, "#define ", id, " assets.sounds[", sounds_ids.size, "].unwrap");
+            sounds_ids.push(id);
         } else if (type == "animat"_sv) {
-            println(stdout, "#define ", id, "_INDEX (Frames_Index {", animats_count, "})");
-            println(stdout, "#define ", id, " assets.framesen[", animats_count, "].unwrap");
-            animats_count++;
+            println(stdout, "#define ", id, "_INDEX (Frames_Index {", animats_ids.size, "})");
+            println(stdout, "#define ", id, " assets.framesen[", animats_ids.size, "].unwrap");
+            animats_ids.push(id);
         } else {
             println(stderr, assets_filepath, ":", line_number, ": ",
                     "Unknown type of asset `", type, "`");
@@ -52,5 +121,9 @@ int main(int argc, char *argv[])
         return parse_success();
     });
 
+    print_ids_table("TEXTURE", textures_ids);
+    print_ids_table("SOUND", sounds_ids);
+    print_ids_table("FRAMES", animats_ids);
+
     return 0;
 }
@@ -0,0 +1,419 @@
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#ifdef _MSC_VER
+#include <BaseTsd.h>
+typedef SSIZE_T ssize_t;
+#endif
+
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+
+#define STBI_ONLY_PNG
+#include "./stb_image.h"
+
+#include "./aids.hpp"
+
+using namespace aids;
+
+#include "./something_math.cpp"
+#include "./something_index.hpp"
+#include "./something_sound.hpp"
+#include "./something_parsers.hpp"
+#include "./something_wav.cpp"
+#include "./something_pack.hpp"
+
+struct Baked_Texture
+{
+    String_View id;
+    String_View path;
+    int w;
+    int h;
+    uint32_t *pixels;
+    Atlas_Slot slot;
+};
+
+struct Baked_Sound
+{
+    String_View id;
+    String_View path;
+    Uint8 *samples;
+    Uint32 samples_size;
+};
+
+struct Baked_Frames
+{
+    String_View id;
+    String_View path;
+    uint32_t sprites_offset;
+    uint32_t sprites_count;
+    float duration;
+};
+
+struct Pack_Baker
+{
+    Dynamic_Array<Baked_Texture> textures;
+    Dynamic_Array<Baked_Sound> sounds;
+    Dynamic_Array<Baked_Frames> framesen;
+    Dynamic_Array<Pack_Sprite> sprites;
+    Dynamic_Array<char> strings;
+
+    Pack_String push_string(String_View string);
+    Maybe<size_t> get_texture_by_id(String_View id);
+
+    void bake_texture(String_View id, String_View path);
+    void bake_sound(String_View id, String_View path);
+    void bake_frames(String_View id, String_View path);
+
+    void write(const char *filepath);
+};
+
+static char *string_view_as_cstr(String_View string)
+{
+    char *cstr = (char*) malloc(string.count + 1);
+    assert(cstr != NULL);
+    memcpy(cstr, string.data, string.count);
+    cstr[string.count] = '\0';
+    return cstr;
+}
+
+static uint64_t pack_align(uint64_t offset)
+{
+    return (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+}
+
+Pack_String Pack_Baker::push_string(String_View string)
+{
+    Pack_String result = {(uint32_t) strings.size, (uint32_t) string.count};
+    for (size_t i = 0; i < string.count; ++i) {
+        strings.push(string.data[i]);
+    }
+    return result;
+}
+
+Maybe<size_t> Pack_Baker::get_texture_by_id(String_View id)
+{
+    for (size_t i = 0; i < textures.size; ++i) {
+        if (textures.data[i].id == id) {
+            return {true, i};
+        }
+    }
+    return {};
+}
+
+void Pack_Baker::bake_texture(String_View id, String_View path)
+{
+    println(stdout, "Baking texture ", id, " from ", path, "...");
+
+    char *path_cstr = string_view_as_cstr(path);
+    defer(free(path_cstr));
+
+    Baked_Texture texture = {};
+    texture.id = id;
+    texture.path = path;
+    texture.pixels = (uint32_t *) stbi_load(path_cstr, &texture.w, &texture.h, NULL, 4);
+    if (texture.pixels == NULL) {
+        println(stderr, "[ERROR] Could not load `", path, "` as PNG");
+        exit(1);
+    }
+
+    textures.push(texture);
+}
+
+void Pack_Baker::bake_sound(String_View id, String_View path)
+{
+    println(stdout, "Baking sound ", id, " from ", path, "...");
+
+    Baked_Sound sound = {};
+    sound.id = id;
+    sound.path = path;
+
+    // NOTE: converted into the format of the mixer the same way the
+    // debug build does it (and through the same cache), the samples go
+    // into the pack as they are
+    const Sample_S16 sample = load_wav_as_sample_s16(path);
+    sound.samples = (Uint8*) sample.audio_buf;
+    sound.samples_size = sample.audio_len * (Uint32) sizeof(int16_t);
+
+    sounds.push(sound);
+}
+
+void Pack_Baker::bake_frames(String_View id, String_View path)
+{
+    println(stdout, "Baking animat ", id, " from ", path, "...");
+
+    char *path_cstr = string_view_as_cstr(path);
+    defer(free(path_cstr));
+
+    auto source = read_file_as_string_view(path_cstr);
+    if (!source.has_value) {
+        println(stderr, "Could not load animation file: `", path, "`");
+        exit(1);
+    }
+    defer(free((void*) source.unwrap.data));
+
+    Baked_Frames frames = {};
+    frames.id = id;
+    frames.path = path;
+    frames.sprites_offset = (uint32_t) sprites.size;
+    Maybe<size_t> spritesheet_texture = {};
+
+    auto result = parse_animat_file(source.unwrap, [&](auto line_number, auto entry) {
+        switch (entry.key) {
+        case ANIMAT_KEY_TEXTURE: {
+            spritesheet_texture = get_texture_by_id(entry.texture);
+            if (!spritesheet_texture.has_value) {
+                println(stderr, path, ":", line_number, ": could not find a texture by id `", entry.texture, "`");
+                exit(1);
+            }
+        } break;
+
+        case ANIMAT_KEY_COUNT: {
+            frames.sprites_count = (uint32_t) entry.value;
+            for (size_t i = 0; i < frames.sprites_count; ++i) {
+                sprites.push({});
+            }
+        } break;
+
+        case ANIMAT_KEY_DURATION: {
+            frames.duration = (float) entry.value / 1000.0f;
+        } break;
+
+        case ANIMAT_KEY_FRAME_X:
+        case ANIMAT_KEY_FRAME_Y:
+        case ANIMAT_KEY_FRAME_W:
+        case ANIMAT_KEY_FRAME_H: {
+            Pack_Sprite *sprite = &sprites.data[frames.sprites_offset + entry.frame_index];
+            sprite->texture_index = (uint64_t) spritesheet_texture.unwrap;
+            sprite->srcrect[entry.key - ANIMAT_KEY_FRAME_X] = entry.value;
+        } break;
+        }
+
+        return parse_success();
+    });
+
+    if (result.is_error) {
+        println(stderr, path, ":", result.line, ": ", result.message);
+        exit(1);
+    }
+
+    framesen.push(frames);
+}
+
+static void write_padding(FILE *stream, uint64_t *position, uint64_t offset)
+{
+    assert(*position <= offset);
+    while (*position < offset) {
+        fputc(0, stream);
+        *position += 1;
+    }
+}
+
+static void write_blob(FILE *stream, uint64_t *position, Pack_Blob blob, const void *data)
+{
+    write_padding(stream, position, blob.offset);
+    fwrite(data, 1, blob.size, stream);
+    *position += blob.size;
+}
+
+void Pack_Baker::write(const char *filepath)
+{
+    SDL_Point *sizes = (SDL_Point*) malloc(sizeof(*sizes) * (textures.size + 1));
+    Atlas_Slot *slots = (Atlas_Slot*) malloc(sizeof(*slots) * (textures.size + 1));
+    assert(sizes != NULL);
+    assert(slots != NULL);
+    defer(free(sizes));
+    defer(free(slots));
+    for (size_t i = 0; i < textures.size; ++i) {
+        sizes[i] = {textures.data[i].w, textures.data[i].h};
+    }
+
+    // NOTE: the pages are ASSETS_ATLAS_SIZE no matter what renderer
+    // the release is going to run on, the same size the debug build
+    // picks when the renderer does not limit it
+    Atlas_Layout layout = {};
+    auto failed = layout_atlases(sizes, textures.size, {ASSETS_ATLAS_SIZE, ASSETS_ATLAS_SIZE}, slots, &layout);
+    if (failed.has_value) {
+        println(stderr, "Could not fit texture `", textures.data[failed.unwrap].id, "` into the atlases");
+        exit(1);
+    }
+
+    Pack_Header header = {};
+    memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.version = PACK_VERSION;
+    header.atlases_count = (uint32_t) layout.atlases_count;
+    header.textures_count = (uint32_t) textures.size;
+    header.sounds_count = (uint32_t) sounds.size;
+    header.framesen_count = (uint32_t) framesen.size;
+    header.sprites_count = (uint32_t) sprites.size;
+
+    Pack_Texture *pack_textures = (Pack_Texture*) calloc(textures.size + 1, sizeof(Pack_Texture));
+    Pack_Sound *pack_sounds = (Pack_Sound*) calloc(sounds.size + 1, sizeof(Pack_Sound));
+    Pack_Frames *pack_framesen = (Pack_Frames*) calloc(framesen.size + 1, sizeof(Pack_Frames));
+    Pack_Atlas pack_atlases[ASSETS_ATLASES_CAPACITY] = {};
+    assert(pack_textures != NULL);
+    assert(pack_sounds != NULL);
+    assert(pack_framesen != NULL);
+    defer(free(pack_textures));
+    defer(free(pack_sounds));
+    defer(free(pack_framesen));
+
+    for (size_t i = 0; i < textures.size; ++i) {
+        const Atlas_Slot slot = slots[i];
+        pack_textures[i].id = push_string(textures.data[i].id);
+        pack_textures[i].path = push_string(textures.data[i].path);
+        pack_textures[i].atlas = (uint32_t) slot.atlas;
+        pack_textures[i].rect[0] = slot.rect.x;
+        pack_textures[i].rect[1] = slot.rect.y;
+        pack_textures[i].rect[2] = slot.rect.w;
+        pack_textures[i].rect[3] = slot.rect.h;
+        pack_textures[i].mask_rect[0] = slot.mask_rect.x;
+        pack_textures[i].mask_rect[1] = slot.mask_rect.y;
+        pack_textures[i].mask_rect[2] = slot.mask_rect.w;
+        pack_textures[i].mask_rect[3] = slot.mask_rect.h;
+    }
+
+    for (size_t i = 0; i < sounds.size; ++i) {
+        pack_sounds[i].id = push_string(sounds.data[i].id);
+        pack_sounds[i].path = push_string(sounds.data[i].path);
+    }
+
+    for (size_t i = 0; i < framesen.size; ++i) {
+        pack_framesen[i].id = push_string(framesen.data[i].id);
+        pack_framesen[i].path = push_string(framesen.data[i].path);
+        pack_framesen[i].sprites_offset = framesen.data[i].sprites_offset;
+        pack_framesen[i].sprites_count = framesen.data[i].sprites_count;
+        pack_framesen[i].duration = framesen.data[i].duration;
+    }
+
+    uint64_t offset = pack_align(sizeof(header));
+    auto place = [&](uint64_t size) {
+        Pack_Blob blob = {offset, size};
+        offset = pack_align(offset + size);
+        return blob;
+    };
+
+    header.atlases = place(sizeof(Pack_Atlas) * header.atlases_count);
+    header.textures = place(sizeof(Pack_Texture) * header.textures_count);
+    header.sounds = place(sizeof(Pack_Sound) * header.sounds_count);
+    header.framesen = place(sizeof(Pack_Frames) * header.framesen_count);
+    header.sprites = place(sizeof(Pack_Sprite) * header.sprites_count);
+    header.strings = place(strings.size);
+
+    for (size_t i = 0; i < layout.atlases_count; ++i) {
+        pack_atlases[i].w = layout.atlas_sizes[i].x;
+        pack_atlases[i].h = layout.atlas_sizes[i].y;
+        pack_atlases[i].pitch = layout.atlas_sizes[i].x * 4;
+        pack_atlases[i].pixels = place((uint64_t) pack_atlases[i].pitch * (uint64_t) pack_atlases[i].h);
+    }
+
+    for (size_t i = 0; i < sounds.size; ++i) {
+        pack_sounds[i].samples = place(sounds.data[i].samples_size);
+    }
+
+    FILE *stream = fopen(filepath, "wb");
+    if (stream == NULL) {
+        println(stderr, "Could not open file `", filepath, "`: ", strerror(errno));
+        exit(1);
+    }
+    defer(fclose(stream));
+
+    uint64_t position = 0;
+    write_blob(stream, &position, {0, sizeof(header)}, &header);
+    write_blob(stream, &position, header.atlases, pack_atlases);
+    write_blob(stream, &position, header.textures, pack_textures);
+    write_blob(stream, &position, header.sounds, pack_sounds);
+    write_blob(stream, &position, header.framesen, pack_framesen);
+    write_blob(stream, &position, header.sprites, sprites.data);
+    write_blob(stream, &position, header.strings, strings.data);
+
+    for (size_t i = 0; i < layout.atlases_count; ++i) {
+        const Pack_Atlas *atlas = &pack_atlases[i];
+        void *pixels = calloc(1, atlas->pixels.size);
+        assert(pixels != NULL);
+        defer(free(pixels));
+
+        for (size_t j = 0; j < textures.size; ++j) {
+            const Baked_Texture *texture = &textures.data[j];
+            if (slots[j].atlas == i) {
+                blit_into_atlas(pixels, atlas->pitch,
+                                texture->pixels, texture->w * 4, texture->w, texture->h,
+                                slots[j].rect, false);
+                blit_into_atlas(pixels, atlas->pitch,
+                                texture->pixels, texture->w * 4, texture->w, texture->h,
+                                slots[j].mask_rect, true);
+            }
+        }
+
+        write_blob(stream, &position, atlas->pixels, pixels);
+        println(stdout, "Packed atlas ", i, " (", atlas->w, "x", atlas->h, ")");
+    }
+
+    for (size_t i = 0; i < sounds.size; ++i) {
+        write_blob(stream, &position, pack_sounds[i].samples, sounds.data[i].samples);
+    }
+
+    if (ferror(stream)) {
+        println(stderr, "Could not write file `", filepath, "`: ", strerror(errno));
+        exit(1);
+    }
+
+    println(stdout, "Baked ", textures.size, " textures, ", sounds.size, " sounds and ",
+            framesen.size, " animats into `", filepath, "` (", position, " bytes)");
+}
+
+void usage(FILE *stream)
+{
+    println(stream, "Usage: ./pack_baker <assets.conf> <output.pack>");
+}
+
+int main(int argc, char *argv[])
+{
+    Args args = {argc, argv};
+    args.shift();               // skip the program name
+
+    if (args.empty()) {
+        usage(stderr);
+        println(stderr, "ERROR: path to assets.conf is not provided");
+        exit(1);
+    }
+    auto assets_filepath = args.shift();
+
+    if (args.empty()) {
+        usage(stderr);
+        println(stderr, "ERROR: path to the output pack is not provided");
+        exit(1);
+    }
+    auto pack_filepath = args.shift();
+
+    auto assets_content = unwrap_or_panic(
+        read_file_as_string_view(assets_filepath),
+        "Could not read file `", assets_filepath, "`");
+
+    static Pack_Baker baker = {};
+
+    parse_vars_conf(assets_content, [&](auto line_number, auto id, auto type, auto asset_path) {
+        if (type == "texture"_sv) {
+            baker.bake_texture(id, asset_path);
+        } else if (type == "sound"_sv) {
+            baker.bake_sound(id, asset_path);
+        } else if (type == "animat"_sv) {
+            baker.bake_frames(id, asset_path);
+        } else {
+            println(stderr, assets_filepath, ":", line_number, ": ",
+                    "Unknown type of asset `", type, "`");
+            exit(1);
+        }
+
+        return parse_success();
+    });
+
+    baker.write(pack_filepath);
+
+    return 0;
+}
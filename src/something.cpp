@@ -36,6 +36,7 @@ typedef SSIZE_T ssize_t;
 
 // READ THIS FIRST ---> https://en.wikipedia.org/wiki/Single_Compilation_Unit
 #ifndef SOMETHING_RELEASE
+#  include "something_fmw.cpp"
 // TODO(#173): config autoreloading does not work on Windows
 #  if defined(__linux__)
 #    include "something_fmw_inotify.cpp"
@@ -56,16 +57,21 @@ typedef SSIZE_T ssize_t;
 #include "something_error.cpp"
 #include "something_color.cpp"
 #include "something_render.cpp"
+#include "something_frame_pacer.cpp"
+#include "something_sprite_batch.cpp"
+#include "something_soft_renderer.cpp"
 #include "something_font.cpp"
 #include "something_camera.cpp"
 #include "something_texture.cpp"
 #include "something_sprite.cpp"
 #include "something_tile_grid.cpp"
 #include "something_sound.cpp"
+#include "something_wav.cpp"
 #include "something_entity.cpp"
 #include "something_popup.cpp"
 #include "something_item.cpp"
 #include "something_toolbar.cpp"
+#include "something_save_state.cpp"
 #include "something_commands.cpp"
 #include "something_select_popup.cpp"
 #include "something_edit_field.cpp"
@@ -73,7 +79,14 @@ typedef SSIZE_T ssize_t;
 #include "something_particles.cpp"
 #include "something_background.cpp"
 #include "something_projectile.cpp"
+#include "something_nav.cpp"
+#include "something_snapshot.cpp"
 #include "something_game.cpp"
+#include "something_simulation.cpp"
+#include "something_net.cpp"
 #include "something_main.cpp"
+#include "something_server.cpp"
+#include "something_headless.cpp"
+#include "something_mixer_bench.cpp"
 #include "something_weapon.cpp"
 #include "something_assets.cpp"
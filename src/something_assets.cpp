@@ -1,8 +1,16 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#  include <sys/mman.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif // _WIN32
+
 #include "./something_assets.hpp"
 
 Assets assets = {};
 
-String_View Assets::load_file_into_conf_buffer(const char *filepath)
+String_View Assets::load_file_into_conf_buffer(const char *filepath, char *buffer)
 {
     FILE *conf_file = fopen(filepath, "rb");
     if (!conf_file) {
@@ -32,7 +40,7 @@ String_View Assets::load_file_into_conf_buffer(const char *filepath)
         exit(1);
     }
 
-    size_t n = fread(conf_buffer, 1, m, conf_file);
+    size_t n = fread(buffer, 1, m, conf_file);
     if (ferror(conf_file)) {
         println(stderr, "Could not load file `", filepath, "`: ", strerror(errno));
         exit(1);
@@ -40,45 +48,121 @@ String_View Assets::load_file_into_conf_buffer(const char *filepath)
 
     assert(n == (size_t) m);
 
-    return {(size_t) m, conf_buffer};
+    return {(size_t) m, buffer};
 }
 
-void Assets::load_texture(SDL_Renderer *renderer, String_View id, String_View path)
+SDL_Rect Texture::to_atlas(SDL_Rect srcrect) const
 {
-    assert(textures_count < ASSETS_TEXTURES_CAPACITY);
+    return {rect.x + srcrect.x, rect.y + srcrect.y, srcrect.w, srcrect.h};
+}
 
-    println(stdout, "Loading texture ", id, " from ", path, "...");
+SDL_Rect Texture::to_atlas_mask(SDL_Rect srcrect) const
+{
+    return {mask_rect.x + srcrect.x, mask_rect.y + srcrect.y, srcrect.w, srcrect.h};
+}
 
+void Assets::load_texture(size_t index)
+{
     Texture asset = {};
-    asset.surface = load_png_file_as_surface(path);
-    asset.texture = sec(SDL_CreateTextureFromSurface(renderer, asset.surface));
-    asset.surface_mask = load_png_file_as_surface(path);
+    asset.surface = load_png_file_as_surface(textures[index].path);
+    assert(asset.surface->format->format == SDL_PIXELFORMAT_RGBA32);
+    textures[index].unwrap = asset;
+}
 
-    sec(SDL_LockSurface(asset.surface_mask));
-    assert(asset.surface_mask->format->format == SDL_PIXELFORMAT_RGBA32);
-    for (int row = 0; row < asset.surface_mask->h; ++row) {
-        uint32_t *pixel_row = (uint32_t*) ((uint8_t *) asset.surface_mask->pixels + row * asset.surface_mask->pitch);
-        for (int col = 0; col < asset.surface_mask->w; ++col) {
-            pixel_row[col] = pixel_row[col] | 0x00FFFFFF;
-        }
+void Assets::blit_texture(size_t index)
+{
+    const Texture *texture = &textures[index].unwrap;
+    const SDL_Surface *image = texture->surface;
+    SDL_Surface *atlas = atlases[texture->atlas].surface;
+    blit_into_atlas(atlas->pixels, atlas->pitch,
+                    image->pixels, image->pitch, image->w, image->h,
+                    texture->rect, false);
+    blit_into_atlas(atlas->pixels, atlas->pitch,
+                    image->pixels, image->pitch, image->w, image->h,
+                    texture->mask_rect, true);
+}
+
+static bool rect_fits(SDL_Rect rect, Vec2i size)
+{
+    return rect.x >= 0 && rect.y >= 0 && rect.w >= 0 && rect.h >= 0 &&
+        (int64_t) rect.x + rect.w <= size.x &&
+        (int64_t) rect.y + rect.h <= size.y;
+}
+
+static SDL_Surface *atlas_view(SDL_Surface *atlas, SDL_Rect rect)
+{
+    return sec(SDL_CreateRGBSurfaceWithFormatFrom(
+                   (uint8_t*) atlas->pixels + rect.y * atlas->pitch + rect.x * 4,
+                   rect.w, rect.h, 32, atlas->pitch,
+                   SDL_PIXELFORMAT_RGBA32));
+}
+
+void Assets::pack_atlases(SDL_Renderer *renderer)
+{
+    SDL_Point page_size = {ASSETS_ATLAS_SIZE, ASSETS_ATLAS_SIZE};
+    SDL_RendererInfo info = {};
+    sec(SDL_GetRendererInfo(renderer, &info));
+    if (info.max_texture_width > 0) {
+        page_size.x = min(page_size.x, info.max_texture_width);
+    }
+    if (info.max_texture_height > 0) {
+        page_size.y = min(page_size.y, info.max_texture_height);
     }
-    SDL_UnlockSurface(asset.surface_mask);
 
-    asset.texture_mask = sec(SDL_CreateTextureFromSurface(renderer, asset.surface_mask));
+    SDL_Point sizes[ASSETS_TEXTURES_CAPACITY] = {};
+    Atlas_Slot slots[ASSETS_TEXTURES_CAPACITY] = {};
+    for (size_t i = 0; i < textures_count; ++i) {
+        sizes[i] = {textures[i].unwrap.surface->w, textures[i].unwrap.surface->h};
+    }
 
-    textures[textures_count].id = id;
-    textures[textures_count].path = path;
-    textures[textures_count].unwrap = asset;
-    textures_count += 1;
+    Atlas_Layout layout = {};
+    auto failed = layout_atlases(sizes, textures_count, page_size, slots, &layout);
+    if (failed.has_value) {
+        println(stderr, "Could not fit texture `", textures[failed.unwrap].id, "` into the atlases");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < textures_count; ++i) {
+        textures[i].unwrap.atlas = slots[i].atlas;
+        textures[i].unwrap.rect = slots[i].rect;
+        textures[i].unwrap.mask_rect = slots[i].mask_rect;
+    }
+
+    atlases_count = layout.atlases_count;
+    for (size_t i = 0; i < atlases_count; ++i) {
+        atlases[i].size = vec2(layout.atlas_sizes[i].x, layout.atlas_sizes[i].y);
+        atlases[i].surface = sec(SDL_CreateRGBSurfaceWithFormat(
+                                     0, atlases[i].size.x, atlases[i].size.y,
+                                     32, SDL_PIXELFORMAT_RGBA32));
+        sec(SDL_LockSurface(atlases[i].surface));
+        memset(atlases[i].surface->pixels, 0, (size_t) (atlases[i].surface->pitch * atlases[i].surface->h));
+    }
+
+    // NOTE: the slots of the textures do not overlap, so the textures
+    // and their masks are copied into the atlases in parallel
+    run_parallel([](Assets *assets, size_t index) {
+        assets->blit_texture(index);
+    }, textures_count);
+
+    // NOTE: the atlases are the only CPU side copy of the pixels, the
+    // textures keep views into them instead of the decoded images
+    for (size_t i = 0; i < textures_count; ++i) {
+        Texture *texture = &textures[i].unwrap;
+        SDL_FreeSurface(texture->surface);
+        texture->surface = atlas_view(atlases[texture->atlas].surface, texture->rect);
+    }
+
+    // NOTE: the atlases are uploaded to the GPU on their first draw
+    // (see Assets::resident_atlas())
+    for (size_t i = 0; i < atlases_count; ++i) {
+        SDL_UnlockSurface(atlases[i].surface);
+        println(stdout, "Packed atlas ", i, " (", atlases[i].size.x, "x", atlases[i].size.y, ")");
+    }
 }
 
-void Assets::load_sound(String_View id, String_View path)
+void Assets::load_sound(size_t index)
 {
-    println(stdout, "Loading sound ", id, " from ", path, "...");
-    sounds[sounds_count].id = id;
-    sounds[sounds_count].path = path;
-    sounds[sounds_count].unwrap = load_wav_as_sample_s16(path);
-    sounds_count += 1;
+    sounds[index].unwrap = load_wav_as_sample_s16(sounds[index].path);
 }
 
 Maybe<String_View> read_file_as_string_view(String_View filename)
@@ -90,10 +174,9 @@ Maybe<String_View> read_file_as_string_view(String_View filename)
     return read_file_as_string_view(filename_cstr);
 }
 
-void Assets::load_frames(String_View id, String_View path)
+void Assets::load_frames(size_t index)
 {
-    println(stdout, "Loading animat ", id, " from ", path, "...");
-
+    const String_View path = framesen[index].path;
     auto source = read_file_as_string_view(path);
     if (!source.has_value) {
         println(stderr, "Could not load animation file: `", path, "`");
@@ -101,117 +184,368 @@ void Assets::load_frames(String_View id, String_View path)
     }
     defer(free((void*) source.unwrap.data));
 
-    String_View input = source.unwrap;
     Frames frames = {};
+    Sprite *sprites = NULL;
     Maybe<Texture_Index> spritesheet_texture = {};
 
-    for (int line_number = 1; input.count != 0; ++line_number) {
-        auto value = input.chop_by_delim('\n');
-        auto key = value.chop_by_delim('=').trim();
-        if (key.count == 0 || *key.data == '#') continue;
-        value = value.trim();
-
-        auto subkey = key.chop_by_delim('.').trim();
-
-        if (subkey == "count"_sv) {
-            if (frames.sprites != nullptr) {
-                println(stderr, path, ":", line_number, ": `count` provided twice");
+    auto result = parse_animat_file(source.unwrap, [&](auto line_number, auto entry) {
+        switch (entry.key) {
+        case ANIMAT_KEY_TEXTURE: {
+            spritesheet_texture = get_texture_by_id(entry.texture);
+            if (!spritesheet_texture.has_value) {
+                println(stderr, path, ":", line_number, ": could not find a texture by id `", entry.texture, "`");
                 exit(1);
             }
+        } break;
 
-            auto count_result = value.as_integer<int>();
-            if (!count_result.has_value) {
-                println(stderr, path, ":", line_number, ": `count` is not a number");
-                exit(1);
-            }
+        case ANIMAT_KEY_COUNT: {
+            frames.count = (size_t) entry.value;
+            sprites = new Sprite[frames.count];
+            frames.sprites = sprites;
+        } break;
 
-            frames.count = (size_t) count_result.unwrap;
-            frames.sprites = new Sprite[frames.count];
-        } else if (subkey == "texture"_sv) {
-            auto maybe_texture = get_texture_by_id(value);
-            if (!maybe_texture.has_value) {
-                println(stderr, path, ":", line_number, ": could not find a texture by id `", value, "`");
-                exit(1);
-            }
+        case ANIMAT_KEY_DURATION: {
+            frames.duration = (float) entry.value / 1000.0f;
+        } break;
 
-            spritesheet_texture = maybe_texture;
-        } else if (subkey == "duration"_sv) {
-            auto result = value.as_integer<int>();
-            if (!result.has_value) {
-                println(stderr, path, ":", line_number, ": `duration` is not a number");
-                exit(1);
-            }
+        case ANIMAT_KEY_FRAME_X:
+        case ANIMAT_KEY_FRAME_Y:
+        case ANIMAT_KEY_FRAME_W:
+        case ANIMAT_KEY_FRAME_H: {
+            Sprite *sprite = &sprites[entry.frame_index];
+            sprite->texture_index = spritesheet_texture.unwrap;
+            if (entry.key == ANIMAT_KEY_FRAME_X) sprite->srcrect.x = entry.value;
+            if (entry.key == ANIMAT_KEY_FRAME_Y) sprite->srcrect.y = entry.value;
+            if (entry.key == ANIMAT_KEY_FRAME_W) sprite->srcrect.w = entry.value;
+            if (entry.key == ANIMAT_KEY_FRAME_H) sprite->srcrect.h = entry.value;
+        } break;
+        }
 
-            frames.duration = (float) result.unwrap / 1000.0f;
-        } else if (subkey == "frames"_sv) {
-            auto result = key.chop_by_delim('.').trim().as_integer<int>();
-            if (!result.has_value) {
-                println(stderr, path, ":", line_number, ": frame index is not a number");
-                exit(1);
-            }
+        return parse_success();
+    });
 
-            size_t frame_index = (size_t) result.unwrap;
-            if (frame_index >= frames.count) {
-                println(stderr, path, ":", line_number, ": frame index is bigger than the `count`");
-                exit(1);
-            }
+    if (result.is_error) {
+        println(stderr, path, ":", result.line, ": ", result.message);
+        exit(1);
+    }
 
-            if (!spritesheet_texture.has_value) {
-                println(stderr, path, ":", line_number, ": spritesheet was not loaded");
-                exit(1);
-            }
+    framesen[index].unwrap = frames;
+}
 
-            frames.sprites[frame_index].texture_index = spritesheet_texture.unwrap;
-
-            while (key.count) {
-                subkey = key.chop_by_delim('.').trim();
-
-                if (key.count != 0) {
-                    println(stderr, path, ":", line_number, ": unknown subkey `", subkey, "`");
-                    exit(1);
-                }
-
-                auto result_value = value.as_integer<int>();
-                if (!result_value.has_value) {
-                    println(stderr, path, ":", line_number, ": value is not a number");
-                    exit(1);
-                }
-
-                if (subkey == "x"_sv) {
-                    frames.sprites[frame_index].srcrect.x = result_value.unwrap;
-                } else if (subkey == "y"_sv) {
-                    frames.sprites[frame_index].srcrect.y = result_value.unwrap;
-                } else if (subkey == "w"_sv) {
-                    frames.sprites[frame_index].srcrect.w = result_value.unwrap;
-                } else if (subkey == "h"_sv) {
-                    frames.sprites[frame_index].srcrect.h = result_value.unwrap;
-                } else {
-                    println(stderr, path, ":", line_number, ": unknown subkey `", subkey, "`");
-                    exit(1);
-                }
-            }
-        } else {
-            println(stderr, path, ":", line_number, ": unknown subkey `", subkey, "`");
+static uint8_t *map_pack_file(const char *filepath, size_t *size)
+{
+#ifndef _WIN32
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        println(stderr, "Could not open data pack `", filepath, "`: ", strerror(errno));
+        exit(1);
+    }
+    defer(close(fd));
+
+    struct stat statbuf = {};
+    if (fstat(fd, &statbuf) < 0) {
+        println(stderr, "Could not open data pack `", filepath, "`: ", strerror(errno));
+        exit(1);
+    }
+    *size = (size_t) statbuf.st_size;
+
+    void *data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        println(stderr, "Could not map data pack `", filepath, "`: ", strerror(errno));
+        exit(1);
+    }
+
+    return (uint8_t*) data;
+#else
+    // NOTE: no mmap on Windows yet, so the pack is read in one go
+    FILE *pack_file = fopen(filepath, "rb");
+    if (!pack_file) {
+        println(stderr, "Could not open data pack `", filepath, "`: ", strerror(errno));
+        exit(1);
+    }
+    defer(fclose(pack_file));
+
+    if (fseek(pack_file, 0, SEEK_END) != 0) {
+        println(stderr, "Could not read data pack `", filepath, "`: ", strerror(errno));
+        exit(1);
+    }
+
+    long m = ftell(pack_file);
+    if (m < 0 || fseek(pack_file, 0, SEEK_SET) != 0) {
+        println(stderr, "Could not read data pack `", filepath, "`: ", strerror(errno));
+        exit(1);
+    }
+    *size = (size_t) m;
+
+    uint8_t *data = (uint8_t*) malloc(*size);
+    assert(data != NULL);
+    if (fread(data, 1, *size, pack_file) != *size) {
+        println(stderr, "Could not read data pack `", filepath, "`: ", strerror(errno));
+        exit(1);
+    }
+
+    return data;
+#endif // _WIN32
+}
+
+static void unmap_pack_file(uint8_t *data, size_t size)
+{
+#ifndef _WIN32
+    munmap(data, size);
+#else
+    (void) size;
+    free(data);
+#endif // _WIN32
+}
+
+static uint8_t *pack_blob(const char *filepath, uint8_t *data, size_t size, Pack_Blob blob)
+{
+    if (blob.offset > size || blob.size > size - blob.offset) {
+        println(stderr, "Data pack `", filepath, "` is corrupted: a blob is out of the file bounds");
+        exit(1);
+    }
+    return data + blob.offset;
+}
+
+template <typename T>
+static T *pack_table(const char *filepath, uint8_t *data, size_t size, Pack_Blob blob, size_t count)
+{
+    if (blob.size < count * sizeof(T) || blob.offset % alignof(T) != 0) {
+        println(stderr, "Data pack `", filepath, "` is corrupted: a table does not fit its blob");
+        exit(1);
+    }
+    return (T*) pack_blob(filepath, data, size, blob);
+}
+
+static String_View pack_string(const char *filepath, const char *strings, size_t strings_size, Pack_String string)
+{
+    if (string.offset > strings_size || string.count > strings_size - string.offset) {
+        println(stderr, "Data pack `", filepath, "` is corrupted: a string is out of bounds");
+        exit(1);
+    }
+    return {string.count, strings + string.offset};
+}
+
+const bool PACK_SPRITE_IS_SPRITE =
+    sizeof(Sprite) == sizeof(Pack_Sprite) &&
+    sizeof(Texture_Index) == sizeof(uint64_t) &&
+    offsetof(Sprite, srcrect) == offsetof(Pack_Sprite, srcrect) &&
+    offsetof(Sprite, texture_index) == offsetof(Pack_Sprite, texture_index);
+
+void Assets::load_pack(SDL_Renderer *renderer, const char *filepath)
+{
+    clean();
+    this->renderer = renderer;
+
+    println(stdout, "Loading data pack ", filepath, "...");
+
+    pack_data = map_pack_file(filepath, &pack_size);
+
+    const Pack_Header *header = (const Pack_Header*) pack_data;
+    if (pack_size < sizeof(*header) ||
+        memcmp(header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 ||
+        header->version != PACK_VERSION) {
+        println(stderr, "`", filepath, "` is not a data pack of version ", PACK_VERSION,
+                ". Rebuild it with pack_baker.");
+        exit(1);
+    }
+
+    if (header->atlases_count > ASSETS_ATLASES_CAPACITY ||
+        header->textures_count > ASSETS_TEXTURES_CAPACITY ||
+        header->sounds_count > ASSETS_SOUNDS_CAPACITY ||
+        header->framesen_count > ASSETS_FRAMESEN_CAPACITY) {
+        println(stderr, "Data pack `", filepath, "` has more assets than the game can hold");
+        exit(1);
+    }
+
+    auto atlas_table = pack_table<Pack_Atlas>(filepath, pack_data, pack_size, header->atlases, header->atlases_count);
+    auto texture_table = pack_table<Pack_Texture>(filepath, pack_data, pack_size, header->textures, header->textures_count);
+    auto sound_table = pack_table<Pack_Sound>(filepath, pack_data, pack_size, header->sounds, header->sounds_count);
+    auto frames_table = pack_table<Pack_Frames>(filepath, pack_data, pack_size, header->framesen, header->framesen_count);
+    auto sprite_table = pack_table<Pack_Sprite>(filepath, pack_data, pack_size, header->sprites, header->sprites_count);
+    auto strings = (const char*) pack_blob(filepath, pack_data, pack_size, header->strings);
+    const size_t strings_size = header->strings.size;
+
+    // NOTE: the atlases are uploaded right from the mapped pixels
+    for (size_t i = 0; i < header->atlases_count; ++i) {
+        const Pack_Atlas *atlas = &atlas_table[i];
+        if (atlas->w <= 0 || atlas->h <= 0 || atlas->pitch < atlas->w * 4 ||
+            atlas->pixels.size < (uint64_t) atlas->pitch * (uint64_t) atlas->h) {
+            println(stderr, "Data pack `", filepath, "` is corrupted: atlas ", i, " is broken");
             exit(1);
         }
+        void *pixels = pack_blob(filepath, pack_data, pack_size, atlas->pixels);
+
+        atlases[i].size = vec2(atlas->w, atlas->h);
+        atlases[i].surface = sec(SDL_CreateRGBSurfaceWithFormatFrom(
+                                     pixels, atlas->w, atlas->h, 32, atlas->pitch,
+                                     SDL_PIXELFORMAT_RGBA32));
+    }
+    atlases_count = header->atlases_count;
+
+    for (size_t i = 0; i < header->textures_count; ++i) {
+        const Pack_Texture *pack_texture = &texture_table[i];
+
+        Texture texture = {};
+        texture.atlas = pack_texture->atlas;
+        texture.rect = {pack_texture->rect[0], pack_texture->rect[1], pack_texture->rect[2], pack_texture->rect[3]};
+        texture.mask_rect = {pack_texture->mask_rect[0], pack_texture->mask_rect[1], pack_texture->mask_rect[2], pack_texture->mask_rect[3]};
+
+        // NOTE: the mask is blitted with the source rects of the
+        // texture, so it must be of the same size
+        if (texture.atlas >= atlases_count ||
+            !rect_fits(texture.rect, atlases[texture.atlas].size) ||
+            !rect_fits(texture.mask_rect, atlases[texture.atlas].size) ||
+            texture.mask_rect.w != texture.rect.w ||
+            texture.mask_rect.h != texture.rect.h) {
+            println(stderr, "Data pack `", filepath, "` is corrupted: texture ", i, " is out of its atlas");
+            exit(1);
+        }
+
+        texture.surface = atlas_view(atlases[texture.atlas].surface, texture.rect);
+
+        textures[i].id = pack_string(filepath, strings, strings_size, pack_texture->id);
+        textures[i].path = pack_string(filepath, strings, strings_size, pack_texture->path);
+        textures[i].unwrap = texture;
     }
+    textures_count = header->textures_count;
 
-    framesen[framesen_count].id = id;
-    framesen[framesen_count].path = path;
-    framesen[framesen_count].unwrap = frames;
-    framesen_count += 1;
+    for (size_t i = 0; i < header->sounds_count; ++i) {
+        const Pack_Sound *pack_sound = &sound_table[i];
+        sounds[i].id = pack_string(filepath, strings, strings_size, pack_sound->id);
+        sounds[i].path = pack_string(filepath, strings, strings_size, pack_sound->path);
+        sounds[i].unwrap.audio_buf = (int16_t*) pack_blob(filepath, pack_data, pack_size, pack_sound->samples);
+        sounds[i].unwrap.audio_len = (Uint32) (pack_sound->samples.size / 2);
+    }
+    sounds_count = header->sounds_count;
+
+    for (size_t i = 0; i < header->sprites_count; ++i) {
+        const Pack_Sprite *pack_sprite = &sprite_table[i];
+        if (pack_sprite->texture_index >= textures_count) {
+            println(stderr, "Data pack `", filepath, "` is corrupted: sprite ", i, " has no texture");
+            exit(1);
+        }
+
+        const SDL_Rect rect = textures[pack_sprite->texture_index].unwrap.rect;
+        const SDL_Rect srcrect = {
+            pack_sprite->srcrect[0], pack_sprite->srcrect[1],
+            pack_sprite->srcrect[2], pack_sprite->srcrect[3]
+        };
+        if (!rect_fits(srcrect, vec2(rect.w, rect.h))) {
+            println(stderr, "Data pack `", filepath, "` is corrupted: sprite ", i, " is out of its texture");
+            exit(1);
+        }
+    }
+
+    // NOTE: the frame table of the pack is used in place when its
+    // layout is the layout of Sprite, which is the case wherever
+    // size_t is 64 bits. Otherwise the table is copied once.
+    if (PACK_SPRITE_IS_SPRITE) {
+        pack_sprites = (const Sprite*) sprite_table;
+        pack_sprites_copied = false;
+    } else {
+        Sprite *sprites = new Sprite[header->sprites_count + 1];
+        for (size_t i = 0; i < header->sprites_count; ++i) {
+            const Pack_Sprite *pack_sprite = &sprite_table[i];
+            sprites[i] = {};
+            sprites[i].texture_index = {(size_t) pack_sprite->texture_index};
+            sprites[i].srcrect = {
+                pack_sprite->srcrect[0], pack_sprite->srcrect[1],
+                pack_sprite->srcrect[2], pack_sprite->srcrect[3]
+            };
+        }
+        pack_sprites = sprites;
+        pack_sprites_copied = true;
+    }
+
+    for (size_t i = 0; i < header->framesen_count; ++i) {
+        const Pack_Frames *pack_frames = &frames_table[i];
+        if (pack_frames->sprites_offset > header->sprites_count ||
+            pack_frames->sprites_count > header->sprites_count - pack_frames->sprites_offset) {
+            println(stderr, "Data pack `", filepath, "` is corrupted: animat ", i, " is out of the sprites");
+            exit(1);
+        }
+
+        framesen[i].id = pack_string(filepath, strings, strings_size, pack_frames->id);
+        framesen[i].path = pack_string(filepath, strings, strings_size, pack_frames->path);
+        framesen[i].unwrap.sprites = pack_sprites + pack_frames->sprites_offset;
+        framesen[i].unwrap.count = pack_frames->sprites_count;
+        framesen[i].unwrap.duration = pack_frames->duration;
+    }
+    framesen_count = header->framesen_count;
+    check_ids_tables();
+
+    println(stdout, "Loaded ", textures_count, " textures in ", atlases_count, " atlases, ",
+            sounds_count, " sounds and ", framesen_count, " animats from the data pack");
+
+    loaded_first_time = true;
 }
 
-Maybe<Sample_S16_Index> Assets::get_sound_by_id(String_View id)
+void Assets::load(SDL_Renderer *renderer)
 {
-    for (size_t i = 0; i < sounds_count; ++i) {
-        if (sounds[i].id == id) {
-            return {true, {i}};
+#ifdef SOMETHING_RELEASE
+    load_pack(renderer, ASSETS_PACK_FILE_PATH);
+#else
+    load_conf(renderer, ASSETS_CONF_FILE_PATH);
+#endif // SOMETHING_RELEASE
+}
+
+template <typename T, size_t N>
+static Maybe<size_t> find_asset_by_id(const Asset<T> *assets, size_t count,
+                                      uint32_t seed, const int (&slots)[N],
+                                      bool table_matches, String_View id)
+{
+    static_assert((N & (N - 1)) == 0, "The size of an ids table must be a power of two");
+
+    if (table_matches) {
+        const int slot = slots[asset_id_hash(id, seed) & (N - 1)];
+        if (slot >= 0 && (size_t) slot < count && assets[slot].id == id) {
+            return {true, (size_t) slot};
+        }
+        return {};
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (assets[i].id == id) {
+            return {true, i};
         }
     }
     return {};
 }
 
+template <typename T, size_t N>
+static bool ids_table_matches(const Asset<T> *assets, size_t count,
+                              uint32_t seed, const int (&slots)[N])
+{
+    for (size_t i = 0; i < count; ++i) {
+        auto found = find_asset_by_id(assets, count, seed, slots, true, assets[i].id);
+        if (!found.has_value || found.unwrap != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Assets::check_ids_tables()
+{
+    ids_tables_match =
+        ids_table_matches(textures, textures_count, TEXTURE_IDS_SEED, TEXTURE_IDS_SLOTS) &&
+        ids_table_matches(sounds, sounds_count, SOUND_IDS_SEED, SOUND_IDS_SLOTS) &&
+        ids_table_matches(framesen, framesen_count, FRAMES_IDS_SEED, FRAMES_IDS_SLOTS);
+
+    if (!ids_tables_match) {
+        println(stderr, "WARNING: the assets do not match assets_types.hpp anymore, ",
+                "looking them up by id is going to be slow until the game is rebuilt");
+    }
+}
+
+Maybe<Sample_S16_Index> Assets::get_sound_by_id(String_View id)
+{
+    auto index = find_asset_by_id(sounds, sounds_count, SOUND_IDS_SEED, SOUND_IDS_SLOTS, ids_tables_match, id);
+    if (!index.has_value) return {};
+    return {true, {index.unwrap}};
+}
+
 Sample_S16 Assets::get_sound_by_index(Sample_S16_Index index)
 {
     return sounds[index.unwrap].unwrap;
@@ -219,13 +553,9 @@ Sample_S16 Assets::get_sound_by_index(Sample_S16_Index index)
 
 Maybe<Texture_Index> Assets::get_texture_by_id(String_View id)
 {
-    for (size_t i = 0; i < textures_count; ++i) {
-        if (textures[i].id == id) {
-            return {true, {i}};
-        }
-    }
-
-    return {};
+    auto index = find_asset_by_id(textures, textures_count, TEXTURE_IDS_SEED, TEXTURE_IDS_SLOTS, ids_tables_match, id);
+    if (!index.has_value) return {};
+    return {true, {index.unwrap}};
 }
 
 Texture Assets::get_texture_by_index(Texture_Index index)
@@ -233,66 +563,572 @@ Texture Assets::get_texture_by_index(Texture_Index index)
     return textures[index.unwrap].unwrap;
 }
 
-Maybe<Frames_Index> Assets::get_frames_by_id(String_View id)
+Texture_Atlas Assets::get_atlas_of_texture(Texture_Index index)
 {
-    for (size_t i = 0; i < framesen_count; ++i) {
-        if (framesen[i].id == id) {
-            return {true, {i}};
+    const size_t atlas = textures[index.unwrap].unwrap.atlas;
+    resident_atlas(atlas);
+    return atlases[atlas];
+}
+
+size_t Texture_Atlas::bytes() const
+{
+    return (size_t) size.x * (size_t) size.y * 4;
+}
+
+void Assets::begin_frame()
+{
+    residency_frame += 1;
+}
+
+void Assets::upload_atlas(size_t index)
+{
+    Texture_Atlas *atlas = &atlases[index];
+    assert(atlas->texture == NULL);
+    atlas->texture = sec(SDL_CreateTexture(
+                             renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+                             atlas->size.x, atlas->size.y));
+    sec(SDL_UpdateTexture(atlas->texture, NULL, atlas->surface->pixels, atlas->surface->pitch));
+    sec(SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND));
+    resident_bytes += atlas->bytes();
+    uploads_count += 1;
+}
+
+void Assets::release_atlas(size_t index)
+{
+    Texture_Atlas *atlas = &atlases[index];
+    if (atlas->texture != NULL) {
+        SDL_DestroyTexture(atlas->texture);
+        atlas->texture = NULL;
+        resident_bytes -= atlas->bytes();
+    }
+}
+
+void Assets::evict_over_budget()
+{
+    // NOTE: 0 means no budget
+    if (ASSETS_VRAM_BUDGET_MB <= 0) {
+        return;
+    }
+
+    const size_t budget = (size_t) ASSETS_VRAM_BUDGET_MB * 1024 * 1024;
+    while (resident_bytes > budget) {
+        Maybe<size_t> lru = {};
+        for (size_t i = 0; i < atlases_count; ++i) {
+            const Texture_Atlas *atlas = &atlases[i];
+            if (atlas->texture != NULL && !atlas->pinned && atlas->last_used_frame != residency_frame &&
+                (!lru.has_value || atlas->last_used_frame < atlases[lru.unwrap].last_used_frame)) {
+                lru = {true, i};
+            }
+        }
+
+        if (!lru.has_value) {
+            break;
         }
+
+        evicted_bytes += atlases[lru.unwrap].bytes();
+        evictions_count += 1;
+        release_atlas(lru.unwrap);
+    }
+}
+
+SDL_Texture *Assets::resident_atlas(size_t index)
+{
+    Texture_Atlas *atlas = &atlases[index];
+    atlas->last_used_frame = residency_frame;
+    if (atlas->texture == NULL) {
+        upload_atlas(index);
+        evict_over_budget();
     }
+    return atlas->texture;
+}
 
-    return {};
+SDL_Texture *Assets::pin_atlas(size_t index)
+{
+    atlases[index].pinned = true;
+    return resident_atlas(index);
 }
 
-Frames Assets::get_frames_by_index(Frames_Index index)
+void Assets::prefetch(Texture_Index index)
 {
-    return framesen[index.unwrap].unwrap;
+    if (index.unwrap < textures_count) {
+        resident_atlas(textures[index.unwrap].unwrap.atlas);
+    }
+}
+
+Maybe<Frames_Index> Assets::get_frames_by_id(String_View id)
+{
+    auto index = find_asset_by_id(framesen, framesen_count, FRAMES_IDS_SEED, FRAMES_IDS_SLOTS, ids_tables_match, id);
+    if (!index.has_value) return {};
+    return {true, {index.unwrap}};
+}
+
+const Frames *Assets::get_frames_by_index(Frames_Index index)
+{
+    return &framesen[index.unwrap].unwrap;
 }
 
 void Assets::clean()
 {
     for (size_t i = 0; i < textures_count; ++i) {
         SDL_FreeSurface(textures[i].unwrap.surface);
-        SDL_DestroyTexture(textures[i].unwrap.texture);
-        SDL_FreeSurface(textures[i].unwrap.surface_mask);
-        SDL_DestroyTexture(textures[i].unwrap.texture_mask);
     }
     textures_count = 0;
 
+    for (size_t i = 0; i < atlases_count; ++i) {
+        release_atlas(i);
+        SDL_FreeSurface(atlases[i].surface);
+        atlases[i] = {};
+    }
+    atlases_count = 0;
+
     for (size_t i = 0; i < sounds_count; ++i) {
-        SDL_FreeWAV((Uint8*) sounds[i].unwrap.audio_buf);
+        if (pack_data == NULL) {
+            free_sample_s16(sounds[i].unwrap);
+        }
     }
     sounds_count = 0;
 
     for (size_t i = 0; i < framesen_count; ++i) {
-        delete[] framesen[i].unwrap.sprites;
+        if (pack_data == NULL) {
+            delete[] framesen[i].unwrap.sprites;
+        }
     }
     framesen_count = 0;
+
+    if (pack_data != NULL) {
+        if (pack_sprites_copied) {
+            delete[] pack_sprites;
+        }
+        pack_sprites = NULL;
+        unmap_pack_file(pack_data, pack_size);
+        pack_data = NULL;
+        pack_size = 0;
+    }
 }
 
-void Assets::load_conf(SDL_Renderer *renderer, const char *filepath)
+static int assets_worker(void *data)
 {
-    clean();
+    Assets_Workers *workers = (Assets_Workers*) data;
+    for (;;) {
+        const size_t index = (size_t) SDL_AtomicAdd(&workers->next, 1);
+        if (index >= workers->count) break;
+        workers->job(workers->assets, index);
+    }
+    return 0;
+}
+
+size_t Assets::run_parallel(Assets_Job job, size_t count)
+{
+    Assets_Workers workers = {};
+    workers.assets = this;
+    workers.job = job;
+    workers.count = count;
+
+    const size_t threads_count = min((size_t) max(SDL_GetCPUCount(), 1),
+                                     ASSETS_LOADING_THREADS_CAPACITY,
+                                     max(count, (size_t) 1));
+
+    // NOTE: the calling thread is one of the workers
+    SDL_Thread *threads[ASSETS_LOADING_THREADS_CAPACITY] = {};
+    for (size_t i = 1; i < threads_count; ++i) {
+        threads[i] = sec(SDL_CreateThread(assets_worker, "Assets Worker", &workers));
+    }
+    assets_worker(&workers);
+    for (size_t i = 1; i < threads_count; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+
+    return threads_count;
+}
 
-    String_View input = load_file_into_conf_buffer(filepath);
+static float assets_seconds_since(Uint64 begin)
+{
+    return (float) (SDL_GetPerformanceCounter() - begin) / (float) SDL_GetPerformanceFrequency();
+}
 
-    // TODO(#253): release data pack building based on assets.conf
+size_t Assets::parse_conf(String_View input, const char *filepath, Asset_Entry *entries)
+{
+    size_t entries_count = 0;
+    size_t textures_seen = 0;
+    size_t sounds_seen = 0;
+    size_t framesen_seen = 0;
 
     parse_vars_conf(input, [&](auto line_number, auto id, auto type, auto asset_path) {
+        Asset_Entry entry = {};
+        bool too_many = false;
         if (type == "texture"_sv) {
-            load_texture(renderer, id, asset_path);
+            entry.kind = ASSET_KIND_TEXTURE;
+            too_many = textures_seen++ >= ASSETS_TEXTURES_CAPACITY;
         } else if (type == "sound"_sv) {
-            load_sound(id, asset_path);
+            entry.kind = ASSET_KIND_SOUND;
+            too_many = sounds_seen++ >= ASSETS_SOUNDS_CAPACITY;
         } else if (type == "animat"_sv) {
-            load_frames(id, asset_path);
+            entry.kind = ASSET_KIND_FRAMES;
+            too_many = framesen_seen++ >= ASSETS_FRAMESEN_CAPACITY;
         } else {
             println(stderr, asset_path, ":", line_number, ": ",
                     "Unknown type of asset `", type, "`");
             exit(1);
         }
 
+        if (too_many) {
+            println(stderr, filepath, ":", line_number, ": too many assets of type `", type, "`");
+            exit(1);
+        }
+
+        entry.id = id;
+        entry.path = asset_path;
+        entries[entries_count++] = entry;
         return parse_success();
     });
 
+    return entries_count;
+}
+
+Asset_Entry Assets::entry_of(const Asset_Load *load) const
+{
+    switch (load->kind) {
+    case ASSET_KIND_TEXTURE: return {load->kind, textures[load->index].id, textures[load->index].path};
+    case ASSET_KIND_SOUND:   return {load->kind, sounds[load->index].id, sounds[load->index].path};
+    case ASSET_KIND_FRAMES:  return {load->kind, framesen[load->index].id, framesen[load->index].path};
+    }
+
+    assert(0 && "Incorrect Asset_Kind");
+    return {};
+}
+
+static Asset_Stamp stamp_asset_file(String_View path)
+{
+    char *path_cstr = (char*) malloc(path.count + 1);
+    assert(path_cstr != NULL);
+    defer(free(path_cstr));
+    memcpy(path_cstr, path.data, path.count);
+    path_cstr[path.count] = '\0';
+
+    Asset_Stamp stamp = {};
+    struct stat statbuf = {};
+    if (stat(path_cstr, &statbuf) < 0) {
+        // NOTE: the loaders report the missing files
+        return stamp;
+    }
+    stamp.mtime = (int64_t) statbuf.st_mtime;
+    stamp.size = (uint64_t) statbuf.st_size;
+    return stamp;
+}
+
+static void hash_asset_file(String_View path, Asset_Stamp *stamp)
+{
+    char *path_cstr = (char*) malloc(path.count + 1);
+    assert(path_cstr != NULL);
+    defer(free(path_cstr));
+    memcpy(path_cstr, path.data, path.count);
+    path_cstr[path.count] = '\0';
+
+    auto content = read_file_as_string_view(path_cstr);
+    if (content.has_value) {
+        stamp->hash = fnv1a_64(content.unwrap.data, content.unwrap.count);
+        stamp->hashed = true;
+        free((void*) content.unwrap.data);
+    }
+}
+
+void Assets::load_conf(SDL_Renderer *renderer, const char *filepath)
+{
+    clean();
+    this->renderer = renderer;
+
+    const Uint64 load_begin = SDL_GetPerformanceCounter();
+
+    String_View input = load_file_into_conf_buffer(filepath, conf_buffer);
+
+    // NOTE: The first pass only registers the assets in the order of
+    // assets.conf, so the indices match assets_types.hpp and every
+    // animat can resolve its texture by id no matter which worker
+    // parses it and when.
+    Asset_Entry entries[ASSETS_LOADS_CAPACITY];
+    loads_count = parse_conf(input, filepath, entries);
+    for (size_t i = 0; i < loads_count; ++i) {
+        Asset_Load load = {};
+        load.kind = entries[i].kind;
+        switch (load.kind) {
+        case ASSET_KIND_TEXTURE: {
+            load.index = textures_count++;
+            textures[load.index] = {entries[i].id, entries[i].path, {}};
+        } break;
+
+        case ASSET_KIND_SOUND: {
+            load.index = sounds_count++;
+            sounds[load.index] = {entries[i].id, entries[i].path, {}};
+        } break;
+
+        case ASSET_KIND_FRAMES: {
+            load.index = framesen_count++;
+            framesen[load.index] = {entries[i].id, entries[i].path, {}};
+        } break;
+        }
+        loads[i] = load;
+    }
+    check_ids_tables();
+
+    // NOTE: the CPU phase, decoding the PNGs and the WAVs and parsing
+    // the animats on all of the cores
+    const Uint64 decode_begin = SDL_GetPerformanceCounter();
+    const size_t decode_threads_count = run_parallel([](Assets *assets, size_t index) {
+        Asset_Load *load = &assets->loads[index];
+        const Uint64 begin = SDL_GetPerformanceCounter();
+        switch (load->kind) {
+        case ASSET_KIND_TEXTURE: assets->load_texture(load->index); break;
+        case ASSET_KIND_SOUND:   assets->load_sound(load->index);   break;
+        case ASSET_KIND_FRAMES:  assets->load_frames(load->index);  break;
+        }
+        load->seconds = assets_seconds_since(begin);
+        load->stamp = stamp_asset_file(assets->entry_of(load).path);
+    }, loads_count);
+    const float decode_seconds = assets_seconds_since(decode_begin);
+
+    for (size_t i = 0; i < loads_count; ++i) {
+        const Asset_Load *load = &loads[i];
+        switch (load->kind) {
+        case ASSET_KIND_TEXTURE: {
+            println(stdout, "Loaded texture ", textures[load->index].id, " from ", textures[load->index].path,
+                    " in ", load->seconds * 1000.0f, "ms");
+        } break;
+
+        case ASSET_KIND_SOUND: {
+            println(stdout, "Loaded sound ", sounds[load->index].id, " from ", sounds[load->index].path,
+                    " in ", load->seconds * 1000.0f, "ms");
+        } break;
+
+        case ASSET_KIND_FRAMES: {
+            println(stdout, "Loaded animat ", framesen[load->index].id, " from ", framesen[load->index].path,
+                    " in ", load->seconds * 1000.0f, "ms");
+        } break;
+        }
+    }
+
+    // NOTE: the GPU phase, only the atlases are created on the main
+    // thread
+    const Uint64 pack_begin = SDL_GetPerformanceCounter();
+    pack_atlases(renderer);
+    const float pack_seconds = assets_seconds_since(pack_begin);
+
+    println(stdout, "Loaded ", loads_count, " assets in ", assets_seconds_since(load_begin) * 1000.0f, "ms",
+            " (decoding ", decode_seconds * 1000.0f, "ms on ", decode_threads_count, " threads,",
+            " packing ", pack_seconds * 1000.0f, "ms)");
+
     loaded_first_time = true;
 }
+
+Assets_Reload Assets::reload_conf(SDL_Renderer *renderer, const char *filepath,
+                                  Sample_Mixer *mixer)
+{
+    Assets_Reload result = {};
+    const Uint64 reload_begin = SDL_GetPerformanceCounter();
+
+    // NOTE: the new assets.conf goes into a separate buffer, because
+    // the ids and the paths of the loaded assets point into conf_buffer
+    String_View input = load_file_into_conf_buffer(filepath, reload_buffer);
+    Asset_Entry entries[ASSETS_LOADS_CAPACITY];
+    const size_t entries_count = parse_conf(input, filepath, entries);
+
+    bool same_assets = loaded_first_time && pack_data == NULL && entries_count == loads_count;
+    for (size_t i = 0; same_assets && i < entries_count; ++i) {
+        const Asset_Entry entry = entry_of(&loads[i]);
+        same_assets = entries[i].kind == entry.kind && entries[i].id == entry.id;
+    }
+
+    if (!same_assets) {
+        // NOTE: the indices of the assets are different now, so any
+        // sample in the mixer could point to a wrong sound
+        mixer->clean();
+        mixer->sync();
+
+        load_conf(renderer, filepath);
+        result.full = true;
+        return result;
+    }
+
+    reloads_count = 0;
+    for (size_t i = 0; i < loads_count; ++i) {
+        Asset_Load *load = &loads[i];
+        Asset_Stamp stamp = stamp_asset_file(entries[i].path);
+        load->changed = entries[i].path != entry_of(load).path;
+        if (load->changed || stamp.size != load->stamp.size) {
+            load->changed = true;
+            load->stamp = stamp;
+        } else if (stamp.mtime != load->stamp.mtime) {
+            // NOTE: without the hash of the previous content there is
+            // nothing to compare against, so the first touch of the
+            // file reloads it and remembers the hash
+            hash_asset_file(entries[i].path, &stamp);
+            load->changed = !load->stamp.hashed || !stamp.hashed || stamp.hash != load->stamp.hash;
+            load->stamp = stamp;
+        }
+
+        if (load->changed) {
+            reloads[reloads_count++] = i;
+        }
+    }
+
+    memcpy(conf_buffer, reload_buffer, input.count);
+    for (size_t i = 0; i < loads_count; ++i) {
+        const String_View id = {entries[i].id.count, conf_buffer + (entries[i].id.data - reload_buffer)};
+        const String_View path = {entries[i].path.count, conf_buffer + (entries[i].path.data - reload_buffer)};
+        switch (loads[i].kind) {
+        case ASSET_KIND_TEXTURE: textures[loads[i].index].id = id; textures[loads[i].index].path = path; break;
+        case ASSET_KIND_SOUND:   sounds[loads[i].index].id = id;   sounds[loads[i].index].path = path;   break;
+        case ASSET_KIND_FRAMES:  framesen[loads[i].index].id = id; framesen[loads[i].index].path = path; break;
+        }
+    }
+
+    // NOTE: the changed textures and sounds are decoded on the workers
+    // next to the ones that are in use, the animats wait for the
+    // textures they depend on
+    run_parallel([](Assets *assets, size_t index) {
+        Asset_Load *load = &assets->loads[assets->reloads[index]];
+        const Uint64 begin = SDL_GetPerformanceCounter();
+        const String_View path = assets->entry_of(load).path;
+        switch (load->kind) {
+        case ASSET_KIND_TEXTURE: {
+            assets->reloaded_surfaces[load->index] = load_png_file_as_surface(path);
+            assert(assets->reloaded_surfaces[load->index]->format->format == SDL_PIXELFORMAT_RGBA32);
+        } break;
+
+        case ASSET_KIND_SOUND: {
+            assets->reloaded_samples[load->index] = load_wav_as_sample_s16(path);
+        } break;
+
+        case ASSET_KIND_FRAMES: {} break;
+        }
+        load->seconds = assets_seconds_since(begin);
+    }, reloads_count);
+
+    bool texture_changed[ASSETS_TEXTURES_CAPACITY] = {};
+    bool repack = false;
+    for (size_t i = 0; i < reloads_count; ++i) {
+        const Asset_Load *load = &loads[reloads[i]];
+        if (load->kind == ASSET_KIND_TEXTURE) {
+            Texture *texture = &textures[load->index].unwrap;
+            SDL_Surface *surface = reloaded_surfaces[load->index];
+            repack = repack || surface->w != texture->surface->w || surface->h != texture->surface->h;
+            SDL_FreeSurface(texture->surface);
+            texture->surface = surface;
+            texture_changed[load->index] = true;
+            result.textures_count += 1;
+        }
+    }
+
+    if (repack) {
+        // NOTE: the size of a texture changed, its slot does not fit
+        // anymore, so the atlases are laid out again. The old atlases
+        // live until the new ones are packed, because the textures
+        // that did not change are views into them.
+        Texture_Atlas old_atlases[ASSETS_ATLASES_CAPACITY];
+        const size_t old_atlases_count = atlases_count;
+        for (size_t i = 0; i < atlases_count; ++i) {
+            release_atlas(i);
+            old_atlases[i] = atlases[i];
+            atlases[i] = {};
+        }
+        atlases_count = 0;
+        pack_atlases(renderer);
+        for (size_t i = 0; i < old_atlases_count; ++i) {
+            SDL_FreeSurface(old_atlases[i].surface);
+        }
+    } else {
+        for (size_t i = 0; i < textures_count; ++i) {
+            if (!texture_changed[i]) continue;
+
+            blit_texture(i);
+            Texture *texture = &textures[i].unwrap;
+            Texture_Atlas *atlas = &atlases[texture->atlas];
+            SDL_FreeSurface(texture->surface);
+            texture->surface = atlas_view(atlas->surface, texture->rect);
+
+            // NOTE: the atlas that is not resident gets the new pixels
+            // on its next upload
+            if (atlas->texture == NULL) continue;
+
+            const SDL_Rect rects[] = {texture->rect, texture->mask_rect};
+            for (size_t j = 0; j < sizeof(rects) / sizeof(rects[0]); ++j) {
+                const uint8_t *pixels = (uint8_t*) atlas->surface->pixels
+                    + rects[j].y * atlas->surface->pitch
+                    + rects[j].x * 4;
+                sec(SDL_UpdateTexture(atlas->texture, &rects[j], pixels, atlas->surface->pitch));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < loads_count; ++i) {
+        Asset_Load *load = &loads[i];
+        if (load->kind != ASSET_KIND_FRAMES) continue;
+
+        const Frames *frames = &framesen[load->index].unwrap;
+        bool depends_on_changed = false;
+        for (size_t j = 0; j < frames->count; ++j) {
+            if (texture_changed[frames->sprites[j].texture_index.unwrap]) {
+                depends_on_changed = true;
+            }
+        }
+
+        if (load->changed || depends_on_changed) {
+            const Uint64 begin = SDL_GetPerformanceCounter();
+            delete[] framesen[load->index].unwrap.sprites;
+            load_frames(load->index);
+            load->seconds = assets_seconds_since(begin);
+            load->changed = true;
+            result.framesen_count += 1;
+        }
+    }
+
+    // NOTE: the voices of the changed samples are stopped and the
+    // samples are freed only after the mixer has seen the stops, the
+    // rest of the sounds keep playing
+    bool sounds_changed = false;
+    for (size_t i = 0; i < reloads_count; ++i) {
+        const Asset_Load *load = &loads[reloads[i]];
+        if (load->kind == ASSET_KIND_SOUND) {
+            mixer->stop_sample({load->index});
+            sounds_changed = true;
+        }
+    }
+    if (sounds_changed) {
+        mixer->sync();
+    }
+    for (size_t i = 0; i < reloads_count; ++i) {
+        const Asset_Load *load = &loads[reloads[i]];
+        if (load->kind == ASSET_KIND_SOUND) {
+            free_sample_s16(sounds[load->index].unwrap);
+            sounds[load->index].unwrap = reloaded_samples[load->index];
+            result.sounds_count += 1;
+        }
+    }
+
+    for (size_t i = 0; i < loads_count; ++i) {
+        if (loads[i].changed) {
+            const Asset_Entry entry = entry_of(&loads[i]);
+            println(stdout, "Reloaded ", entry.id, " from ", entry.path, " in ", loads[i].seconds * 1000.0f, "ms");
+        }
+    }
+    println(stdout, "Reloaded ", result.textures_count, " textures, ", result.sounds_count, " sounds and ",
+            result.framesen_count, " animats in ", assets_seconds_since(reload_begin) * 1000.0f, "ms");
+
+    return result;
+}
+
+Assets_Reload Assets::reload(SDL_Renderer *renderer, Sample_Mixer *mixer)
+{
+#ifdef SOMETHING_RELEASE
+    // NOTE: the data pack is baked as a whole, there is nothing to
+    // reload incrementally
+    mixer->clean();
+    mixer->sync();
+
+    Assets_Reload result = {};
+    load_pack(renderer, ASSETS_PACK_FILE_PATH);
+    result.full = true;
+    return result;
+#else
+    return reload_conf(renderer, ASSETS_CONF_FILE_PATH, mixer);
+#endif // SOMETHING_RELEASE
+}
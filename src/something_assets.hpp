@@ -3,11 +3,17 @@
 
 #include "./something_sound.hpp"
 #include "./something_parsers.hpp"
+#include "./something_pack.hpp"
 
 const size_t ASSETS_CONF_BUFFER_CAPACITY = 1024 * 1024;
 const size_t ASSETS_TEXTURES_CAPACITY = 128;
 const size_t ASSETS_SOUNDS_CAPACITY = 128;
 const size_t ASSETS_FRAMESEN_CAPACITY = 128;
+const char *const ASSETS_CONF_FILE_PATH = "./assets/assets.conf";
+const char *const ASSETS_PACK_FILE_PATH = "./assets.pack";
+
+const size_t ASSETS_LOADS_CAPACITY = ASSETS_TEXTURES_CAPACITY + ASSETS_SOUNDS_CAPACITY + ASSETS_FRAMESEN_CAPACITY;
+const size_t ASSETS_LOADING_THREADS_CAPACITY = 16;
 
 template <typename T>
 struct Asset
@@ -17,12 +23,102 @@ struct Asset
     T unwrap;
 };
 
-struct Texture
+// NOTE: All the textures from assets.conf are packed into a few big
+// atlases on load, each texture right next to its mask, so the body
+// and the mask of a sprite (and most of the sprites of a frame) end
+// up in the same SDL_Texture and batch together.
+struct Texture_Atlas
 {
+    // NOTE: the pixels are the only CPU side copy of the textures.
+    // They are kept for the CPU rendering backend, the pixel lookups
+    // and for uploading the atlas again after it was evicted. In the
+    // release build they point right into the data pack.
     SDL_Surface *surface;
+    // NOTE: NULL while the atlas is not resident on the GPU, use
+    // Assets::resident_atlas() to draw with it
     SDL_Texture *texture;
-    SDL_Surface *surface_mask;
-    SDL_Texture *texture_mask;
+    Vec2i size;
+    Uint64 last_used_frame;
+    // NOTE: pinned atlases are never evicted
+    bool pinned;
+
+    size_t bytes() const;
+};
+
+struct Texture
+{
+    // NOTE: a view into the pixels of the atlas, for the CPU side
+    // pixel lookups. Right after decoding and until it is blitted
+    // into the atlas it is the decoded image itself.
+    SDL_Surface *surface;
+    size_t atlas;
+    SDL_Rect rect;
+    SDL_Rect mask_rect;
+
+    // NOTE: Sprite::srcrect stays relative to the texture, so the
+    // sprites survive repacking on reload. It is moved onto the
+    // atlas right before drawing.
+    SDL_Rect to_atlas(SDL_Rect srcrect) const;
+    SDL_Rect to_atlas_mask(SDL_Rect srcrect) const;
+};
+
+enum Asset_Kind
+{
+    ASSET_KIND_TEXTURE = 0,
+    ASSET_KIND_SOUND,
+    ASSET_KIND_FRAMES,
+};
+
+struct Asset_Entry
+{
+    Asset_Kind kind;
+    String_View id;
+    String_View path;
+};
+
+// NOTE: what the file of an asset looked like when it was loaded. A
+// different size means a different file. The content is hashed only
+// when just the mtime changed, so touching a file that was hashed
+// before does not reload it.
+struct Asset_Stamp
+{
+    int64_t mtime;
+    uint64_t size;
+    uint64_t hash;
+    bool hashed;
+};
+
+// NOTE: an entry of assets.conf, in the order of the file
+struct Asset_Load
+{
+    Asset_Kind kind;
+    size_t index;
+    // NOTE: measured by the worker that loaded the asset
+    float seconds;
+    Asset_Stamp stamp;
+    bool changed;
+};
+
+struct Assets_Reload
+{
+    // NOTE: the list of the assets in assets.conf changed, so
+    // everything was loaded from scratch at new indices
+    bool full;
+    size_t textures_count;
+    size_t sounds_count;
+    size_t framesen_count;
+};
+
+struct Assets;
+
+typedef void (*Assets_Job)(Assets *assets, size_t index);
+
+struct Assets_Workers
+{
+    Assets *assets;
+    Assets_Job job;
+    size_t count;
+    SDL_atomic_t next;
 };
 
 struct Assets
@@ -38,23 +134,99 @@ struct Assets
     // plural of `frame`, yes).
     size_t framesen_count;
     Asset<Frames> framesen[ASSETS_FRAMESEN_CAPACITY];
+    size_t atlases_count;
+    Texture_Atlas atlases[ASSETS_ATLASES_CAPACITY];
+
+    size_t loads_count;
+    Asset_Load loads[ASSETS_LOADS_CAPACITY];
+
+    // Reload state
+    char reload_buffer[ASSETS_CONF_BUFFER_CAPACITY];
+    size_t reloads_count;
+    size_t reloads[ASSETS_LOADS_CAPACITY];
+    SDL_Surface *reloaded_surfaces[ASSETS_TEXTURES_CAPACITY];
+    Sample_S16 reloaded_samples[ASSETS_SOUNDS_CAPACITY];
+
+    // NOTE: the data pack mapped by load_pack(). When it's loaded the
+    // pixels, the samples and the ids point right into it, so they
+    // are read-only and are not freed one by one.
+    uint8_t *pack_data;
+    size_t pack_size;
+    const Sprite *pack_sprites;
+    bool pack_sprites_copied;
+
+    // NOTE: the ids are looked up in the perfect hash tables generated
+    // into assets_types.hpp by assets_typer. If the loaded assets do
+    // not match the tables (assets.conf was changed and reloaded
+    // without rebuilding the game), the lookups fall back to the
+    // linear search.
+    bool ids_tables_match;
+    void check_ids_tables();
+
+    // NOTE: Texture residency. The atlases are uploaded to the GPU on
+    // their first draw (or prefetch) and the least recently drawn ones
+    // are evicted once the resident atlases take more than
+    // ASSETS_VRAM_BUDGET_MB. The atlases drawn in the current frame
+    // are never evicted, because the sprite batch still refers to
+    // them, so a single frame that needs more than the budget goes
+    // over it.
+    SDL_Renderer *renderer;
+    Uint64 residency_frame;
+    size_t resident_bytes;
+    size_t evicted_bytes;
+    size_t uploads_count;
+    size_t evictions_count;
+
+    void begin_frame();
+    SDL_Texture *resident_atlas(size_t atlas);
+    SDL_Texture *pin_atlas(size_t atlas);
+    void prefetch(Texture_Index index);
+    void upload_atlas(size_t atlas);
+    void release_atlas(size_t atlas);
+    void evict_over_budget();
 
     Maybe<Texture_Index> get_texture_by_id(String_View id);
     Texture get_texture_by_index(Texture_Index index);
+    // NOTE: makes the atlas resident
+    Texture_Atlas get_atlas_of_texture(Texture_Index index);
 
     Maybe<Sample_S16_Index> get_sound_by_id(String_View id);
     Sample_S16 get_sound_by_index(Sample_S16_Index index);
 
     Maybe<Frames_Index> get_frames_by_id(String_View id);
-    Frames get_frames_by_index(Frames_Index index);
+    // NOTE: points right into the frame table, the pointer stays
+    // valid across the reloads because they keep the indices
+    const Frames *get_frames_by_index(Frames_Index index);
 
-    String_View load_file_into_conf_buffer(const char *filepath);
-    void load_texture(SDL_Renderer *renderer, String_View id, String_View path);
-    void load_sound(String_View id, String_View path);
-    void load_frames(String_View id, String_View path);
+    String_View load_file_into_conf_buffer(const char *filepath, char *buffer);
+    size_t parse_conf(String_View input, const char *filepath, Asset_Entry *entries);
+    Asset_Entry entry_of(const Asset_Load *load) const;
+    // NOTE: the loading is split into a CPU phase that runs on the
+    // worker threads (load_texture, load_sound, load_frames and
+    // blit_texture only touch their own asset) and a GPU phase on the
+    // calling thread. run_parallel() returns the amount of threads
+    // that did the job.
+    size_t run_parallel(Assets_Job job, size_t count);
+    void load_texture(size_t index);
+    void blit_texture(size_t index);
+    void pack_atlases(SDL_Renderer *renderer);
+    void load_sound(size_t index);
+    void load_frames(size_t index);
 
     void clean();
     void load_conf(SDL_Renderer *renderer, const char *filepath);
+    void load_pack(SDL_Renderer *renderer, const char *filepath);
+    // NOTE: the release build loads the data pack, the debug build
+    // loads assets.conf
+    void load(SDL_Renderer *renderer);
+
+    // NOTE: Reloads only the assets whose files changed, keeping them
+    // at the same indices. The animats that use a changed texture are
+    // rebuilt, only the changed sounds are stopped in the mixer. Falls
+    // back to a full load when the list of the assets changed.
+    Assets_Reload reload_conf(SDL_Renderer *renderer, const char *filepath,
+                              Sample_Mixer *mixer);
+    Assets_Reload reload(SDL_Renderer *renderer, Sample_Mixer *mixer);
 };
 
 extern Assets assets;
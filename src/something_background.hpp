@@ -7,7 +7,7 @@ struct Background
 {
     Sprite layers[BACKGROUND_LAYERS_COUNT];
 
-    void render(SDL_Renderer *renderer, Camera camera);
+    void render(Sprite_Batch *batch, Camera camera) const;
 };
 
 #endif  // SOMETHING_BACKGROUND_HPP_
@@ -6,21 +6,33 @@ struct Camera
     Vec2f pos;
     Vec2f vel;
 
-    Vec2f to_screen(Vec2f world_pos)
+    Vec2f to_screen(Vec2f world_pos) const
     {
         return world_pos - (pos - vec2((float) SCREEN_WIDTH, (float) SCREEN_HEIGHT) * 0.5f);
     }
 
-    Rectf to_screen(Rectf world_rect)
+    Rectf to_screen(Rectf world_rect) const
     {
         return world_rect - (pos - vec2((float) SCREEN_WIDTH, (float) SCREEN_HEIGHT) * 0.5f);
     }
 
-    Vec2f to_world(Vec2f screen_pos)
+    Vec2f to_world(Vec2f screen_pos) const
     {
         return screen_pos + (pos - vec2((float) SCREEN_WIDTH, (float) SCREEN_HEIGHT) * 0.5f);
     }
 
+    // NOTE: the part of the world that is visible on the screen,
+    // extended by padding on every side
+    Rectf view(float padding) const
+    {
+        return {
+            pos.x - (float) SCREEN_WIDTH * 0.5f - padding,
+            pos.y - (float) SCREEN_HEIGHT * 0.5f - padding,
+            (float) SCREEN_WIDTH + padding * 2.0f,
+            (float) SCREEN_HEIGHT + padding * 2.0f
+        };
+    }
+
     void update(float delta_time)
     {
         pos += vel * delta_time;
@@ -176,3 +176,63 @@ void command_noclip(Game *game, String_View args)
         game->console.println("Unknown parameter `", args, "`. Expected 'on' or 'off'");
     }
 }
+
+const char *const DEFAULT_SAVE_STATE_FILE_PATH = "./save.bin";
+
+static void save_state_file_path(String_View args, char *filepath, size_t filepath_size)
+{
+    args = args.trim();
+    if (args.count == 0) {
+        snprintf(filepath, filepath_size, "%s", DEFAULT_SAVE_STATE_FILE_PATH);
+    } else {
+        snprintf(filepath, filepath_size, "%.*s", (int) args.count, args.data);
+    }
+}
+
+void command_save(Game *game, String_View args)
+{
+    char filepath[256];
+    save_state_file_path(args, filepath, sizeof(filepath));
+
+    const Uint64 begin = SDL_GetPerformanceCounter();
+    save_game_state(game, &save_state_to_write);
+    const Uint64 end = SDL_GetPerformanceCounter();
+
+    FILE *f = fopen(filepath, "wb");
+    if (!f) {
+        game->console.println("Could not open file `", filepath, "`: ",
+                              strerror(errno));
+        return;
+    }
+    fwrite(save_state_to_write.bytes.data, 1, save_state_to_write.bytes.size, f);
+    fclose(f);
+
+    game->console.println("Saved ", save_state_to_write.bytes.size, " bytes to `", filepath, "` in ",
+                          (float) (end - begin) * 1000.0f / (float) SDL_GetPerformanceFrequency(), "ms");
+}
+
+void command_load(Game *game, String_View args)
+{
+    char filepath[256];
+    save_state_file_path(args, filepath, sizeof(filepath));
+
+    auto state = read_file_as_string_view(filepath);
+    if (!state.has_value) {
+        game->console.println("Could not read file `", filepath, "`: ",
+                              strerror(errno));
+        return;
+    }
+    defer(free((void *) state.unwrap.data));
+
+    const Uint64 begin = SDL_GetPerformanceCounter();
+    const char *error = load_game_state(game, state.unwrap);
+    const Uint64 end = SDL_GetPerformanceCounter();
+
+    if (error) {
+        game->console.println("Could not load `", filepath, "`: ", error);
+        return;
+    }
+
+    game->console.println("Loaded `", filepath, "` in ",
+                          (float) (end - begin) * 1000.0f / (float) SDL_GetPerformanceFrequency(), "ms");
+}
@@ -1,6 +1,8 @@
 #ifndef SOMETHING_COMMANDS_HPP_
 #define SOMETHING_COMMANDS_HPP_
 
+#include "something_save_state.hpp"
+
 struct Game;
 
 void command_help(Game *game, String_View args);
@@ -16,6 +18,9 @@ void command_save_room(Game *game, String_View args);
 Tile room_to_save[ROOM_WIDTH * ROOM_HEIGHT];
 void command_history(Game *game, String_View args);
 void command_noclip(Game *game, String_View args);
+void command_save(Game *game, String_View args);
+void command_load(Game *game, String_View args);
+Save_State save_state_to_write;
 
 struct Command
 {
@@ -28,12 +33,14 @@ const Command commands[] = {
     {"close"_sv,       "Close the console"_sv,                command_close},
     {"help"_sv,        "Print this help"_sv,                  command_help},
     {"history"_sv,     "Print the history of the Console"_sv, command_history},
+    {"load"_sv,        "Load the game state from a file"_sv,  command_load},
     {"noclip"_sv,      "Turn on/off noclip mode"_sv,          command_noclip},
     {"quit"_sv,        "Quit the game"_sv,                    command_quit},
 #ifndef SOMETHING_RELEASE
     {"reload"_sv,      "Reloads the configuration file"_sv,   command_reload},
 #endif // SOMETHING_RELEASE
     {"reset"_sv,       "Reset the state of the entities"_sv,  command_reset},
+    {"save"_sv,        "Save the game state to a file"_sv,    command_save},
     {"save_room"_sv,   "Save current room as new file"_sv,    command_save_room},
 #ifndef SOMETHING_RELEASE
     {"set"_sv,         "Set the value of a variable"_sv,      command_set},
@@ -2,29 +2,45 @@
 #include "something_console.hpp"
 
 
-void Console::render(SDL_Renderer *renderer, Bitmap_Font *font)
+static float console_visible_rows()
+{
+    return (float) min(CONSOLE_VISIBLE_ROWS, (int) CONSOLE_SNAPSHOT_ROWS_CAPACITY);
+}
+
+static float console_y(float slide_position)
+{
+    const float CONSOLE_EDIT_FIELD_ROW = 1.0f;
+    const float CONSOLE_HEIGHT = BITMAP_FONT_CHAR_HEIGHT * CONSOLE_FONT_SIZE * (console_visible_rows() + CONSOLE_EDIT_FIELD_ROW);
+    return -CONSOLE_HEIGHT + CONSOLE_HEIGHT * slide_position * slide_position;
+}
+
+static Vec2f console_edit_field_position(float slide_position)
+{
+    const auto prompt_size = Bitmap_Font {}.text_size(vec2(CONSOLE_FONT_SIZE, CONSOLE_FONT_SIZE), CONSOLE_PROMPT);
+    return vec2(prompt_size.x, console_y(slide_position) + console_visible_rows() * BITMAP_FONT_CHAR_HEIGHT * CONSOLE_FONT_SIZE);
+}
+
+void Console_Snapshot::render(SDL_Renderer *renderer, Bitmap_Font *font) const
 {
     if (slide_position > 0.0f) {
         const float CONSOLE_EDIT_FIELD_ROW = 1.0f;
-        const float CONSOLE_HEIGHT = BITMAP_FONT_CHAR_HEIGHT * CONSOLE_FONT_SIZE * (CONSOLE_VISIBLE_ROWS + CONSOLE_EDIT_FIELD_ROW);
+        const float CONSOLE_HEIGHT = BITMAP_FONT_CHAR_HEIGHT * CONSOLE_FONT_SIZE * (console_visible_rows() + CONSOLE_EDIT_FIELD_ROW);
 
-        const float console_y = -CONSOLE_HEIGHT + CONSOLE_HEIGHT * slide_position * slide_position;
+        const float y = console_y(slide_position);
 
         // BACKGROUND
-        fill_rect(renderer, rect(vec2(0.0f, console_y), SCREEN_WIDTH, CONSOLE_HEIGHT), CONSOLE_BACKGROUND_COLOR);
+        fill_rect(renderer, rect(vec2(0.0f, y), SCREEN_WIDTH, CONSOLE_HEIGHT), CONSOLE_BACKGROUND_COLOR);
 
         // ROWS
-        for (int i = 0; i < min(CONSOLE_VISIBLE_ROWS, (int) count); ++i) {
-            const auto index = mod(begin + count - 1 - i - scroll, CONSOLE_ROWS);
-            const auto position = vec2(0.0f, console_y + (float)((CONSOLE_VISIBLE_ROWS - i - 1) * BITMAP_FONT_CHAR_HEIGHT * CONSOLE_FONT_SIZE));
+        for (size_t i = 0; i < rows_size; ++i) {
+            const auto position = vec2(0.0f, y + (console_visible_rows() - (float) i - 1.0f) * BITMAP_FONT_CHAR_HEIGHT * CONSOLE_FONT_SIZE);
             font->render(renderer, position, vec2(CONSOLE_FONT_SIZE, CONSOLE_FONT_SIZE),
-                         FONT_DEBUG_COLOR, String_View {rows_count[index], rows[index]});
+                         FONT_DEBUG_COLOR, String_View {rows_count[i], rows[i]});
         }
 
         // EDIT FIELD
+        const auto edit_field_position = console_edit_field_position(slide_position);
         const auto prompt_size = font->text_size(vec2(CONSOLE_FONT_SIZE, CONSOLE_FONT_SIZE), CONSOLE_PROMPT);
-        const auto edit_field_position =
-            vec2(prompt_size.x, console_y + (float)(CONSOLE_VISIBLE_ROWS * BITMAP_FONT_CHAR_HEIGHT * CONSOLE_FONT_SIZE));
         font->render(renderer, edit_field_position - vec2(prompt_size.x, 0.0f), vec2(CONSOLE_FONT_SIZE, CONSOLE_FONT_SIZE),
                  FONT_DEBUG_COLOR, CONSOLE_PROMPT);
         edit_field.render(renderer, font, edit_field_position);
@@ -36,6 +52,26 @@ void Console::render(SDL_Renderer *renderer, Bitmap_Font *font)
     }
 }
 
+void Console::snapshot(Console_Snapshot *output) const
+{
+    output->enabled = enabled;
+    output->slide_position = slide_position;
+    output->rows_size = 0;
+
+    if (slide_position > 0.0f) {
+        output->rows_size = min((size_t) console_visible_rows(), count);
+        for (size_t i = 0; i < output->rows_size; ++i) {
+            const auto index = mod(begin + count - 1 - i - scroll, CONSOLE_ROWS);
+            memcpy(output->rows[i], rows[index], rows_count[index]);
+            output->rows_count[i] = rows_count[index];
+        }
+    }
+
+    output->edit_field = edit_field;
+    output->completion_popup_enabled = completion_popup_enabled;
+    output->completion_popup = completion_popup;
+}
+
 void Console::update(float dt)
 {
     if (enabled) {
@@ -44,16 +80,16 @@ void Console::update(float dt)
     } else {
         if (slide_position > 0.0f) slide_position -= dt * CONSOLE_SLIDE_SPEED;
     }
+
+    completion_popup.flipped = completion_popup.flips_at(
+        edit_field.cursor_position(console_edit_field_position(slide_position)));
 }
 
+// NOTE: SDL text input is started and stopped by the main thread
+// based on the enabled flag of the Console_Snapshot.
 void Console::toggle()
 {
     enabled = !enabled;
-    if (enabled) {
-        SDL_StartTextInput();
-    } else {
-        SDL_StopTextInput();
-    }
 }
 
 void Console::start_autocompletion()
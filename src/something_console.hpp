@@ -6,6 +6,27 @@
 
 struct Game;
 
+const size_t CONSOLE_SNAPSHOT_ROWS_CAPACITY = 64;
+
+// NOTE: Console_Snapshot only keeps the rows that are visible on the
+// screen. The whole CONSOLE_ROWS history is too big to be copied on
+// every simulation step.
+struct Console_Snapshot
+{
+    bool enabled;
+    float slide_position;
+
+    char rows[CONSOLE_SNAPSHOT_ROWS_CAPACITY][CONSOLE_COLUMNS];
+    size_t rows_count[CONSOLE_SNAPSHOT_ROWS_CAPACITY];
+    size_t rows_size;
+
+    Edit_Field edit_field;
+    bool completion_popup_enabled;
+    Select_Popup completion_popup;
+
+    void render(SDL_Renderer *renderer, Bitmap_Font *font) const;
+};
+
 struct Console
 {
     struct History
@@ -39,7 +60,7 @@ struct Console
     bool completion_popup_enabled;
     Select_Popup completion_popup;
 
-    void render(SDL_Renderer *renderer, Bitmap_Font *font);
+    void snapshot(Console_Snapshot *output) const;
     void update(float dt);
     void toggle();
 
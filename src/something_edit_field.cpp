@@ -1,6 +1,6 @@
 #include "something_edit_field.hpp"
 
-void Edit_Field::render(SDL_Renderer *renderer, Bitmap_Font *font, Vec2f edit_field_position)
+void Edit_Field::render(SDL_Renderer *renderer, Bitmap_Font *font, Vec2f edit_field_position) const
 {
     // EDIT FIELD
     font->render(renderer, edit_field_position, vec2(CONSOLE_FONT_SIZE, CONSOLE_FONT_SIZE),
@@ -50,7 +50,7 @@ void Edit_Field::render(SDL_Renderer *renderer, Bitmap_Font *font, Vec2f edit_fi
         }
 }
 
-Vec2f Edit_Field::cursor_position(Vec2f edit_field_position)
+Vec2f Edit_Field::cursor_position(Vec2f edit_field_position) const
 {
     const auto cursor_x = edit_field_cursor * BITMAP_FONT_CHAR_WIDTH * CONSOLE_FONT_SIZE + edit_field_position.x;
     return {cursor_x, edit_field_position.y};
@@ -15,11 +15,11 @@ struct Edit_Field
     bool completion_popup_enabled;
     float blink_angle;
 
-    void render(SDL_Renderer *renderer, Bitmap_Font *font, Vec2f position);
+    void render(SDL_Renderer *renderer, Bitmap_Font *font, Vec2f position) const;
     void update(float dt);
     void handle_event(SDL_Event *event);
 
-    Vec2f cursor_position(Vec2f edit_field_position);
+    Vec2f cursor_position(Vec2f edit_field_position) const;
 
     String_View as_string_view();
     void clean();
@@ -22,132 +22,127 @@ RGBA mix_colors(RGBA b32, RGBA a32)
     return r;
 }
 
-void Entity::render(SDL_Renderer *renderer, Camera camera, RGBA shade) const
+Entity_Snapshot Entity::snapshot(RGBA shade) const
 {
-    const SDL_RendererFlip flip =
+    Entity_Snapshot result = {};
+    result.state = state;
+    result.texbox_world = texbox_world();
+    result.hitbox_world = hitbox_world();
+    result.flip =
         gun_dir.x > 0.0f ?
         SDL_FLIP_NONE :
         SDL_FLIP_HORIZONTAL;
 
-    // TODO(#185): should we use shade for the particles of an entity?
-    particles.render(renderer, camera);
-
     switch (state) {
     case Entity_State::Alive: {
         // Figuring out texbox
-        Rectf texbox = {};
-
         switch (jump_state) {
         case Jump_State::No_Jump:
-            texbox = texbox_world();
+            result.render_box = texbox_world();
             break;
 
         case Jump_State::Prepare:
-            texbox = prepare_for_jump_animat.transform_rect(texbox_local, pos);
+            result.render_box = prepare_for_jump_animat.transform_rect(texbox_local, pos);
             break;
 
         case Jump_State::Jump:
-            texbox = jump_animat.transform_rect(texbox_local, pos);
+            result.render_box = jump_animat.transform_rect(texbox_local, pos);
             break;
         }
 
+        RGBA effective_flash_color = flash_color;
+        effective_flash_color.a = flash_alpha;
+        result.shade = mix_colors(shade, effective_flash_color);
+
+        switch (alive_state) {
+        case Alive_State::Idle:
+            result.animat = idle;
+            break;
+
+        case Alive_State::Walking:
+            result.animat = walking;
+            break;
+        }
+
+        result.lives_percent = (float) lives / (float) ENTITY_MAX_LIVES;
+        result.gun_begin = pos;
+        result.gun_end = pos + normalize(gun_dir) * ENTITY_GUN_LENGTH;
+    } break;
+
+    case Entity_State::Poof: {
+        // TODO(#151): Poof state loses last alive frame
+        //   Previous animation implementation was capturing texture of last alive state.
+        //   So if entity was shot in running pose it was squashing in this position.
+        //   So there's no sudden graphical switch to idle texture.
+        result.render_box = poof_animat.transform_rect(texbox_local, pos);
+        result.animat = idle;
+        result.shade = shade;
+    } break;
+
+    case Entity_State::Ded: {} break;
+    }
+
+    return result;
+}
+
+void Entity_Snapshot::render(Sprite_Batch *batch, Camera camera) const
+{
+    switch (state) {
+    case Entity_State::Alive: {
         // Rendering Live Bar
         {
             const Rectf livebar_border = {
-                texbox.x + texbox.w * 0.5f - ENTITY_LIVEBAR_WIDTH * 0.5f,
-                texbox.y - ENTITY_LIVEBAR_HEIGHT - ENTITY_LIVEBAR_PADDING_BOTTOM,
+                render_box.x + render_box.w * 0.5f - ENTITY_LIVEBAR_WIDTH * 0.5f,
+                render_box.y - ENTITY_LIVEBAR_HEIGHT - ENTITY_LIVEBAR_PADDING_BOTTOM,
                 ENTITY_LIVEBAR_WIDTH,
                 ENTITY_LIVEBAR_HEIGHT
             };
-            const float percent = (float) lives / (float) ENTITY_MAX_LIVES;
+            const float percent = lives_percent;
             const Rectf livebar_remain = {
                 livebar_border.x, livebar_border.y,
                 ENTITY_LIVEBAR_WIDTH * percent,
                 ENTITY_LIVEBAR_HEIGHT
             };
+            RGBA livebar_color = ENTITY_LIVEBAR_LOW_COLOR;
             if (percent > 0.75f) {
-                const SDL_Color entity_livebar_full_color = rgba_to_sdl(ENTITY_LIVEBAR_FULL_COLOR);
-                sec(SDL_SetRenderDrawColor(
-                        renderer,
-                        entity_livebar_full_color.r,
-                        entity_livebar_full_color.g,
-                        entity_livebar_full_color.b,
-                        entity_livebar_full_color.a));
+                livebar_color = ENTITY_LIVEBAR_FULL_COLOR;
             } else if (0.25f < percent && percent < 0.75f) {
-                const SDL_Color entity_livebar_half_color = rgba_to_sdl(ENTITY_LIVEBAR_HALF_COLOR);
-                sec(SDL_SetRenderDrawColor(
-                        renderer,
-                        entity_livebar_half_color.r,
-                        entity_livebar_half_color.g,
-                        entity_livebar_half_color.b,
-                        entity_livebar_half_color.a));
-            } else {
-                const SDL_Color entity_livebar_low_color = rgba_to_sdl(ENTITY_LIVEBAR_LOW_COLOR);
-                sec(SDL_SetRenderDrawColor(
-                        renderer,
-                        entity_livebar_low_color.r,
-                        entity_livebar_low_color.g,
-                        entity_livebar_low_color.b,
-                        entity_livebar_low_color.a));
+                livebar_color = ENTITY_LIVEBAR_HALF_COLOR;
             }
-            const auto rect_border = rectf_for_sdl(camera.to_screen(livebar_border));
-            sec(SDL_RenderDrawRect(renderer, &rect_border));
-            const auto rect_remain = rectf_for_sdl(camera.to_screen(livebar_remain));
-            sec(SDL_RenderFillRect(renderer, &rect_remain));
+            batch->draw_rect(SPRITE_LAYER_ENTITY_BARS, camera.to_screen(livebar_border), livebar_color);
+            batch->fill_rect(SPRITE_LAYER_ENTITY_BARS, camera.to_screen(livebar_remain), livebar_color);
         }
 
-        RGBA effective_flash_color = flash_color;
-        effective_flash_color.a = flash_alpha;
-
         // Render the character
-        switch (alive_state) {
-        case Alive_State::Idle: {
-            idle.render(
-                renderer, camera.to_screen(texbox), flip,
-                mix_colors(shade, effective_flash_color));
-        } break;
-
-        case Alive_State::Walking: {
-            walking.render(
-                renderer, camera.to_screen(texbox), flip,
-                mix_colors(shade, effective_flash_color));
-        } break;
-        }
+        animat.render(batch, SPRITE_LAYER_ENTITIES, camera.to_screen(render_box), flip, shade);
 
         // Render the gun
         // TODO(#59): Proper gun rendering
-        Vec2f gun_begin = pos;
-        render_line(
-            renderer,
+        batch->line(
+            SPRITE_LAYER_ENTITY_BARS,
             camera.to_screen(gun_begin),
-            camera.to_screen(gun_begin + normalize(gun_dir) * ENTITY_GUN_LENGTH),
+            camera.to_screen(gun_end),
             {1.0f, 0.0f, 0.0f, 1.0f});
     } break;
 
     case Entity_State::Poof: {
-        Rectf texbox = poof_animat.transform_rect(texbox_local, pos);
-        // TODO(#151): Poof state loses last alive frame
-        //   Previous animation implementation was capturing texture of last alive state.
-        //   So if entity was shot in running pose it was squashing in this position.
-        //   So there's no sudden graphical switch to idle texture.
-        idle.render(renderer, camera.to_screen(texbox), flip, shade);
+        animat.render(batch, SPRITE_LAYER_ENTITIES, camera.to_screen(render_box), flip, shade);
     } break;
 
     case Entity_State::Ded: {} break;
     }
 }
 
-void Entity::render_debug(SDL_Renderer *renderer, Camera camera) const
+void Entity_Snapshot::render_debug(SDL_Renderer *renderer, Camera camera) const
 {
     if (state == Entity_State::Alive) {
-        const float step_x = hitbox_local.w / (float) ENTITY_MESH_COLS;
-        const float step_y = hitbox_local.h / (float) ENTITY_MESH_ROWS;
+        const float step_x = hitbox_world.w / (float) ENTITY_MESH_COLS;
+        const float step_y = hitbox_world.h / (float) ENTITY_MESH_ROWS;
 
         for (int rows = 0; rows <= ENTITY_MESH_ROWS; ++rows) {
             for (int cols = 0; cols <= ENTITY_MESH_COLS; ++cols) {
                 Vec2f t = camera.to_screen(
-                    pos +
-                    vec2(hitbox_local.x, hitbox_local.y) +
+                    vec2(hitbox_world.x, hitbox_world.y) +
                     vec2(cols * step_x, rows * step_y));
                 SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
                 const int PROBE_SIZE = 10;
@@ -167,7 +162,7 @@ HSLA get_particle_color_for_tile(Tile_Grid *grid, Vec2f pos)
 {
     const auto tile_sprite = tile_defs[*grid->tile_at_abs(pos + vec2(0.0f, TILE_SIZE * 0.5f))].top_texture;
     const auto surface = assets.get_texture_by_index(tile_sprite.texture_index).surface;
-    const auto x = rand() % tile_sprite.srcrect.w;
+    const auto x = (int) (random_u32() % (uint32_t) tile_sprite.srcrect.w);
     sec(SDL_LockSurface(surface));
     HSLA result = {};
     {
@@ -210,21 +205,7 @@ void Entity::update(float dt, Sample_Mixer *mixer, Tile_Grid *grid)
     switch (state) {
     case Entity_State::Alive: {
         flash_alpha = fmax(0.0f, flash_alpha - ENTITY_FLASH_ALPHA_DECAY * dt);
-
-        if (!noclip) {
-            vel.y += ENTITY_GRAVITY * dt;
-        }
-
-        const float ENTITY_DECEL = ENTITY_SPEED * ENTITY_DECEL_FACTOR;
-        const float ENTITY_STOP_THRESHOLD = 100.0f;
-        if (fabs(vel.x) > ENTITY_STOP_THRESHOLD) {
-            vel.x -= sgn(vel.x) * ENTITY_DECEL * dt;
-        } else {
-            vel.x = 0.0f;
-        }
-
-        pos += vel * dt;
-        cooldown_weapon -= dt;
+        integrate(dt);
 
         switch (jump_state) {
         case Jump_State::No_Jump:
@@ -237,7 +218,7 @@ void Entity::update(float dt, Sample_Mixer *mixer, Tile_Grid *grid)
                 jump_state = Jump_State::Jump;
                 has_jumped = true;
                 vel.y = ENTITY_GRAVITY * -0.6f;
-                mixer->play_sample(jump_samples[rand() % 2]);
+                mixer->play_sample(jump_samples[random_u32() % JUMP_SAMPLES_CAPACITY], pos);
                 if (ground(grid)) {
                     for (int i = 0; i < ENTITY_JUMP_PARTICLE_BURST; ++i) {
                         particles.push(rand_float_range(PARTICLE_JUMP_VEL_LOW, PARTICLE_JUMP_VEL_HIGH));
@@ -264,19 +245,6 @@ void Entity::update(float dt, Sample_Mixer *mixer, Tile_Grid *grid)
             break;
 
         case Alive_State::Walking:
-            const float ENTITY_ACCEL = ENTITY_SPEED * ENTITY_ACCEL_FACTOR;
-            switch (walking_direction) {
-            case Left: {
-                vel.x = fmax(vel.x - ENTITY_ACCEL * dt,
-                             -ENTITY_SPEED);
-            } break;
-
-            case Right: {
-                vel.x = fminf(vel.x + ENTITY_ACCEL * dt,
-                              ENTITY_SPEED);
-            } break;
-            }
-
             walking.update(dt);
             break;
         }
@@ -293,6 +261,73 @@ void Entity::update(float dt, Sample_Mixer *mixer, Tile_Grid *grid)
     }
 }
 
+void Entity::update_coarse(float dt)
+{
+    particles.state = Particles::DISABLED;
+    particles.count = 0;
+
+    switch (state) {
+    case Entity_State::Alive: {
+        flash_alpha = 0.0f;
+        integrate(dt);
+
+        switch (jump_state) {
+        case Jump_State::No_Jump:
+            break;
+
+        case Jump_State::Prepare:
+            jump_state = Jump_State::Jump;
+            has_jumped = true;
+            vel.y = ENTITY_GRAVITY * -0.6f;
+            break;
+
+        case Jump_State::Jump:
+            jump_state = Jump_State::No_Jump;
+            break;
+        }
+    } break;
+
+    case Entity_State::Poof: {
+        state = Entity_State::Ded;
+    } break;
+
+    case Entity_State::Ded: {} break;
+    }
+}
+
+void Entity::integrate(float dt)
+{
+    if (!noclip) {
+        vel.y += ENTITY_GRAVITY * dt;
+    }
+
+    const float ENTITY_DECEL = ENTITY_SPEED * ENTITY_DECEL_FACTOR;
+    const float ENTITY_STOP_THRESHOLD = 100.0f;
+    if (fabs(vel.x) > ENTITY_STOP_THRESHOLD) {
+        vel.x -= sgn(vel.x) * ENTITY_DECEL * dt;
+    } else {
+        vel.x = 0.0f;
+    }
+
+    pos += vel * dt;
+    cooldown_weapon -= dt;
+
+    if (alive_state == Alive_State::Walking) {
+        const float ENTITY_ACCEL = ENTITY_SPEED * ENTITY_ACCEL_FACTOR;
+        switch (walking_direction) {
+        case Left: {
+            vel.x = fmax(vel.x - ENTITY_ACCEL * dt,
+                         -ENTITY_SPEED);
+        } break;
+
+        case Right: {
+            vel.x = fminf(vel.x + ENTITY_ACCEL * dt,
+                          ENTITY_SPEED);
+        } break;
+        }
+    }
+}
+
 void Entity::point_gun_at(Vec2f target)
 {
     gun_dir = target - pos;
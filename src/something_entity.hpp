@@ -28,6 +28,28 @@ const size_t JUMP_SAMPLES_CAPACITY = 2;
 
 const size_t WEAPON_SLOTS_CAPACITY = 10;
 
+// NOTE: Entity_Snapshot is everything the renderer needs to know
+// about an Entity. It is produced by the simulation thread and
+// rendered by the main thread (see something_snapshot.hpp).
+struct Entity_Snapshot
+{
+    Entity_State state;
+    Frames_Animat animat;
+    Rectf render_box;
+    Rectf texbox_world;
+    Rectf hitbox_world;
+    SDL_RendererFlip flip;
+    RGBA shade;
+    float lives_percent;
+    Vec2f gun_begin;
+    Vec2f gun_end;
+    size_t particles_begin;
+    size_t particles_count;
+
+    void render(Sprite_Batch *batch, Camera camera) const;
+    void render_debug(SDL_Renderer *renderer, Camera camera) const;
+};
+
 struct Entity
 {
     enum Direction
@@ -73,6 +95,10 @@ struct Entity
     int count_jumps;
     int max_allowed_jumps;
 
+    // NOTE: AI scheduling state, see Game::update_enemies_ai()
+    uint32_t next_think_tick;
+    bool sees_target;
+
     Particles particles;
 
     void kill();
@@ -97,10 +123,12 @@ struct Entity
         return hitbox;
     }
 
-    void render(SDL_Renderer *renderer, Camera camera,
-                RGBA shade = {0, 0, 0, 0}) const;
-    void render_debug(SDL_Renderer *renderer, Camera camera) const;
+    Entity_Snapshot snapshot(RGBA shade = {0, 0, 0, 0}) const;
     void update(float dt, Sample_Mixer *mixer, Tile_Grid *grid);
+    // NOTE: cheap version of update() for the entities outside of the
+    // player's room. No particles, no animations, no sounds.
+    void update_coarse(float dt);
+    void integrate(float dt);
     void point_gun_at(Vec2f target);
     void jump();
     void flash(RGBA color);
@@ -0,0 +1,140 @@
+#include <sys/stat.h>
+
+#include "something_fmw.hpp"
+
+bool Fmw_Queue::push(const Fmw_Change *change)
+{
+    const int current = SDL_AtomicGet(&end);
+    const int next = (current + 1) % (int) FMW_QUEUE_CAPACITY;
+    if (next == SDL_AtomicGet(&begin)) {
+        return false;
+    }
+
+    changes[current] = *change;
+    SDL_AtomicSet(&end, next);
+    return true;
+}
+
+bool Fmw_Queue::pop(Fmw_Change *change)
+{
+    const int current = SDL_AtomicGet(&begin);
+    if (current == SDL_AtomicGet(&end)) {
+        return false;
+    }
+
+    *change = changes[current];
+    SDL_AtomicSet(&begin, (current + 1) % (int) FMW_QUEUE_CAPACITY);
+    return true;
+}
+
+// NOTE: swap files and backups of the editors
+static bool fmw_is_ignored(const char *path)
+{
+    const char *name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    const size_t n = strlen(name);
+    return n == 0 || name[0] == '.' || name[n - 1] == '~';
+}
+
+void Fmw::touch(const char *path)
+{
+    if (fmw_is_ignored(path)) {
+        return;
+    }
+
+    const size_t n = strlen(path);
+    if (n >= FMW_PATH_CAPACITY) {
+        println(stderr, "[WARN] Path is too long to be watched: ", path);
+        return;
+    }
+
+    const Uint32 now = SDL_GetTicks();
+    for (size_t i = 0; i < pending_count; ++i) {
+        if (strcmp(pending[i].change.path, path) == 0) {
+            pending[i].last_event = now;
+            return;
+        }
+    }
+
+    if (pending_count >= FMW_PENDING_CAPACITY) {
+        // NOTE: too many files are changing at once, so everything
+        // that is pending goes out without waiting for it to settle
+        flush(now + FMW_QUIET_MS);
+        if (pending_count >= FMW_PENDING_CAPACITY) {
+            println(stderr, "[WARN] File change queue overflow. Dropping ", path);
+            return;
+        }
+    }
+
+    Fmw_Pending *entry = &pending[pending_count++];
+    memcpy(entry->change.path, path, n + 1);
+    entry->last_event = now;
+}
+
+void Fmw::flush(Uint32 now)
+{
+    size_t i = 0;
+    while (i < pending_count) {
+        if (now - pending[i].last_event < FMW_QUIET_MS) {
+            i += 1;
+            continue;
+        }
+
+        struct stat statbuf = {};
+        if (stat(pending[i].change.path, &statbuf) == 0 && !queue.push(&pending[i].change)) {
+            // NOTE: the main thread did not catch up yet, the rest
+            // of the changes stay pending until the next flush
+            break;
+        }
+
+        for (size_t j = i + 1; j < pending_count; ++j) {
+            pending[j - 1] = pending[j];
+        }
+        pending_count -= 1;
+    }
+}
+
+static int fmw_thread(void *data)
+{
+    Fmw *fmw = (Fmw*) data;
+    while (!SDL_AtomicGet(&fmw->stop)) {
+        fmw_backend_wait(fmw->backend, fmw, FMW_WAIT_MS);
+        fmw->flush(SDL_GetTicks());
+    }
+    return 0;
+}
+
+Fmw *fmw_init(const char *dirpath)
+{
+    Fmw_Backend *backend = fmw_backend_init(dirpath);
+    if (backend == NULL) {
+        return NULL;
+    }
+
+    Fmw *fmw = new Fmw {};
+    fmw->backend = backend;
+    fmw->thread = SDL_CreateThread(fmw_thread, "File Modification Watcher", fmw);
+    if (fmw->thread == NULL) {
+        println(stderr, "SDL_CreateThread() failed: ", SDL_GetError());
+        abort();
+    }
+
+    return fmw;
+}
+
+void fmw_free(Fmw *fmw)
+{
+    if (fmw == NULL) {
+        return;
+    }
+
+    SDL_AtomicSet(&fmw->stop, 1);
+    SDL_WaitThread(fmw->thread, NULL);
+    fmw_backend_free(fmw->backend);
+    delete fmw;
+}
+
+bool fmw_poll(Fmw *fmw, Fmw_Change *change)
+{
+    return fmw != NULL && fmw->queue.pop(change);
+}
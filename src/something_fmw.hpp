@@ -1,12 +1,72 @@
 #ifndef SOMETHING_FMW_HPP_
 #define SOMETHING_FMW_HPP_
 
-// NOTE: FMW stands for File Modification Watcher
+// NOTE: FMW stands for File Modification Watcher. It watches a whole
+// directory tree on its own thread. Editors save a file in several
+// steps (truncate, write, rename, chmod), so the events of the same
+// file are coalesced until the file stays quiet for FMW_QUIET_MS and
+// only then the change is handed over to the main thread through a
+// lock-free single producer single consumer queue.
 
-struct Fmw;
+const size_t FMW_PATH_CAPACITY = 256;
+const size_t FMW_PENDING_CAPACITY = 64;
+const size_t FMW_QUEUE_CAPACITY = 64;
+const Uint32 FMW_QUIET_MS = 100;
+const int FMW_WAIT_MS = 20;
 
-Fmw *fmw_init(const char *filepath);
+struct Fmw_Change
+{
+    // NOTE: the path of the changed file, with forward slashes and
+    // starting with the watched directory, like
+    // "./assets/sprites/player.png"
+    char path[FMW_PATH_CAPACITY];
+};
+
+struct Fmw_Queue
+{
+    Fmw_Change changes[FMW_QUEUE_CAPACITY];
+    SDL_atomic_t begin;
+    SDL_atomic_t end;
+
+    bool push(const Fmw_Change *change);
+    bool pop(Fmw_Change *change);
+};
+
+struct Fmw_Pending
+{
+    Fmw_Change change;
+    Uint32 last_event;
+};
+
+struct Fmw_Backend;
+
+struct Fmw
+{
+    Fmw_Backend *backend;
+    SDL_Thread *thread;
+    SDL_atomic_t stop;
+
+    // NOTE: only touched by the watcher thread
+    Fmw_Pending pending[FMW_PENDING_CAPACITY];
+    size_t pending_count;
+
+    Fmw_Queue queue;
+
+    void touch(const char *path);
+    void flush(Uint32 now);
+};
+
+Fmw *fmw_init(const char *dirpath);
 void fmw_free(Fmw *fmw);
-bool fmw_poll(Fmw *fmw);
+// NOTE: pops the next change, call it until it returns false.
+// Deleted files are not reported.
+bool fmw_poll(Fmw *fmw, Fmw_Change *change);
+
+// NOTE: implemented by something_fmw_<backend>.cpp. The wait blocks
+// for at most timeout_ms and reports every changed file with
+// Fmw::touch() on the watcher thread.
+Fmw_Backend *fmw_backend_init(const char *dirpath);
+void fmw_backend_free(Fmw_Backend *backend);
+void fmw_backend_wait(Fmw_Backend *backend, Fmw *fmw, int timeout_ms);
 
 #endif  // SOMETHING_FMW_HPP_
@@ -1,17 +1,16 @@
 #include "something_fmw.hpp"
 
-struct Fmw {};
+struct Fmw_Backend {};
 
-Fmw *fmw_init(const char *)
+Fmw_Backend *fmw_backend_init(const char *)
 {
     return NULL;
 }
 
-void fmw_free(Fmw *)
+void fmw_backend_free(Fmw_Backend *)
 {
 }
 
-bool fmw_poll(Fmw *)
+void fmw_backend_wait(Fmw_Backend *, Fmw *, int)
 {
-    return false;
 }
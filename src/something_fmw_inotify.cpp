@@ -1,56 +1,167 @@
+#include <dirent.h>
+#include <poll.h>
 #include <sys/inotify.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include "something_fmw.hpp"
 
-struct Fmw
+// NOTE: inotify is not recursive, every directory of the tree gets a
+// watch of its own
+const size_t FMW_INOTIFY_WATCHES_CAPACITY = 256;
+const uint32_t FMW_INOTIFY_MASK =
+    IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM;
+
+struct Fmw_Inotify_Watch
 {
-    int fd;
     int wd;
+    char dirpath[FMW_PATH_CAPACITY];
 };
 
-Fmw *fmw_init(const char *filepath)
+struct Fmw_Backend
+{
+    int fd;
+    Fmw_Inotify_Watch watches[FMW_INOTIFY_WATCHES_CAPACITY];
+    size_t watches_count;
+};
+
+// NOTE: when fmw is not NULL the directory appeared after the watcher
+// was started, so the files that were put into it before the watch
+// was added are reported as changed
+static void fmw_inotify_watch_tree(Fmw_Backend *backend, Fmw *fmw, const char *dirpath)
+{
+    if (backend->watches_count >= FMW_INOTIFY_WATCHES_CAPACITY) {
+        println(stderr, "[WARN] Too many directories to watch. Ignoring ", dirpath);
+        return;
+    }
+
+    const int wd = inotify_add_watch(backend->fd, dirpath, FMW_INOTIFY_MASK | IN_ONLYDIR);
+    if (wd == -1) {
+        println(stderr, "[WARN] inotify_add_watch() failed: ", dirpath, ": ", strerror(errno));
+        return;
+    }
+
+    Fmw_Inotify_Watch *watch = &backend->watches[backend->watches_count++];
+    watch->wd = wd;
+    snprintf(watch->dirpath, sizeof(watch->dirpath), "%s", dirpath);
+
+    DIR *dir = opendir(dirpath);
+    if (dir == NULL) {
+        return;
+    }
+    defer(closedir(dir));
+
+    for (dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        char path[FMW_PATH_CAPACITY];
+        const int n = snprintf(path, sizeof(path), "%s/%s", dirpath, entry->d_name);
+        if (n < 0 || (size_t) n >= sizeof(path)) {
+            continue;
+        }
+
+        struct stat statbuf = {};
+        if (stat(path, &statbuf) < 0) {
+            continue;
+        }
+
+        if (S_ISDIR(statbuf.st_mode)) {
+            fmw_inotify_watch_tree(backend, fmw, path);
+        } else if (fmw) {
+            fmw->touch(path);
+        }
+    }
+}
+
+Fmw_Backend *fmw_backend_init(const char *dirpath)
 {
-    Fmw *fmw = (Fmw*) malloc(sizeof(Fmw));
+    Fmw_Backend *backend = new Fmw_Backend {};
 
-    fmw->fd = inotify_init1(IN_NONBLOCK);
-    if (fmw->fd == -1) {
+    backend->fd = inotify_init1(IN_NONBLOCK);
+    if (backend->fd == -1) {
         println(stderr, "inotify_init() failed: ", strerror(errno));
         abort();
     }
 
-    fmw->wd = inotify_add_watch(fmw->fd, filepath, IN_MODIFY);
-    if (fmw->wd == -1) {
-        println(stderr, "inotify_add_watch() failed: ", strerror(errno));
+    char root[FMW_PATH_CAPACITY];
+    snprintf(root, sizeof(root), "%s", dirpath);
+    for (size_t n = strlen(root); n > 1 && root[n - 1] == '/'; --n) {
+        root[n - 1] = '\0';
+    }
+
+    fmw_inotify_watch_tree(backend, NULL, root);
+    if (backend->watches_count == 0) {
+        println(stderr, "Could not watch ", dirpath);
         abort();
     }
 
-    return fmw;
+    return backend;
 }
 
-void fmw_free(Fmw *fmw)
+void fmw_backend_free(Fmw_Backend *backend)
 {
-    close(fmw->fd);
-    free(fmw);
+    close(backend->fd);
+    delete backend;
 }
 
-bool fmw_poll(Fmw *fmw)
+void fmw_backend_wait(Fmw_Backend *backend, Fmw *fmw, int timeout_ms)
 {
-    inotify_event event = {};
-    char buffer[1024];
-
-    auto n = read(fmw->fd, &event, sizeof(event));
-    if (n != -1 || errno != EAGAIN) {
-        assert(n == sizeof(event));
+    pollfd pfd = {};
+    pfd.fd = backend->fd;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return;
+    }
 
-        // Skiping the name
-        size_t m = event.len;
-        while (m > 0) {
-            m -= read(fmw->fd, buffer, min(sizeof(buffer), m));
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        const ssize_t n = read(backend->fd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;
         }
 
-        return true;
-    }
+        const inotify_event *event = NULL;
+        for (ssize_t offset = 0; offset < n; offset += sizeof(*event) + event->len) {
+            event = (const inotify_event*) (buffer + offset);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                println(stderr, "[WARN] inotify queue overflow. Some file changes are lost");
+                continue;
+            }
+
+            size_t index = 0;
+            while (index < backend->watches_count && backend->watches[index].wd != event->wd) {
+                index += 1;
+            }
+            if (index >= backend->watches_count) {
+                continue;
+            }
+
+            if (event->mask & IN_IGNORED) {
+                // NOTE: the directory is gone
+                backend->watches[index] = backend->watches[--backend->watches_count];
+                continue;
+            }
 
-    return false;
+            if (event->len == 0) {
+                continue;
+            }
+
+            char path[FMW_PATH_CAPACITY];
+            const int m = snprintf(path, sizeof(path), "%s/%s", backend->watches[index].dirpath, event->name);
+            if (m < 0 || (size_t) m >= sizeof(path)) {
+                continue;
+            }
+
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    fmw_inotify_watch_tree(backend, fmw, path);
+                }
+            } else {
+                fmw->touch(path);
+            }
+        }
+    }
 }
@@ -2,100 +2,116 @@
 
 const int fmw_watch_buffer_size = 4096;
 
-struct Fmw {
+// NOTE: ReadDirectoryChangesW watches the whole subtree by itself, so
+// unlike the other backends there is a single handle for the root
+struct Fmw_Backend {
     HANDLE watch_dir;
     HANDLE iocp;
     int watch_bytes_received;
     unsigned char *watch_buffer;
+    char dirpath[FMW_PATH_CAPACITY];
 
     OVERLAPPED overlapped;
 };
 
-Fmw *fmw_init(const char *filepath)
+static void fmw_iocp_read_changes(Fmw_Backend *backend)
 {
-    Fmw *fmw = (Fmw*) malloc(sizeof(Fmw));
-    *fmw = {};
-
-    fmw->watch_buffer = (unsigned char *) malloc(fmw_watch_buffer_size);
+    backend->overlapped = {};
+    ReadDirectoryChangesW(backend->watch_dir, backend->watch_buffer, fmw_watch_buffer_size, 1,
+                          FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE,
+                          (LPDWORD)&backend->watch_bytes_received, &backend->overlapped, 0);
+}
 
-    char file_dir[1024];
+Fmw_Backend *fmw_backend_init(const char *dirpath)
+{
+    Fmw_Backend *backend = (Fmw_Backend*) malloc(sizeof(Fmw_Backend));
+    *backend = {};
 
-    size_t length = strlen(filepath);
-    size_t last_slash = length - 1;
+    backend->watch_buffer = (unsigned char *) malloc(fmw_watch_buffer_size);
 
-    for (size_t i = 0; i < length; ++i) {
-        if (filepath[length-i] == '\\' || filepath[length-i] == '/') {
-            last_slash = length-i;
-            break;
-        }
+    snprintf(backend->dirpath, sizeof(backend->dirpath), "%s", dirpath);
+    for (size_t n = strlen(backend->dirpath); n > 1 && (backend->dirpath[n - 1] == '/' || backend->dirpath[n - 1] == '\\'); --n) {
+        backend->dirpath[n - 1] = '\0';
     }
 
-    memcpy(file_dir, filepath, last_slash);
-    file_dir[last_slash] = 0;
-
-    fmw->watch_dir = CreateFileA(file_dir, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, 0);
+    backend->watch_dir = CreateFileA(backend->dirpath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, 0);
+    if (backend->watch_dir == INVALID_HANDLE_VALUE) {
+        println(stderr, "Could not watch ", dirpath);
+        abort();
+    }
 
-    ReadDirectoryChangesW(fmw->watch_dir, fmw->watch_buffer, fmw_watch_buffer_size, 1, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
-                          (LPDWORD)&fmw->watch_bytes_received, &fmw->overlapped, 0);
-    fmw->iocp = CreateIoCompletionPort(fmw->watch_dir, 0, 0, 0);
+    backend->iocp = CreateIoCompletionPort(backend->watch_dir, 0, 0, 0);
+    fmw_iocp_read_changes(backend);
 
-    return fmw;
+    return backend;
 }
 
-void fmw_free(Fmw *fmw)
+void fmw_backend_free(Fmw_Backend *backend)
 {
-    if (fmw->watch_dir && fmw->watch_dir != INVALID_HANDLE_VALUE) {
-        CloseHandle(fmw->watch_dir);
+    if (backend->watch_dir && backend->watch_dir != INVALID_HANDLE_VALUE) {
+        CloseHandle(backend->watch_dir);
     }
 
-    if (fmw->iocp && fmw->iocp != INVALID_HANDLE_VALUE) {
-        CloseHandle(fmw->iocp);
+    if (backend->iocp && backend->iocp != INVALID_HANDLE_VALUE) {
+        CloseHandle(backend->iocp);
     }
 
-    if (fmw->watch_buffer) {
-        free(fmw->watch_buffer);
+    if (backend->watch_buffer) {
+        free(backend->watch_buffer);
     }
 
-    free(fmw);
+    free(backend);
 }
 
-bool fmw_poll(Fmw *fmw)
+void fmw_backend_wait(Fmw_Backend *backend, Fmw *fmw, int timeout_ms)
 {
-    bool file_modified = false;
-
     OVERLAPPED *overlapped;
     DWORD overlapped_bytes;
     ULONG_PTR overlapped_key;
 
-    if (GetQueuedCompletionStatus(fmw->iocp, &overlapped_bytes, &overlapped_key, &overlapped, 1)) {
-        unsigned char *data = fmw->watch_buffer;
-
-        /* fyi, there's a fancy way to restore Fmw struct pointer here.
-
-            'overlapped' pointer returned by GetQueuedCompletionStatus()
-            points to 'OVERLAPPED overlapped;' member of Fmw struct
-            Ahere's a macro in winapi to get the base struct pointer from that:
-
-                Fmw *fmw = CONTAINING_RECORD(overlapped, fmw, overlapped);
-
-            this is useful when you have lots of different types of async tasks */
+    if (!GetQueuedCompletionStatus(backend->iocp, &overlapped_bytes, &overlapped_key, &overlapped, (DWORD) timeout_ms)) {
+        return;
+    }
 
-        int data_offset = 0;
+    if (overlapped_bytes == 0) {
+        // NOTE: the buffer overflowed and the system dropped the
+        // changes, there is no way to tell which files they were
+        println(stderr, "[WARN] ReadDirectoryChangesW buffer overflow. Some file changes are lost");
+    } else {
+        unsigned char *data = backend->watch_buffer;
+        DWORD data_offset = 0;
 
         do {
             FILE_NOTIFY_INFORMATION *file_info = (FILE_NOTIFY_INFORMATION *)data;
             data_offset = file_info->NextEntryOffset;
 
-            if (file_info->Action == FILE_ACTION_MODIFIED) {
-                file_modified = true;
+            if (file_info->Action != FILE_ACTION_REMOVED &&
+                file_info->Action != FILE_ACTION_RENAMED_OLD_NAME) {
+                // NOTE: the name is relative to the watched directory
+                // and is not NULL-terminated
+                char name[FMW_PATH_CAPACITY];
+                const int name_length = WideCharToMultiByte(
+                    CP_UTF8, 0,
+                    file_info->FileName, (int) (file_info->FileNameLength / sizeof(WCHAR)),
+                    name, (int) sizeof(name) - 1, NULL, NULL);
+
+                if (name_length > 0) {
+                    name[name_length] = '\0';
+                    for (int i = 0; i < name_length; ++i) {
+                        if (name[i] == '\\') name[i] = '/';
+                    }
+
+                    char path[FMW_PATH_CAPACITY];
+                    const int n = snprintf(path, sizeof(path), "%s/%s", backend->dirpath, name);
+                    if (n > 0 && (size_t) n < sizeof(path)) {
+                        fmw->touch(path);
+                    }
+                }
             }
 
             data += data_offset;
         } while (data_offset);
-
-        ReadDirectoryChangesW(fmw->watch_dir, fmw->watch_buffer, fmw_watch_buffer_size, 1, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
-                              (LPDWORD)&fmw->watch_bytes_received, &fmw->overlapped, 0);
     }
 
-    return file_modified;
+    fmw_iocp_read_changes(backend);
 }
@@ -1,65 +1,203 @@
+#include <dirent.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/event.h>
 
 #include "something_fmw.hpp"
 
-struct Fmw
+// NOTE: kqueue watches file descriptors, so every file and directory
+// of the tree is kept open. A directory reports NOTE_WRITE when an
+// entry is added to it, then it is scanned again for the new files.
+const size_t FMW_KQUEUE_ENTRIES_CAPACITY = 1024;
+const size_t FMW_KQUEUE_EVENTS_CAPACITY = 32;
+
+#ifdef O_EVTONLY
+const int FMW_KQUEUE_OPEN_FLAGS = O_EVTONLY;
+#else
+const int FMW_KQUEUE_OPEN_FLAGS = O_RDONLY;
+#endif // O_EVTONLY
+
+struct Fmw_Kqueue_Entry
 {
     int fd;
+    bool is_dir;
+    char path[FMW_PATH_CAPACITY];
+};
+
+struct Fmw_Backend
+{
     int kq;
+    Fmw_Kqueue_Entry entries[FMW_KQUEUE_ENTRIES_CAPACITY];
+    size_t entries_count;
 };
 
-Fmw *fmw_init(const char *filepath)
+static bool fmw_kqueue_is_watched(Fmw_Backend *backend, const char *path)
 {
-    Fmw *fmw = (Fmw*) malloc(sizeof(Fmw));
+    for (size_t i = 0; i < backend->entries_count; ++i) {
+        if (strcmp(backend->entries[i].path, path) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    fmw->kq = kqueue();
-    if (fmw->kq == -1) {
-        println(stderr, "kqueue() failed: ", strerror(errno));
-        abort();
+static bool fmw_kqueue_watch(Fmw_Backend *backend, const char *path, bool is_dir)
+{
+    if (backend->entries_count >= FMW_KQUEUE_ENTRIES_CAPACITY) {
+        println(stderr, "[WARN] Too many files to watch. Ignoring ", path);
+        return false;
     }
 
-    fmw->fd = open(filepath, O_RDONLY);
-    if (fmw->fd == -1) {
-        println(stderr, "open() failed: ", strerror(errno));
-        abort();
+    const int fd = open(path, FMW_KQUEUE_OPEN_FLAGS);
+    if (fd == -1) {
+        println(stderr, "[WARN] open() failed: ", path, ": ", strerror(errno));
+        return false;
+    }
+
+    struct kevent watch;
+    EV_SET(&watch, fd, EVFILT_VNODE, EV_ADD | EV_ENABLE | EV_CLEAR,
+           NOTE_DELETE | NOTE_EXTEND | NOTE_WRITE | NOTE_ATTRIB | NOTE_RENAME, 0, 0);
+    if (kevent(backend->kq, &watch, 1, NULL, 0, NULL) == -1) {
+        println(stderr, "[WARN] kevent() failed: ", path, ": ", strerror(errno));
+        close(fd);
+        return false;
     }
-    return fmw;
+
+    Fmw_Kqueue_Entry *entry = &backend->entries[backend->entries_count++];
+    entry->fd = fd;
+    entry->is_dir = is_dir;
+    snprintf(entry->path, sizeof(entry->path), "%s", path);
+    return true;
 }
 
-void fmw_free(Fmw *fmw)
+static void fmw_kqueue_unwatch(Fmw_Backend *backend, size_t index)
 {
-    close(fmw->kq);
-    close(fmw->fd);
-    free(fmw);
+    // NOTE: closing the descriptor also removes its kevent
+    close(backend->entries[index].fd);
+    backend->entries[index] = backend->entries[--backend->entries_count];
 }
 
-bool fmw_poll(Fmw *fmw)
+// NOTE: when fmw is not NULL the files that are not watched yet are
+// new, so they are reported as changed
+static void fmw_kqueue_watch_tree(Fmw_Backend *backend, Fmw *fmw, const char *dirpath)
 {
-    struct kevent event;
-    struct kevent watch;
+    if (!fmw_kqueue_is_watched(backend, dirpath) && !fmw_kqueue_watch(backend, dirpath, true)) {
+        return;
+    }
+
+    DIR *dir = opendir(dirpath);
+    if (dir == NULL) {
+        return;
+    }
+    defer(closedir(dir));
+
+    for (dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        char path[FMW_PATH_CAPACITY];
+        const int n = snprintf(path, sizeof(path), "%s/%s", dirpath, entry->d_name);
+        if (n < 0 || (size_t) n >= sizeof(path)) {
+            continue;
+        }
 
-    // set the event parameters
-    EV_SET(&watch, fmw->fd, EVFILT_VNODE, EV_ADD | EV_ENABLE | EV_ONESHOT,
-        NOTE_DELETE | NOTE_EXTEND | NOTE_WRITE, 0, 0);
+        struct stat statbuf = {};
+        if (stat(path, &statbuf) < 0) {
+            continue;
+        }
 
-    // setup a null timespec, to have a 0 timeout (ie. return immediately)
-    struct timespec tm = { };
+        if (S_ISDIR(statbuf.st_mode)) {
+            fmw_kqueue_watch_tree(backend, fmw, path);
+        } else if (!fmw_kqueue_is_watched(backend, path) && fmw_kqueue_watch(backend, path, false) && fmw) {
+            fmw->touch(path);
+        }
+    }
+}
+
+Fmw_Backend *fmw_backend_init(const char *dirpath)
+{
+    Fmw_Backend *backend = new Fmw_Backend {};
+
+    backend->kq = kqueue();
+    if (backend->kq == -1) {
+        println(stderr, "kqueue() failed: ", strerror(errno));
+        abort();
+    }
+
+    char root[FMW_PATH_CAPACITY];
+    snprintf(root, sizeof(root), "%s", dirpath);
+    for (size_t n = strlen(root); n > 1 && root[n - 1] == '/'; --n) {
+        root[n - 1] = '\0';
+    }
+
+    fmw_kqueue_watch_tree(backend, NULL, root);
+    if (backend->entries_count == 0) {
+        println(stderr, "Could not watch ", dirpath);
+        abort();
+    }
+
+    return backend;
+}
+
+void fmw_backend_free(Fmw_Backend *backend)
+{
+    while (backend->entries_count > 0) {
+        fmw_kqueue_unwatch(backend, backend->entries_count - 1);
+    }
+    close(backend->kq);
+    delete backend;
+}
 
-    // poll once.
-    int num_events = kevent(fmw->kq, &watch, 1, &event, 1, &tm);
+void fmw_backend_wait(Fmw_Backend *backend, Fmw *fmw, int timeout_ms)
+{
+    struct timespec timeout = {};
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = (long) (timeout_ms % 1000) * 1000000L;
 
-    if (num_events == -1) {
+    struct kevent events[FMW_KQUEUE_EVENTS_CAPACITY];
+    const int n = kevent(backend->kq, NULL, 0, events, (int) FMW_KQUEUE_EVENTS_CAPACITY, &timeout);
+    if (n == -1) {
+        if (errno == EINTR) {
+            return;
+        }
         println(stderr, "kevent() failed: ", strerror(errno));
         abort();
     }
 
-    // check for writes (and deletes?? not sure how to handle deletes though)
-    if (num_events > 0 && event.fflags & (NOTE_DELETE| NOTE_EXTEND | NOTE_WRITE)) {
-        return true;
-    } else {
-        return false;
+    for (int i = 0; i < n; ++i) {
+        size_t index = 0;
+        while (index < backend->entries_count && backend->entries[index].fd != (int) events[i].ident) {
+            index += 1;
+        }
+        if (index >= backend->entries_count) {
+            continue;
+        }
+
+        // NOTE: copied, the entry may be moved by the unwatching
+        char path[FMW_PATH_CAPACITY];
+        memcpy(path, backend->entries[index].path, sizeof(path));
+        const bool is_dir = backend->entries[index].is_dir;
+        const bool is_gone = events[i].fflags & (NOTE_DELETE | NOTE_RENAME);
+
+        if (is_gone) {
+            fmw_kqueue_unwatch(backend, index);
+        }
+
+        if (is_dir) {
+            if (!is_gone && (events[i].fflags & NOTE_WRITE)) {
+                fmw_kqueue_watch_tree(backend, fmw, path);
+            }
+        } else {
+            // NOTE: the editors that save by renaming a temporary
+            // file over the old one leave a new file at the same path
+            struct stat statbuf = {};
+            if (is_gone && stat(path, &statbuf) == 0) {
+                fmw_kqueue_watch(backend, path, false);
+            }
+            fmw->touch(path);
+        }
     }
 }
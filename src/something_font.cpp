@@ -1,6 +1,7 @@
+#include "./something_parsers.hpp"
 #include "./something_font.hpp"
 
-SDL_Rect Bitmap_Font::char_rect(char x)
+SDL_Rect Bitmap_Font::char_rect(char x) const
 {
     if (32 <= x && x <= 126) {
         const SDL_Rect rect = {
@@ -15,12 +16,8 @@ SDL_Rect Bitmap_Font::char_rect(char x)
     }
 }
 
-void Bitmap_Font::render(SDL_Renderer *renderer, Vec2f position, Vec2f size, RGBA color, String_View sv)
+void Bitmap_Font::render_glyphs(SDL_Renderer *renderer, Vec2f position, Vec2f size, String_View sv) const
 {
-    SDL_Color sdl_color = rgba_to_sdl(color);
-    sec(SDL_SetTextureColorMod(bitmap, sdl_color.r, sdl_color.g, sdl_color.b));
-    sec(SDL_SetTextureAlphaMod(bitmap, sdl_color.a));
-
     for (int row = 0; sv.count > 0; ++row) {
         auto line = sv.chop_by_delim('\n');
 
@@ -37,12 +34,90 @@ void Bitmap_Font::render(SDL_Renderer *renderer, Vec2f position, Vec2f size, RGB
     }
 }
 
-void Bitmap_Font::render(SDL_Renderer *renderer, Vec2f position, Vec2f size, RGBA color, const char *cstr)
+void Bitmap_Font::render_geometry(SDL_Renderer *renderer, Vec2f position, Vec2f size, SDL_Color color, String_View sv) const
+{
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    int bitmap_w = 0, bitmap_h = 0;
+    sec(SDL_QueryTexture(bitmap, NULL, NULL, &bitmap_w, &bitmap_h));
+    sec(SDL_SetTextureColorMod(bitmap, 255, 255, 255));
+    sec(SDL_SetTextureAlphaMod(bitmap, 255));
+
+    auto *vertices = &glyph_run_cache.vertices;
+    auto *indices = &glyph_run_cache.indices;
+    vertices->size = 0;
+    indices->size = 0;
+
+    for (int row = 0; sv.count > 0; ++row) {
+        auto line = sv.chop_by_delim('\n');
+
+        for (int col = 0; (size_t) col < line.count; ++col) {
+            const SDL_Rect src_rect = char_rect(line.data[col]);
+            const float x0 = floorf(position.x + BITMAP_FONT_CHAR_WIDTH  * col * size.x);
+            const float y0 = floorf(position.y + BITMAP_FONT_CHAR_HEIGHT * row * size.y);
+            const float x1 = x0 + floorf(src_rect.w * size.x);
+            const float y1 = y0 + floorf(src_rect.h * size.y);
+            const float u0 = (float) src_rect.x / (float) bitmap_w;
+            const float v0 = (float) src_rect.y / (float) bitmap_h;
+            const float u1 = (float) (src_rect.x + src_rect.w) / (float) bitmap_w;
+            const float v1 = (float) (src_rect.y + src_rect.h) / (float) bitmap_h;
+
+            const int base = (int) vertices->size;
+            vertices->push({{x0, y0}, color, {u0, v0}});
+            vertices->push({{x1, y0}, color, {u1, v0}});
+            vertices->push({{x1, y1}, color, {u1, v1}});
+            vertices->push({{x0, y1}, color, {u0, v1}});
+            const int quad_indices[6] = {base, base + 1, base + 2, base, base + 2, base + 3};
+            for (int k = 0; k < 6; ++k) {
+                indices->push(quad_indices[k]);
+            }
+        }
+    }
+
+    if (vertices->size > 0) {
+        sec(SDL_RenderGeometry(renderer, bitmap,
+                               vertices->data, (int) vertices->size,
+                               indices->data, (int) indices->size));
+    }
+#else
+    // NOTE: SDL_RenderGeometry is not available before SDL 2.0.18
+    sec(SDL_SetTextureColorMod(bitmap, color.r, color.g, color.b));
+    sec(SDL_SetTextureAlphaMod(bitmap, color.a));
+    render_glyphs(renderer, position, size, sv);
+#endif // SDL_VERSION_ATLEAST(2, 0, 18)
+}
+
+void Bitmap_Font::render(SDL_Renderer *renderer, Vec2f position, Vec2f size, RGBA color, String_View sv) const
+{
+    if (sv.count == 0) {
+        return;
+    }
+
+    SDL_Color sdl_color = rgba_to_sdl(color);
+
+    auto run = glyph_run_cache.get(renderer, this, sv);
+    if (run.has_value) {
+        const SDL_Rect dest_rect = {
+            (int) floorf(position.x),
+            (int) floorf(position.y),
+            (int) floorf((float) run.unwrap.size.x * size.x),
+            (int) floorf((float) run.unwrap.size.y * size.y)
+        };
+        sec(SDL_SetTextureColorMod(run.unwrap.texture, sdl_color.r, sdl_color.g, sdl_color.b));
+        sec(SDL_SetTextureAlphaMod(run.unwrap.texture, sdl_color.a));
+        sec(SDL_RenderCopy(renderer, run.unwrap.texture, NULL, &dest_rect));
+        glyph_run_cache.frame_blits += 1;
+    } else {
+        render_geometry(renderer, position, size, sdl_color, sv);
+        glyph_run_cache.frame_geometry += 1;
+    }
+}
+
+void Bitmap_Font::render(SDL_Renderer *renderer, Vec2f position, Vec2f size, RGBA color, const char *cstr) const
 {
     render(renderer, position, size, color, cstr_as_string_view(cstr));
 }
 
-Vec2f Bitmap_Font::text_size(Vec2f size, String_View sv)
+Vec2f Bitmap_Font::text_size(Vec2f size, String_View sv) const
 {
     size_t lines_count = 0;
     size_t longest_line = 0;
@@ -56,7 +131,107 @@ Vec2f Bitmap_Font::text_size(Vec2f size, String_View sv)
                 (float) lines_count * BITMAP_FONT_CHAR_HEIGHT * size.y);
 }
 
-Vec2f Bitmap_Font::text_size(Vec2f size, const char *cstr)
+Vec2f Bitmap_Font::text_size(Vec2f size, const char *cstr) const
 {
     return text_size(size, cstr_as_string_view(cstr));
 }
+
+Glyph_Run_Cache glyph_run_cache = {};
+
+void Glyph_Run_Cache::begin_frame()
+{
+    frame += 1;
+    frame_blits = 0;
+    frame_bakes = 0;
+    frame_geometry = 0;
+}
+
+Maybe<Glyph_Run> Glyph_Run_Cache::get(SDL_Renderer *renderer, const Bitmap_Font *font, String_View sv)
+{
+    if (sv.count > GLYPH_RUN_TEXT_CAPACITY) {
+        return {};
+    }
+
+    const uint64_t hash = fnv1a_64(sv.data, sv.count);
+
+    for (size_t i = 0; i < runs_count; ++i) {
+        if (runs[i].hash == hash &&
+            runs[i].count == sv.count &&
+            runs[i].bitmap == font->bitmap &&
+            memcmp(runs_text[i], sv.data, sv.count) == 0) {
+            runs[i].last_used = frame;
+            return {true, runs[i]};
+        }
+    }
+
+    Glyph_Run_Seen *slot = &seen[hash % GLYPH_RUN_SEEN_CAPACITY];
+    if (slot->hash != hash || slot->frame == frame) {
+        slot->hash = hash;
+        slot->frame = frame;
+        return {};
+    }
+
+    const Vec2f text_size = font->text_size(vec2(1.0f, 1.0f), sv);
+    if (text_size.x > (float) GLYPH_RUN_MAX_SIZE || text_size.y > (float) GLYPH_RUN_MAX_SIZE) {
+        return {};
+    }
+
+    SDL_RendererInfo info = {};
+    sec(SDL_GetRendererInfo(renderer, &info));
+    if (!(info.flags & SDL_RENDERER_TARGETTEXTURE)) {
+        return {};
+    }
+
+    return {true, bake(renderer, font, hash, sv)};
+}
+
+Glyph_Run Glyph_Run_Cache::bake(SDL_Renderer *renderer, const Bitmap_Font *font, uint64_t hash, String_View sv)
+{
+    size_t index = runs_count;
+    if (runs_count < GLYPH_RUN_CACHE_CAPACITY) {
+        runs_count += 1;
+    } else {
+        index = 0;
+        for (size_t i = 1; i < runs_count; ++i) {
+            if (runs[i].last_used < runs[index].last_used) {
+                index = i;
+            }
+        }
+        SDL_DestroyTexture(runs[index].texture);
+    }
+
+    const Vec2f text_size = font->text_size(vec2(1.0f, 1.0f), sv);
+
+    Glyph_Run *run = &runs[index];
+    run->bitmap = font->bitmap;
+    run->hash = hash;
+    run->count = sv.count;
+    memcpy(runs_text[index], sv.data, sv.count);
+    run->size = vec2((int) text_size.x, (int) text_size.y);
+    run->last_used = frame;
+    run->texture = sec(SDL_CreateTexture(renderer,
+                                         SDL_PIXELFORMAT_RGBA32,
+                                         SDL_TEXTUREACCESS_TARGET,
+                                         run->size.x, run->size.y));
+    sec(SDL_SetTextureBlendMode(run->texture, SDL_BLENDMODE_BLEND));
+
+    SDL_Texture *target = SDL_GetRenderTarget(renderer);
+    sec(SDL_SetRenderTarget(renderer, run->texture));
+    sec(SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0));
+    sec(SDL_RenderClear(renderer));
+    sec(SDL_SetTextureColorMod(font->bitmap, 255, 255, 255));
+    sec(SDL_SetTextureAlphaMod(font->bitmap, 255));
+    font->render_glyphs(renderer, vec2(0.0f, 0.0f), vec2(1.0f, 1.0f), sv);
+    sec(SDL_SetRenderTarget(renderer, target));
+
+    frame_bakes += 1;
+    return *run;
+}
+
+void Glyph_Run_Cache::clean()
+{
+    for (size_t i = 0; i < runs_count; ++i) {
+        SDL_DestroyTexture(runs[i].texture);
+    }
+    runs_count = 0;
+}
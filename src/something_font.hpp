@@ -9,12 +9,69 @@ struct Bitmap_Font
 {
     SDL_Texture *bitmap;
 
-    void render(SDL_Renderer *renderer, Vec2f position, Vec2f size, RGBA color, String_View sv);
-    void render(SDL_Renderer *renderer, Vec2f position, Vec2f size, RGBA color, const char *cstr);
-    SDL_Rect char_rect(char x);
+    void render(SDL_Renderer *renderer, Vec2f position, Vec2f size, RGBA color, String_View sv) const;
+    void render(SDL_Renderer *renderer, Vec2f position, Vec2f size, RGBA color, const char *cstr) const;
+    void render_glyphs(SDL_Renderer *renderer, Vec2f position, Vec2f size, String_View sv) const;
+    void render_geometry(SDL_Renderer *renderer, Vec2f position, Vec2f size, SDL_Color color, String_View sv) const;
+    SDL_Rect char_rect(char x) const;
 
-    Vec2f text_size(Vec2f size, String_View sv);
-    Vec2f text_size(Vec2f size, const char *cstr);
+    Vec2f text_size(Vec2f size, String_View sv) const;
+    Vec2f text_size(Vec2f size, const char *cstr) const;
 };
 
+// NOTE: Glyph_Run_Cache keeps the text that is drawn frame after
+// frame baked into white textures at the native font size. The size
+// and the color are applied when the run is blitted, so the same
+// text in different colors (like the shadows) shares one run. Text
+// is baked only after it was seen in a previous frame, so strings
+// that change every frame (FPS, positions) never get a texture and
+// are drawn as one geometry call per string instead. The text of
+// every run is kept next to it and compared on a hash hit, longer
+// text than GLYPH_RUN_TEXT_CAPACITY is never baked.
+const size_t GLYPH_RUN_CACHE_CAPACITY = 128;
+const size_t GLYPH_RUN_SEEN_CAPACITY = 256;
+const size_t GLYPH_RUN_TEXT_CAPACITY = 256;
+const int GLYPH_RUN_MAX_SIZE = 2048;
+
+struct Glyph_Run
+{
+    SDL_Texture *bitmap;
+    uint64_t hash;
+    size_t count;
+    SDL_Texture *texture;
+    Vec2i size;
+    uint64_t last_used;
+};
+
+struct Glyph_Run_Seen
+{
+    uint64_t hash;
+    uint64_t frame;
+};
+
+struct Glyph_Run_Cache
+{
+    Glyph_Run runs[GLYPH_RUN_CACHE_CAPACITY];
+    char runs_text[GLYPH_RUN_CACHE_CAPACITY][GLYPH_RUN_TEXT_CAPACITY];
+    size_t runs_count;
+    Glyph_Run_Seen seen[GLYPH_RUN_SEEN_CAPACITY];
+    uint64_t frame;
+
+    // Geometry scratch buffers
+    Dynamic_Array<SDL_Vertex> vertices;
+    Dynamic_Array<int> indices;
+
+    // Stats of the current frame
+    size_t frame_blits;
+    size_t frame_bakes;
+    size_t frame_geometry;
+
+    void begin_frame();
+    Maybe<Glyph_Run> get(SDL_Renderer *renderer, const Bitmap_Font *font, String_View sv);
+    Glyph_Run bake(SDL_Renderer *renderer, const Bitmap_Font *font, uint64_t hash, String_View sv);
+    void clean();
+};
+
+extern Glyph_Run_Cache glyph_run_cache;
+
 #endif  // SOMETHING_FONT_HPP_
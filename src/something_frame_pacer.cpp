@@ -0,0 +1,76 @@
+#include "./something_frame_pacer.hpp"
+
+void Frame_Pacer::init()
+{
+    frequency = SDL_GetPerformanceFrequency();
+    prev_frame = SDL_GetPerformanceCounter();
+    deadline = prev_frame;
+    work_begin = prev_frame;
+}
+
+float Frame_Pacer::seconds(Uint64 ticks) const
+{
+    return (float) ((double) ticks / (double) frequency);
+}
+
+float Frame_Pacer::begin_frame()
+{
+    const Uint64 now = SDL_GetPerformanceCounter();
+    const float elapsed = seconds(now - prev_frame);
+    prev_frame = now;
+    work_begin = now;
+    return elapsed;
+}
+
+void Frame_Pacer::end_work()
+{
+    const float work = seconds(SDL_GetPerformanceCounter() - work_begin);
+    work_estimate += (work - work_estimate) * FRAME_PACER_WORK_SMOOTHING;
+}
+
+void Frame_Pacer::wait(float period, float spin, float lead)
+{
+    if (period <= 0.0f) {
+        return;
+    }
+
+    const Uint64 period_ticks = (Uint64) ((double) period * (double) frequency);
+    const Uint64 lead_ticks = (Uint64) ((double) max(lead, 0.0f) * (double) frequency);
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    deadline += period_ticks;
+    // NOTE: if we fell behind for more than a period (a hitch, a
+    // breakpoint) don't try to catch up with a burst of frames
+    if (deadline + period_ticks < now) {
+        deadline = now + period_ticks;
+    }
+
+    const Uint64 target = deadline > lead_ticks ? deadline - lead_ticks : deadline;
+    if (target <= now) {
+        return;
+    }
+
+    const float spin_sec = max(spin, 0.0f);
+    float remaining = seconds(target - now);
+    if (remaining > spin_sec) {
+        SDL_Delay((Uint32) ((remaining - spin_sec) * 1000.0f));
+    }
+
+    do {
+        now = SDL_GetPerformanceCounter();
+    } while (now < target);
+
+    const float jitter = seconds(now - target);
+    jitter_count += 1;
+    jitter_sum += jitter;
+    jitter_max = max(jitter_max, jitter);
+}
+
+void Frame_Pacer::publish_stats()
+{
+    jitter_avg_last = jitter_count > 0 ? jitter_sum / (float) jitter_count : 0.0f;
+    jitter_max_last = jitter_max;
+    jitter_count = 0;
+    jitter_sum = 0.0f;
+    jitter_max = 0.0f;
+}
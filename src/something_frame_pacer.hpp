@@ -0,0 +1,41 @@
+#ifndef SOMETHING_FRAME_PACER_HPP_
+#define SOMETHING_FRAME_PACER_HPP_
+
+// NOTE: Frame_Pacer keeps a loop running at a fixed period using the
+// high resolution performance counter. It sleeps with SDL_Delay while
+// the deadline is far enough and spins for the last few milliseconds,
+// because SDL_Delay tends to oversleep. The jitter is how late it
+// actually woke up relative to the deadline.
+const float FRAME_PACER_WORK_SMOOTHING = 0.1f;
+
+struct Frame_Pacer
+{
+    Uint64 frequency;
+    Uint64 prev_frame;
+    Uint64 deadline;
+
+    // NOTE: smoothed duration of the work between begin_frame() and
+    // end_work(), in seconds
+    Uint64 work_begin;
+    float work_estimate;
+
+    // Jitter of the current second, in seconds
+    size_t jitter_count;
+    float jitter_sum;
+    float jitter_max;
+    // Jitter of the last complete second, in seconds
+    float jitter_avg_last;
+    float jitter_max_last;
+
+    void init();
+    float seconds(Uint64 ticks) const;
+    float begin_frame();
+    void end_work();
+    // NOTE: waits until `lead` seconds before the next deadline that is
+    // `period` seconds after the previous one. Does nothing for a
+    // non-positive period.
+    void wait(float period, float spin, float lead);
+    void publish_stats();
+};
+
+#endif  // SOMETHING_FRAME_PACER_HPP_
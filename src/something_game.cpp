@@ -1,4 +1,5 @@
 #include "something_game.hpp"
+#include "something_snapshot.hpp"
 
 template <typename ... Types>
 void displayf(SDL_Renderer *renderer,
@@ -189,64 +190,32 @@ void Game::handle_event(SDL_Event *event)
 
 void Game::update(float dt)
 {
-    entities[PLAYER_ENTITY_INDEX].point_gun_at(mouse_position);
-
-    // Enemy AI //////////////////////////////
-    auto &player = entities[PLAYER_ENTITY_INDEX];
-    Recti *lock = NULL;
-    for (size_t i = 0; i < camera_locks_count; ++i) {
-        Rectf lock_abs = rect_cast<float>(camera_locks[i]) * TILE_SIZE;
-        if (rect_contains_vec2(lock_abs, player.pos)) {
-            lock = &camera_locks[i];
-        }
+    if (keyboard) {
+        entities[PLAYER_ENTITY_INDEX].point_gun_at(mouse_position);
     }
 
-    auto player_tile = grid.abs_to_tile_coord(player.pos);
-    if (lock) {
-        grid.bfs_to_tile(player_tile, lock);
-    }
+    // Enemy AI //////////////////////////////
+    update_enemies_ai();
 
-    if (!debug && lock) {
-        Rectf lock_abs = rect_cast<float>(*lock) * TILE_SIZE;
-        for (size_t i = ENEMY_ENTITY_INDEX_OFFSET; i < ENTITIES_COUNT; ++i) {
-            auto &enemy =  entities[i];
-            if (enemy.state == Entity_State::Alive) {
-                if (rect_contains_vec2(lock_abs, enemy.pos)) {
-                    if (grid.a_sees_b(enemy.pos, player.pos)) {
-                        enemy.stop();
-                        enemy.point_gun_at(player.pos);
-                        entity_shoot({i});
-                    } else {
-                        auto enemy_tile = grid.abs_to_tile_coord(enemy.pos);
-                        auto next = grid.next_in_bfs(enemy_tile, lock);
-                        if (next.has_value) {
-                            auto d = next.unwrap - enemy_tile;
+    // Update All Entities //////////////////////////////
+    Rectf areas[PLAYERS_CAPACITY];
+    const size_t areas_count = players_areas(areas);
 
-                            if (d.y < 0) {
-                                enemy.jump();
-                            }
-                            if (d.x > 0) {
-                                enemy.move(Entity::Right);
-                            }
-                            if (d.x < 0) {
-                                enemy.move(Entity::Left);
-                            }
-                            if (d.x == 0) {
-                                enemy.stop();
-                            }
-                        } else {
-                            enemy.stop();
-                        }
-                    }
-                }
-            }
+    coarse_entities = 0;
+    for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
+        bool near = i < ENEMY_ENTITY_INDEX_OFFSET;
+        for (size_t j = 0; !near && j < areas_count; ++j) {
+            near = rect_contains_vec2(areas[j], entities[i].pos);
         }
-    }
 
-    // Update All Entities //////////////////////////////
-    for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
-        entities[i].update(dt, &mixer, &grid);
-        if (!entities[i].noclip) entity_resolve_collision({i});
+        if (near) {
+            entities[i].update(dt, &mixer, &grid);
+            if (!entities[i].noclip) entity_resolve_collision({i});
+        } else {
+            coarse_entities += entities[i].state != Entity_State::Ded;
+            entities[i].update_coarse(dt);
+            if (!entities[i].noclip) entity_resolve_collision_coarse({i});
+        }
         entities[i].has_jumped = false;
     }
 
@@ -276,11 +245,11 @@ void Game::update(float dt)
                 projectile->kill();
                 entity->lives -= ENTITY_PROJECTILE_DAMAGE;
 
-                mixer.play_sample(OOF_SOUND_INDEX);
+                mixer.play_sample(OOF_SOUND_INDEX, entity->pos);
                 if (entity->lives <= 0) {
                     // TODO(#304): Enemies don't drop any items anymore
                     entity->kill();
-                    mixer.play_sample(CRUNCH_SOUND_INDEX);
+                    mixer.play_sample(CRUNCH_SOUND_INDEX, entity->pos);
                 } else {
                     entity->vel += normalize(projectile->vel) * ENTITY_PROJECTILE_KNOCKBACK;
                     entity->flash(ENTITY_DAMAGE_FLASH_COLOR);
@@ -309,7 +278,7 @@ void Game::update(float dt)
                         case ITEM_HEALTH: {
                             entity->lives = min(entity->lives + ITEM_HEALTH_POINTS, ENTITY_MAX_LIVES);
                             entity->flash(ENTITY_HEAL_FLASH_COLOR);
-                            mixer.play_sample(item->sound);
+                            mixer.play_sample(item->sound, item->pos);
                             item->type = ITEM_NONE;
                         } break;
 
@@ -322,7 +291,7 @@ void Game::update(float dt)
                                     break;
                                 }
                             }
-                            mixer.play_sample(item->sound);
+                            mixer.play_sample(item->sound, item->pos);
                             item->type = ITEM_NONE;
                         } break;
 
@@ -335,7 +304,7 @@ void Game::update(float dt)
                                     break;
                                 }
                             }
-                            mixer.play_sample(item->sound);
+                            mixer.play_sample(item->sound, item->pos);
                             item->type = ITEM_NONE;
                         } break;
                         }
@@ -354,7 +323,7 @@ void Game::update(float dt)
     }
 
     // Player Movement //////////////////////////////
-    if (!console.enabled) {
+    if (keyboard && !console.enabled) {
         if (keyboard[SDL_SCANCODE_D]) {
             entities[PLAYER_ENTITY_INDEX].move(Entity::Right);
         } else if (keyboard[SDL_SCANCODE_A]) {
@@ -380,6 +349,7 @@ void Game::update(float dt)
     }
 
     camera.update(dt);
+    mixer.listener = camera.pos;
 
     // Popup //////////////////////////////
     popup.update(dt);
@@ -388,7 +358,7 @@ void Game::update(float dt)
     console.update(dt);
 }
 
-void Game::render(SDL_Renderer *renderer)
+Recti *Game::current_lock()
 {
     Recti *lock = NULL;
     for (size_t i = 0; i < camera_locks_count; ++i) {
@@ -397,46 +367,159 @@ void Game::render(SDL_Renderer *renderer)
             lock = &camera_locks[i];
         }
     }
+    return lock;
+}
 
-    background.render(renderer, camera);
+void Game::snapshot(Render_Snapshot *output)
+{
+    output->quit = quit;
+    output->debug = debug;
+    output->bfs_debug = bfs_debug;
+    output->fps_debug = fps_debug;
 
-    if (bfs_debug && lock) {
-        grid.render_debug_bfs_overlay(
-            renderer,
-            &camera,
-            lock);
+    output->camera = camera;
+
+    Recti *lock = current_lock();
+    output->lock = {};
+    if (lock) {
+        output->lock = {true, *lock};
+        if (bfs_debug) {
+            memcpy(output->bfs_trace, grid.bfs_trace, sizeof(grid.bfs_trace));
+        }
     }
 
-    grid.render(renderer, camera, lock);
+    output->background = background;
+    grid.copy_window(&output->tile_window, camera);
+
+    const Rectf view = camera.view(CAMERA_CULLING_PADDING);
 
+    output->particles_count = 0;
+    output->visible_entities_count = 0;
     for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
-        // TODO(#106): display health bar differently for enemies in a different room
-        entities[i].render(renderer, camera);
+        const size_t particles_count = entities[i].particles.snapshot(
+            output->particles + output->particles_count,
+            SNAPSHOT_PARTICLES_CAPACITY - output->particles_count,
+            view);
+
+        const bool visible =
+            entities[i].state != Entity_State::Ded &&
+            rects_overlap(view, entities[i].texbox_world());
+        if (!visible && particles_count == 0) {
+            continue;
+        }
+
+        Entity_Snapshot *entity = &output->entities[i];
+        *entity = entities[i].snapshot();
+        entity->particles_begin = output->particles_count;
+        entity->particles_count = particles_count;
+        output->particles_count += particles_count;
+        output->visible_entities[output->visible_entities_count++] = i;
+    }
+
+    output->visible_projectiles_count = 0;
+    for (size_t i = 0; i < PROJECTILES_COUNT; ++i) {
+        output->projectiles[i] = projectiles[i];
+        if (projectiles[i].state != Projectile_State::Ded &&
+            rect_contains_vec2(view, projectiles[i].pos)) {
+            output->visible_projectiles[output->visible_projectiles_count++] = i;
+        }
+    }
+
+    output->visible_items_count = 0;
+    for (size_t i = 0; i < ITEMS_COUNT; ++i) {
+        if (items[i].type != ITEM_NONE && rects_overlap(view, items[i].texbox_world())) {
+            output->items[i] = items[i];
+            output->visible_items[output->visible_items_count++] = i;
+        }
     }
 
     {
+        output->weapon_preview = {};
         auto weapon = entities[PLAYER_ENTITY_INDEX].get_current_weapon();
         if (weapon != NULL) {
-            weapon->render(renderer, this, {PLAYER_ENTITY_INDEX});
+            output->weapon_preview = weapon->preview(this, {PLAYER_ENTITY_INDEX});
         }
     }
 
-    render_projectiles(renderer, camera);
+    {
+        const Entity *player = &entities[PLAYER_ENTITY_INDEX];
+        output->weapon_slots_count = player->weapon_slots_count;
+        output->weapon_current = player->weapon_current;
+        for (size_t i = 0; i < player->weapon_slots_count; ++i) {
+            output->weapon_slots[i] = player->weapon_slots[i];
+        }
+    }
 
-    for (size_t i = 0; i < ITEMS_COUNT; ++i) {
-        if (items[i].type != ITEM_NONE) {
-            items[i].render(renderer, camera);
+    output->popup = popup;
+    console.snapshot(&output->console);
+
+    if (debug) {
+        debug_toolbar.snapshot(&output->debug_toolbar);
+        output->mouse_position = mouse_position;
+        output->collision_probe = collision_probe;
+        output->player_pos = entities[PLAYER_ENTITY_INDEX].pos;
+        output->player_vel = entities[PLAYER_ENTITY_INDEX].vel;
+        output->alive_projectiles = count_alive_projectiles();
+        output->ai_thinks = ai_thinks;
+        output->coarse_entities = coarse_entities;
+        output->tracking_projectile = tracking_projectile;
+        output->hovered_projectile = projectile_at_position(mouse_position);
+    }
+}
+
+void Game::render(SDL_Renderer *renderer, const Render_Snapshot *snapshot)
+{
+    Camera camera = snapshot->camera;
+    const Recti *lock = snapshot->lock.has_value ? &snapshot->lock.unwrap : NULL;
+
+    sprite_batch.begin_frame(renderer);
+
+    snapshot->background.render(&sprite_batch, camera);
+
+    if (snapshot->bfs_debug && lock) {
+        // NOTE: the overlay goes between the background and the tiles
+        sprite_batch.flush();
+        render_debug_bfs_overlay(
+            renderer,
+            &camera,
+            lock,
+            snapshot->bfs_trace);
+    }
+
+    snapshot->tile_window.render(&sprite_batch, camera, lock);
+
+    for (size_t i = 0; i < snapshot->visible_entities_count; ++i) {
+        const Entity_Snapshot *entity = &snapshot->entities[snapshot->visible_entities[i]];
+
+        // TODO(#185): should we use shade for the particles of an entity?
+        for (size_t j = 0; j < entity->particles_count; ++j) {
+            snapshot->particles[entity->particles_begin + j].render(&sprite_batch, camera);
         }
+
+        // TODO(#106): display health bar differently for enemies in a different room
+        entity->render(&sprite_batch, camera);
+    }
+
+    snapshot->weapon_preview.render(&sprite_batch, camera);
+
+    for (size_t i = 0; i < snapshot->visible_projectiles_count; ++i) {
+        snapshot->projectiles[snapshot->visible_projectiles[i]].render(&sprite_batch, &camera);
     }
 
-    if (fps_debug) {
+    for (size_t i = 0; i < snapshot->visible_items_count; ++i) {
+        snapshot->items[snapshot->visible_items[i]].render(&sprite_batch, camera);
+    }
+
+    sprite_batch.flush();
+
+    if (snapshot->fps_debug) {
         render_fps_overlay(renderer);
     }
 
-    render_player_hud(renderer);
+    render_player_hud(&sprite_batch, snapshot);
 
-    popup.render(renderer);
-    console.render(renderer, &debug_font);
+    snapshot->popup.render(renderer);
+    snapshot->console.render(renderer, &debug_font);
 }
 
 void Game::entity_shoot(Entity_Index entity_index)
@@ -453,7 +536,7 @@ void Game::entity_shoot(Entity_Index entity_index)
                 if (entity->cooldown_weapon <= 0) {
                     weapon->shoot(this, entity_index);
                     if (weapon->shoot_sample.has_value) {
-                        mixer.play_sample(weapon->shoot_sample.unwrap);
+                        mixer.play_sample(weapon->shoot_sample.unwrap, entity->pos);
                     }
 
                     // TODO(#305): can we move cooldown_weapon to the Weapon struct
@@ -549,6 +632,160 @@ void Game::entity_resolve_collision(Entity_Index entity_index)
     }
 }
 
+void Game::entity_resolve_collision_coarse(Entity_Index entity_index)
+{
+    assert(entity_index.unwrap < ENTITIES_COUNT);
+    Entity *entity = &entities[entity_index.unwrap];
+
+    if (entity->state == Entity_State::Alive) {
+        // NOTE: only the corners of the hitbox are resolved and
+        // there are no landing particles
+        const Rectf hitbox = entity->hitbox_local;
+        const Vec2f corners[] = {
+            vec2(hitbox.x,             hitbox.y),
+            vec2(hitbox.x + hitbox.w,  hitbox.y),
+            vec2(hitbox.x,             hitbox.y + hitbox.h),
+            vec2(hitbox.x + hitbox.w,  hitbox.y + hitbox.h),
+        };
+
+        for (auto corner: corners) {
+            Vec2f t0 = entity->pos + corner;
+            Vec2f t1 = t0;
+
+            grid.resolve_point_collision(&t1);
+
+            Vec2f d = t1 - t0;
+
+            const int IMPACT_THRESHOLD = 5;
+            if (abs(d.y) >= IMPACT_THRESHOLD && !entity->has_jumped) entity->vel.y = 0;
+            if (abs(d.x) >= IMPACT_THRESHOLD) entity->vel.x = 0;
+
+            entity->pos += d;
+        }
+    }
+}
+
+void Game::enemy_think(Entity_Index enemy_index, Recti *lock)
+{
+    assert(enemy_index.unwrap < ENTITIES_COUNT);
+    auto &enemy = entities[enemy_index.unwrap];
+    auto &player = entities[PLAYER_ENTITY_INDEX];
+
+    const auto enemy_tile = grid.abs_to_tile_coord(enemy.pos);
+    const bool same_room = rect_contains_vec2(*lock, enemy_tile);
+
+    enemy.sees_target = same_room && grid.a_sees_b(enemy.pos, player.pos);
+    if (enemy.sees_target) {
+        enemy.stop();
+    } else {
+        Maybe<Vec2i> next = {};
+        if (same_room) {
+            next = grid.next_in_bfs(enemy_tile, lock);
+        } else {
+            next = nav.next_step(&grid, enemy_tile,
+                                 grid.abs_to_tile_coord(player.pos),
+                                 AI_CHASE_DISTANCE);
+        }
+
+        if (next.has_value) {
+            auto d = next.unwrap - enemy_tile;
+
+            if (d.y < 0) {
+                enemy.jump();
+            }
+            if (d.x > 0) {
+                enemy.move(Entity::Right);
+            }
+            if (d.x < 0) {
+                enemy.move(Entity::Left);
+            }
+            if (d.x == 0) {
+                enemy.stop();
+            }
+        } else {
+            enemy.stop();
+        }
+    }
+}
+
+// NOTE: Thinking is the expensive part of the AI (a_sees_b, BFS), so
+// every enemy thinks only once in AI_THINK_INTERVAL ticks and at most
+// AI_THINK_BUDGET enemies think per tick. The enemies are visited
+// round-robin starting after the last one that thought, so nobody
+// starves when the budget runs out. In between the thinks the enemies
+// keep doing what they decided to do last time.
+void Game::update_enemies_ai()
+{
+    ai_tick += 1;
+    ai_thinks = 0;
+
+    auto &player = entities[PLAYER_ENTITY_INDEX];
+    Recti *lock = current_lock();
+    if (lock == NULL) return;
+
+    const auto player_tile = grid.abs_to_tile_coord(player.pos);
+    bool bfs_ready = false;
+    if (bfs_debug) {
+        grid.bfs_to_tile(player_tile, lock);
+        bfs_ready = true;
+    }
+
+    if (debug) return;
+
+    nav.sync(camera_locks, camera_locks_count, camera_locks_generation, &grid);
+
+    const size_t ENEMIES_COUNT = ENTITIES_COUNT - ENEMY_ENTITY_INDEX_OFFSET;
+    const uint32_t think_interval = (uint32_t) max(AI_THINK_INTERVAL, 1);
+    const size_t think_budget = (size_t) max(AI_THINK_BUDGET, 1);
+    for (size_t j = 0; j < ENEMIES_COUNT; ++j) {
+        const size_t i = ENEMY_ENTITY_INDEX_OFFSET + (ai_cursor + j) % ENEMIES_COUNT;
+        auto &enemy = entities[i];
+        if (enemy.state != Entity_State::Alive) continue;
+
+        if (enemy.next_think_tick <= ai_tick && ai_thinks < think_budget) {
+            if (!bfs_ready) {
+                grid.bfs_to_tile(player_tile, lock);
+                bfs_ready = true;
+            }
+
+            enemy_think({i}, lock);
+            enemy.next_think_tick = ai_tick + think_interval;
+            ai_thinks += 1;
+            ai_cursor = (i - ENEMY_ENTITY_INDEX_OFFSET + 1) % ENEMIES_COUNT;
+        }
+
+        if (enemy.sees_target) {
+            enemy.point_gun_at(player.pos);
+            entity_shoot({i});
+        }
+    }
+}
+
+// NOTE: the areas around the players where the entities are simulated
+// in full detail: the room the player is in or a screen around the
+// player if they are outside of the rooms.
+size_t Game::players_areas(Rectf areas[PLAYERS_CAPACITY])
+{
+    size_t count = 0;
+    for (size_t i = 0; i < PLAYERS_CAPACITY; ++i) {
+        const Entity *player = &entities[PLAYER_ENTITY_INDEX + i];
+        if (player->state == Entity_State::Ded) continue;
+
+        Rectf area = rect(player->pos - vec2(SCREEN_WIDTH, SCREEN_HEIGHT) * 0.5f,
+                          SCREEN_WIDTH, SCREEN_HEIGHT);
+        for (size_t j = 0; j < camera_locks_count; ++j) {
+            Rectf lock_abs = rect_cast<float>(camera_locks[j]) * TILE_SIZE;
+            if (rect_contains_vec2(lock_abs, player->pos)) {
+                area = lock_abs;
+                break;
+            }
+        }
+
+        areas[count++] = area;
+    }
+    return count;
+}
+
 void Game::spawn_projectile(Projectile projectile)
 {
     for (size_t i = 0; i < PROJECTILES_COUNT; ++i) {
@@ -559,13 +796,15 @@ void Game::spawn_projectile(Projectile projectile)
     }
 }
 
-void Game::render_debug_overlay(SDL_Renderer *renderer, size_t fps)
+void Game::render_debug_overlay(SDL_Renderer *renderer, const Render_Snapshot *snapshot, size_t fps)
 {
+    const Camera camera = snapshot->camera;
+
     sec(SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255));
 
     const float COLLISION_PROBE_SIZE = 10.0f;
     const auto collision_probe_rect = rect(
-        camera.to_screen(collision_probe - COLLISION_PROBE_SIZE),
+        camera.to_screen(snapshot->collision_probe - COLLISION_PROBE_SIZE),
         COLLISION_PROBE_SIZE * 2, COLLISION_PROBE_SIZE * 2);
     {
         auto rect = rectf_for_sdl(collision_probe_rect);
@@ -577,44 +816,82 @@ void Game::render_debug_overlay(SDL_Renderer *renderer, size_t fps)
              FONT_DEBUG_COLOR,
              FONT_SHADOW_COLOR,
              vec2(PADDING, PADDING),
-             "FPS: ", fps);
+             "FPS: ", fps,
+             " Jitter: avg ", frame_pacer.jitter_avg_last * 1000.0f,
+             " ms, max ", frame_pacer.jitter_max_last * 1000.0f, " ms");
     displayf(renderer, &debug_font,
              FONT_DEBUG_COLOR,
              FONT_SHADOW_COLOR,
              vec2(PADDING, 50 + PADDING),
              "Mouse Position: ",
-             mouse_position.x, " ",
-             mouse_position.y);
+             snapshot->mouse_position.x, " ",
+             snapshot->mouse_position.y);
     displayf(renderer, &debug_font,
              FONT_DEBUG_COLOR,
              FONT_SHADOW_COLOR,
              vec2(PADDING, 2 * 50 + PADDING),
              "Collision Probe: ",
-             collision_probe.x, " ",
-             collision_probe.y);
+             snapshot->collision_probe.x, " ",
+             snapshot->collision_probe.y);
     displayf(renderer, &debug_font,
              FONT_DEBUG_COLOR,
              FONT_SHADOW_COLOR,
              vec2(PADDING, 3 * 50 + PADDING),
              "Projectiles: ",
-             count_alive_projectiles());
+             snapshot->alive_projectiles);
     displayf(renderer, &debug_font,
              FONT_DEBUG_COLOR,
              FONT_SHADOW_COLOR,
              vec2(PADDING, 4 * 50 + PADDING),
              "Player position: ",
-             entities[PLAYER_ENTITY_INDEX].pos.x, " ",
-             entities[PLAYER_ENTITY_INDEX].pos.y);
+             snapshot->player_pos.x, " ",
+             snapshot->player_pos.y);
     displayf(renderer, &debug_font,
              FONT_DEBUG_COLOR,
              FONT_SHADOW_COLOR,
              vec2(PADDING, 5 * 50 + PADDING),
              "Player velocity: ",
-             entities[PLAYER_ENTITY_INDEX].vel.x, " ",
-             entities[PLAYER_ENTITY_INDEX].vel.y);
-
-    if (tracking_projectile.has_value) {
-        auto projectile = projectiles[tracking_projectile.unwrap.unwrap];
+             snapshot->player_vel.x, " ",
+             snapshot->player_vel.y);
+    displayf(renderer, &debug_font,
+             FONT_DEBUG_COLOR,
+             FONT_SHADOW_COLOR,
+             vec2(PADDING, 6 * 50 + PADDING),
+             "AI thinks: ", snapshot->ai_thinks,
+             " Coarse entities: ", snapshot->coarse_entities);
+    displayf(renderer, &debug_font,
+             FONT_DEBUG_COLOR,
+             FONT_SHADOW_COLOR,
+             vec2(PADDING, 7 * 50 + PADDING),
+             "Sprite batch: ", sprite_batch.frame_quads, " quads, ",
+             sprite_batch.frame_state_changes, " state changes, ",
+             sprite_batch.frame_draw_calls, " draw calls");
+    displayf(renderer, &debug_font,
+             FONT_DEBUG_COLOR,
+             FONT_SHADOW_COLOR,
+             vec2(PADDING, 8 * 50 + PADDING),
+             "Glyph runs: ", glyph_run_cache.runs_count, " cached, ",
+             glyph_run_cache.frame_blits, " blits, ",
+             glyph_run_cache.frame_geometry, " geometry");
+    displayf(renderer, &debug_font,
+             FONT_DEBUG_COLOR,
+             FONT_SHADOW_COLOR,
+             vec2(PADDING, 9 * 50 + PADDING),
+             "Visible: ", snapshot->visible_entities_count, " entities, ",
+             snapshot->particles_count, " particles, ",
+             snapshot->visible_projectiles_count, " projectiles, ",
+             snapshot->visible_items_count, " items");
+    displayf(renderer, &debug_font,
+             FONT_DEBUG_COLOR,
+             FONT_SHADOW_COLOR,
+             vec2(PADDING, 10 * 50 + PADDING),
+             "Atlases: ", assets.resident_bytes / 1024, " KiB resident, ",
+             assets.evicted_bytes / 1024, " KiB evicted (",
+             assets.uploads_count, " uploads, ",
+             assets.evictions_count, " evictions)");
+
+    if (snapshot->tracking_projectile.has_value) {
+        auto projectile = snapshot->projectiles[snapshot->tracking_projectile.unwrap.unwrap];
         const float SECOND_COLUMN_OFFSET = 700.0f;
         const RGBA TRACKING_DEBUG_COLOR = sdl_to_rgba({255, 255, 150, 255});
         displayf(renderer, &debug_font,
@@ -642,44 +919,47 @@ void Game::render_debug_overlay(SDL_Renderer *renderer, size_t fps)
                  projectile.shooter.unwrap);
     }
 
-    for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
-        if (entities[i].state == Entity_State::Ded) continue;
+    for (size_t i = 0; i < snapshot->visible_entities_count; ++i) {
+        const Entity_Snapshot *entity = &snapshot->entities[snapshot->visible_entities[i]];
+        if (entity->state == Entity_State::Ded) continue;
 
         sec(SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255));
-        auto dstrect = rectf_for_sdl(camera.to_screen(entities[i].texbox_world()));
+        auto dstrect = rectf_for_sdl(camera.to_screen(entity->texbox_world));
         sec(SDL_RenderDrawRect(renderer, &dstrect));
 
         sec(SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255));
-        auto hitbox = rectf_for_sdl(camera.to_screen(entities[i].hitbox_world()));
+        auto hitbox = rectf_for_sdl(camera.to_screen(entity->hitbox_world));
         sec(SDL_RenderDrawRect(renderer, &hitbox));
 
-        entities[i].render_debug(renderer, camera);
+        entity->render_debug(renderer, camera);
     }
 
-    for (size_t i = 0; i < PROJECTILES_COUNT; ++i) {
-        if (projectiles[i].state == Projectile_State::Active) {
-            draw_rect(renderer, camera.to_screen(projectiles[i].hitbox()), RGBA_RED);
+    for (size_t i = 0; i < snapshot->visible_projectiles_count; ++i) {
+        const Projectile *projectile = &snapshot->projectiles[snapshot->visible_projectiles[i]];
+        if (projectile->state == Projectile_State::Active) {
+            draw_rect(renderer, camera.to_screen(projectile->hitbox()), RGBA_RED);
         }
     }
 
-    if (tracking_projectile.has_value) {
+    if (snapshot->tracking_projectile.has_value) {
         sec(SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255));
         auto hitbox = rectf_for_sdl(
-            camera.to_screen(hitbox_of_projectile(tracking_projectile.unwrap)));
+            camera.to_screen(
+                snapshot->projectiles[snapshot->tracking_projectile.unwrap.unwrap].tracking_hitbox()));
         sec(SDL_RenderDrawRect(renderer, &hitbox));
     }
 
-    auto projectile_index = projectile_at_position(mouse_position);
-    if (projectile_index.has_value) {
+    if (snapshot->hovered_projectile.has_value) {
         sec(SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255));
         auto hitbox = rectf_for_sdl(
-            camera.to_screen(hitbox_of_projectile(projectile_index.unwrap)));
+            camera.to_screen(
+                snapshot->projectiles[snapshot->hovered_projectile.unwrap.unwrap].tracking_hitbox()));
         sec(SDL_RenderDrawRect(renderer, &hitbox));
     } else {
         sec(SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255));
         const Rectf tile_rect = {
-            floorf(mouse_position.x / TILE_SIZE) * TILE_SIZE,
-            floorf(mouse_position.y / TILE_SIZE) * TILE_SIZE,
+            floorf(snapshot->mouse_position.x / TILE_SIZE) * TILE_SIZE,
+            floorf(snapshot->mouse_position.y / TILE_SIZE) * TILE_SIZE,
             TILE_SIZE,
             TILE_SIZE
         };
@@ -688,11 +968,11 @@ void Game::render_debug_overlay(SDL_Renderer *renderer, size_t fps)
         sec(SDL_RenderDrawRect(renderer, &rect));
     }
 
-    for (size_t i = 0; i < ITEMS_COUNT; ++i) {
-        items[i].render_debug(renderer, camera);
+    for (size_t i = 0; i < snapshot->visible_items_count; ++i) {
+        snapshot->items[snapshot->visible_items[i]].render_debug(renderer, camera);
     }
 
-    debug_toolbar.render(renderer, debug_font);
+    snapshot->debug_toolbar.render(&sprite_batch, debug_font);
 }
 
 void Game::render_fps_overlay(SDL_Renderer *renderer) {
@@ -723,13 +1003,6 @@ int Game::count_alive_projectiles(void)
     return res;
 }
 
-void Game::render_projectiles(SDL_Renderer *renderer, Camera camera)
-{
-    for (size_t i = 0; i < PROJECTILES_COUNT; ++i) {
-        projectiles[i].render(renderer, &camera);
-    }
-}
-
 void Game::update_projectiles(float dt)
 {
     for (size_t i = 0; i < PROJECTILES_COUNT; ++i) {
@@ -737,18 +1010,10 @@ void Game::update_projectiles(float dt)
     }
 }
 
-const float PROJECTILE_TRACKING_PADDING = 50.0f;
-
 Rectf Game::hitbox_of_projectile(Projectile_Index index)
 {
     assert(index.unwrap < PROJECTILES_COUNT);
-
-    return Rectf {
-        projectiles[index.unwrap].pos.x - PROJECTILE_TRACKING_PADDING * 0.5f,
-            projectiles[index.unwrap].pos.y - PROJECTILE_TRACKING_PADDING * 0.5f,
-            PROJECTILE_TRACKING_PADDING,
-            PROJECTILE_TRACKING_PADDING
-    };
+    return projectiles[index.unwrap].tracking_hitbox();
 }
 
 Maybe<Projectile_Index> Game::projectile_at_position(Vec2f position)
@@ -805,6 +1070,7 @@ void Game::add_camera_lock(Recti rect)
 {
     assert(camera_locks_count < CAMERA_LOCKS_CAPACITY);
     camera_locks[camera_locks_count++] = rect;
+    camera_locks_generation += 1;
 }
 
 void Game::spawn_entity_at(Entity entity, Vec2f pos)
@@ -858,9 +1124,8 @@ int Game::get_rooms_count(void)
     return result;
 }
 
-void Game::render_player_hud(SDL_Renderer *renderer)
+void Game::render_player_hud(Sprite_Batch *batch, const Render_Snapshot *snapshot)
 {
-    Entity *player = &entities[PLAYER_ENTITY_INDEX];
 
     const size_t MAXIMUM_LENGTH = 3;
     char label[MAXIMUM_LENGTH + 1];
@@ -872,26 +1137,30 @@ void Game::render_player_hud(SDL_Renderer *renderer)
         PLAYER_HUD_ICON_WIDTH + PADDING_BETWEEN_TEXT_AND_ICON + text_width + PLAYER_HUD_PADDING * 2,
         max(PLAYER_HUD_ICON_HEIGHT, text_height) + PLAYER_HUD_PADDING * 2);
 
-    for (size_t i = 0; i < player->weapon_slots_count; ++i) {
+    for (size_t i = 0; i < snapshot->weapon_slots_count; ++i) {
         const auto position = vec2(PLAYER_HUD_MARGIN, PLAYER_HUD_MARGIN + (border_size.y + PLAYER_HUD_MARGIN) * i);
-        fill_rect(renderer, rect(position, border_size), i == player->weapon_current ? PLAYER_HUD_SELECTED_COLOR : PLAYER_HUD_BACKGROUND_COLOR);
+        batch->fill_rect(SPRITE_LAYER_UI_BACKGROUND, rect(position, border_size), i == snapshot->weapon_current ? PLAYER_HUD_SELECTED_COLOR : PLAYER_HUD_BACKGROUND_COLOR);
         Rectf destrect = rect(position + vec2(PLAYER_HUD_PADDING, PLAYER_HUD_PADDING),
                               vec2(PLAYER_HUD_ICON_WIDTH, PLAYER_HUD_ICON_HEIGHT));
 
-        player->weapon_slots[i].icon().render(renderer, destrect);
+        snapshot->weapon_slots[i].icon().render(batch, SPRITE_LAYER_UI_ICONS, destrect);
+    }
+    batch->flush();
 
-        switch (player->weapon_slots[i].type) {
+    for (size_t i = 0; i < snapshot->weapon_slots_count; ++i) {
+        const auto position = vec2(PLAYER_HUD_MARGIN, PLAYER_HUD_MARGIN + (border_size.y + PLAYER_HUD_MARGIN) * i);
+        switch (snapshot->weapon_slots[i].type) {
         case Weapon_Type::Gun:
             snprintf(label, sizeof(label), "inf");
             break;
 
         case Weapon_Type::Placer:
-            snprintf(label, sizeof(label), "%d", (unsigned) player->weapon_slots[i].placer.amount);
+            snprintf(label, sizeof(label), "%d", (unsigned) snapshot->weapon_slots[i].placer.amount);
             break;
         }
 
         debug_font.render(
-            renderer,
+            batch->renderer,
             position + vec2(PLAYER_HUD_PADDING + PLAYER_HUD_ICON_WIDTH + PADDING_BETWEEN_TEXT_AND_ICON, PLAYER_HUD_PADDING),
             vec2(PLAYER_HUD_FONT_SIZE, PLAYER_HUD_FONT_SIZE),
             PLAYER_HUD_FONT_COLOR,
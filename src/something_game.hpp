@@ -6,6 +6,7 @@
 #include "something_texture.hpp"
 #include "something_background.hpp"
 #include "something_projectile.hpp"
+#include "something_nav.hpp"
 
 enum Debug_Toolbar_Button
 {
@@ -21,16 +22,23 @@ enum Debug_Toolbar_Button
     DEBUG_TOOLBAR_COUNT
 };
 
-const size_t ENEMY_ENTITY_INDEX_OFFSET = 1;
 const size_t PLAYER_ENTITY_INDEX = 0;
+// NOTE: the first PLAYERS_CAPACITY entities are reserved for the
+// players. Only the first one is used outside of the server mode
+// (see something_server.cpp).
+const size_t PLAYERS_CAPACITY = 4;
+const size_t ENEMY_ENTITY_INDEX_OFFSET = PLAYERS_CAPACITY;
 
 const size_t ENTITIES_COUNT = 69;
 const size_t PROJECTILES_COUNT = 69;
 const size_t ITEMS_COUNT = 69;
 const size_t CAMERA_LOCKS_CAPACITY = 200;
+static_assert(CAMERA_LOCKS_CAPACITY <= NAV_ROOMS_CAPACITY);
 const size_t ROOM_ROW_COUNT = 8;
 const size_t FPS_BARS_COUNT = 256;
 
+struct Render_Snapshot;
+
 struct Game
 {
     bool quit;
@@ -39,14 +47,19 @@ struct Game
     bool bfs_debug;
     bool fps_debug;
     bool holding_down_mouse;
+    // NOTE: frame_delays and frame_pacer are owned by the render thread
     float frame_delays[FPS_BARS_COUNT];
     size_t frame_delays_begin;
+    Frame_Pacer frame_pacer;
+    // NOTE: sprite_batch is owned by the render thread
+    Sprite_Batch sprite_batch;
 
     Vec2f collision_probe;
     Vec2f mouse_position;
     Maybe<Projectile_Index> tracking_projectile;
     Camera camera;
     Sample_Mixer mixer;
+    // NOTE: NULL when the players are driven remotely (see something_server.cpp)
     const Uint8 *keyboard;
     Popup popup;
     // TODO(#178): disable game console in release mode
@@ -66,16 +79,29 @@ struct Game
 
     Recti camera_locks[CAMERA_LOCKS_CAPACITY];
     size_t camera_locks_count;
+    // NOTE: bumped whenever the camera locks change, the rooms of the
+    // navigation graph are rebuilt when it does not match theirs
+    uint32_t camera_locks_generation;
 
     Background background;
 
+    Nav_Graph nav;
+
+    // NOTE: AI scheduling, see Game::update_enemies_ai()
+    uint32_t ai_tick;
+    size_t ai_cursor;
+    size_t ai_thinks;
+    size_t coarse_entities;
+
     void add_camera_lock(Recti rect);
+    Recti *current_lock();
 
     // Whole Game State
     void update(float dt);
-    void render(SDL_Renderer *renderer);
+    void snapshot(Render_Snapshot *output);
+    void render(SDL_Renderer *renderer, const Render_Snapshot *snapshot);
     void handle_event(SDL_Event *event);
-    void render_debug_overlay(SDL_Renderer *renderer, size_t fps);
+    void render_debug_overlay(SDL_Renderer *renderer, const Render_Snapshot *snapshot, size_t fps);
     void render_fps_overlay(SDL_Renderer *renderer);
     void noclip(bool on);
 
@@ -84,6 +110,10 @@ struct Game
     void entity_shoot(Entity_Index entity_index);
     void entity_jump(Entity_Index entity_index);
     void entity_resolve_collision(Entity_Index entity_index);
+    void entity_resolve_collision_coarse(Entity_Index entity_index);
+    void enemy_think(Entity_Index enemy_index, Recti *lock);
+    void update_enemies_ai();
+    size_t players_areas(Rectf areas[PLAYERS_CAPACITY]);
     void spawn_entity_at(Entity entity, Vec2f pos);
     void spawn_enemy_at(Vec2f pos);
     void spawn_golem_at(Vec2f pos);
@@ -93,7 +123,6 @@ struct Game
     // Projectiles of the Game
     void spawn_projectile(Projectile projectile);
     int count_alive_projectiles(void);
-    void render_projectiles(SDL_Renderer *renderer, Camera camera);
     void update_projectiles(float dt);
     Rectf hitbox_of_projectile(Projectile_Index index);
     Maybe<Projectile_Index> projectile_at_position(Vec2f position);
@@ -107,7 +136,7 @@ struct Game
     int get_rooms_count(void);
 
     // Player related operations
-    void render_player_hud(SDL_Renderer *renderer);
+    void render_player_hud(Sprite_Batch *batch, const Render_Snapshot *snapshot);
 };
 
 #endif  // SOMETHING_GAME_HPP_
@@ -0,0 +1,286 @@
+#include "./something_headless.hpp"
+
+static int parse_amount(Args *args, const char *what)
+{
+    const char *arg = args->shift();
+    auto amount = cstr_as_string_view(arg).as_integer<int>();
+    if (!amount.has_value || amount.unwrap <= 0) {
+        println(stderr, "ERROR: `", arg, "` is not a valid amount of ", what);
+        exit(1);
+    }
+
+    return amount.unwrap;
+}
+
+struct Headless_Stats
+{
+    size_t frames;
+    size_t quads_total;
+    size_t quads_max;
+    size_t state_changes_total;
+    size_t state_changes_max;
+    size_t draw_calls_total;
+    size_t draw_calls_max;
+    float render_time_total;
+    float render_time_max;
+
+    void push(const Sprite_Batch *batch, float render_time)
+    {
+        frames += 1;
+        quads_total += batch->frame_quads;
+        quads_max = max(quads_max, batch->frame_quads);
+        state_changes_total += batch->frame_state_changes;
+        state_changes_max = max(state_changes_max, batch->frame_state_changes);
+        draw_calls_total += batch->frame_draw_calls;
+        draw_calls_max = max(draw_calls_max, batch->frame_draw_calls);
+        render_time_total += render_time;
+        render_time_max = max(render_time_max, render_time);
+    }
+
+    void report() const
+    {
+        if (frames == 0) return;
+        println(stdout, "[HEADLESS] Frames: ", frames);
+        println(stdout, "[HEADLESS] Quads: avg ", quads_total / frames, ", max ", quads_max);
+        println(stdout, "[HEADLESS] State changes: avg ", state_changes_total / frames, ", max ", state_changes_max);
+        println(stdout, "[HEADLESS] Draw calls: avg ", draw_calls_total / frames, ", max ", draw_calls_max);
+        println(stdout, "[HEADLESS] Render time: avg ", render_time_total / (float) frames * 1000.0f,
+                " ms, max ", render_time_max * 1000.0f, " ms");
+    }
+};
+
+static void headless_write_le(FILE *stream, uint32_t value, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        fputc((int) ((value >> (8 * i)) & 0xFF), stream);
+    }
+}
+
+// NOTE: the audio device is replaced by the simulation clock. Every
+// simulated frame is 1/SIMULATION_FPS seconds of sound and the mixer
+// callback is called once per SOMETHING_SOUND_SAMPLES of them, the same
+// as SDL would call it.
+struct Headless_Audio
+{
+    FILE *wav;
+    uint64_t frames_due;
+    uint64_t frames_written;
+    int16_t buffer[SOMETHING_SOUND_SAMPLES * SOMETHING_SOUND_CHANNELS];
+
+    void write_header(uint32_t data_size)
+    {
+        const uint32_t block_align = (uint32_t) (SOMETHING_SOUND_CHANNELS * sizeof(int16_t));
+        fseek(wav, 0, SEEK_SET);
+        fwrite("RIFF", 1, 4, wav);
+        headless_write_le(wav, 36 + data_size, 4);
+        fwrite("WAVEfmt ", 1, 8, wav);
+        headless_write_le(wav, 16, 4);
+        headless_write_le(wav, 1, 2); // PCM
+        headless_write_le(wav, (uint32_t) SOMETHING_SOUND_CHANNELS, 2);
+        headless_write_le(wav, (uint32_t) SOMETHING_SOUND_FREQ, 4);
+        headless_write_le(wav, (uint32_t) SOMETHING_SOUND_FREQ * block_align, 4);
+        headless_write_le(wav, block_align, 2);
+        headless_write_le(wav, 16, 2);
+        fwrite("data", 1, 4, wav);
+        headless_write_le(wav, data_size, 4);
+    }
+
+    void open(const char *file_path)
+    {
+        wav = fopen(file_path, "wb");
+        if (wav == NULL) {
+            println(stderr, "ERROR: could not open file `", file_path, "`: ", strerror(errno));
+            exit(1);
+        }
+        write_header(0);
+    }
+
+    void mix(Sample_Mixer *mixer, uint64_t frames)
+    {
+        const size_t n = (size_t) min(frames, (uint64_t) SOMETHING_SOUND_SAMPLES);
+        sample_mixer_audio_callback(mixer, (Uint8*) buffer, (int) sizeof(buffer));
+        for (size_t i = 0; i < n * SOMETHING_SOUND_CHANNELS; ++i) {
+            headless_write_le(wav, (uint32_t) (uint16_t) buffer[i], 2);
+        }
+        frames_written += n;
+    }
+
+    void advance(Sample_Mixer *mixer, int frame)
+    {
+        frames_due = (uint64_t) (frame + 1) * SOMETHING_SOUND_FREQ / SIMULATION_FPS;
+        while (frames_written + SOMETHING_SOUND_SAMPLES <= frames_due) {
+            mix(mixer, SOMETHING_SOUND_SAMPLES);
+        }
+    }
+
+    void close(Sample_Mixer *mixer)
+    {
+        if (frames_written < frames_due) {
+            mix(mixer, frames_due - frames_written);
+        }
+        write_header((uint32_t) (frames_written * SOMETHING_SOUND_CHANNELS * sizeof(int16_t)));
+        fclose(wav);
+        wav = NULL;
+    }
+};
+
+int headless_main(Args args)
+{
+    int frames = HEADLESS_DEFAULT_FRAMES;
+    if (!args.empty() && args.argv[0][0] != '-') {
+        frames = parse_amount(&args, "frames");
+    }
+
+    FILE *dump = NULL;
+    const char *image_path = NULL;
+    const char *audio_path = NULL;
+    Maybe<size_t> soft_threads = {};
+    while (!args.empty()) {
+        const char *flag = args.shift();
+        if (strcmp(flag, "--dump") == 0) {
+            if (args.empty()) {
+                println(stderr, "ERROR: no file is provided for `--dump`");
+                exit(1);
+            }
+            const char *dump_path = args.shift();
+            dump = fopen(dump_path, "wb");
+            if (dump == NULL) {
+                println(stderr, "ERROR: could not open file `", dump_path, "`: ", strerror(errno));
+                exit(1);
+            }
+        } else if (strcmp(flag, "--soft") == 0) {
+            soft_threads = {true, HEADLESS_DEFAULT_SOFT_THREADS};
+            if (!args.empty() && args.argv[0][0] != '-') {
+                soft_threads.unwrap = (size_t) parse_amount(&args, "threads");
+            }
+        } else if (strcmp(flag, "--image") == 0) {
+            if (args.empty()) {
+                println(stderr, "ERROR: no file is provided for `--image`");
+                exit(1);
+            }
+            image_path = args.shift();
+        } else if (strcmp(flag, "--audio") == 0) {
+            if (args.empty()) {
+                println(stderr, "ERROR: no file is provided for `--audio`");
+                exit(1);
+            }
+            audio_path = args.shift();
+        } else {
+            println(stderr, "ERROR: unknown headless flag `", flag, "`");
+            exit(1);
+        }
+    }
+
+    sec(SDL_Init(0));
+
+    SDL_Surface *framebuffer = sec(SDL_CreateRGBSurfaceWithFormat(
+                                       0, (int) SCREEN_WIDTH, (int) SCREEN_HEIGHT,
+                                       32, SDL_PIXELFORMAT_RGBA32));
+    SDL_Renderer *renderer = sec(SDL_CreateSoftwareRenderer(framebuffer));
+    sec(SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND));
+
+    assets.load(renderer);
+
+#ifndef SOMETHING_RELEASE
+    {
+        auto result = reload_config_file(VARS_CONF_FILE_PATH);
+        if (result.is_error) {
+            println(stderr, VARS_CONF_FILE_PATH, ":", result.line, ": ", result.message);
+            exit(1);
+        }
+    }
+#endif // SOMETHING_RELEASE
+
+    setup_tile_defs();
+
+    Game *game = new Game {};
+    defer(delete game);
+
+    game->popup.font.bitmap = load_texture_from_bmp_file(renderer, "./assets/fonts/charmap-oldschool.bmp", {0, 0, 0, 255});
+    game->debug_font.bitmap = game->popup.font.bitmap;
+    game->background.layers[0] = sprite_from_texture_index(BACKGROUND_LIGHTS_TEXTURE_INDEX);
+    game->background.layers[1] = sprite_from_texture_index(BACKGROUND_MIDDLE_TEXTURE_INDEX);
+    game->background.layers[2] = sprite_from_texture_index(BACKGROUND_FRONT_TEXTURE_INDEX);
+    game->reset_entities();
+    load_rooms(game);
+
+    Render_Snapshot *snapshot = new Render_Snapshot {};
+    defer(delete snapshot);
+
+    game->sprite_batch.dump = dump;
+
+    Soft_Renderer soft = {};
+    if (soft_threads.has_value) {
+        soft.init((int) SCREEN_WIDTH, (int) SCREEN_HEIGHT, soft_threads.unwrap);
+        for (size_t i = 0; i < assets.atlases_count; ++i) {
+            // NOTE: the rasterizer knows the atlases by their textures,
+            // so they stay resident for the whole run
+            soft.register_texture(assets.pin_atlas(i), assets.atlases[i].surface);
+        }
+        game->sprite_batch.soft = &soft;
+        println(stdout, "[HEADLESS] Rasterizing with Soft_Renderer on ", soft.threads_count, " thread(s)");
+    }
+
+    Headless_Audio *audio = NULL;
+    if (audio_path) {
+        audio = new Headless_Audio {};
+        audio->open(audio_path);
+        game->mixer.set_volume(0.2f);
+    }
+
+    Headless_Stats stats = {};
+    for (int frame = 0; frame < frames; ++frame) {
+        game->update(SIMULATION_DELTA_TIME);
+        game->snapshot(snapshot);
+        if (audio) {
+            audio->advance(&game->mixer, frame);
+        }
+
+        const Uint64 begin = SDL_GetPerformanceCounter();
+        sec(SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255));
+        sec(SDL_RenderClear(renderer));
+        if (soft_threads.has_value) {
+            soft.clear({0, 0, 0, 255});
+        }
+        glyph_run_cache.begin_frame();
+        assets.begin_frame();
+        game->render(renderer, snapshot);
+        SDL_RenderPresent(renderer);
+        const float render_time =
+            (float) (SDL_GetPerformanceCounter() - begin) /
+            (float) SDL_GetPerformanceFrequency();
+
+        stats.push(&game->sprite_batch, render_time);
+    }
+
+    stats.report();
+
+    if (image_path) {
+        if (soft_threads.has_value) {
+            soft.save_bmp(image_path);
+        } else {
+            sec(SDL_SaveBMP(framebuffer, image_path));
+        }
+        println(stdout, "[HEADLESS] Saved the last frame to ", image_path);
+    }
+
+    if (audio) {
+        audio->close(&game->mixer);
+        println(stdout, "[HEADLESS] Saved ", audio->frames_written, " frames of audio to ", audio_path,
+                " (", game->mixer.steals_count, " voices stolen, ", game->mixer.culled_count, " sounds culled, ",
+                game->mixer.dropped_count, " dropped)");
+        delete audio;
+    }
+
+    if (soft_threads.has_value) {
+        soft.clean();
+    }
+
+    if (dump) {
+        fclose(dump);
+    }
+
+    SDL_Quit();
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef SOMETHING_HEADLESS_HPP_
+#define SOMETHING_HEADLESS_HPP_
+
+// NOTE: `./something.debug --headless [frames] [options]` simulates
+// and renders the given amount of frames into an offscreen software
+// renderer without opening a window and reports the render command
+// counters per frame, so render cost and correctness can be checked
+// on machines without a GPU. Options:
+//   --dump <file>      write the sorted command list of every frame
+//   --soft [threads]   rasterize the batched commands with Soft_Renderer
+//   --image <file>     save the last frame as a BMP image
+//   --audio <file>     mix the sounds in step with the simulation and
+//                      save them as a WAV file, the same frames give
+//                      the same bytes
+const int HEADLESS_DEFAULT_FRAMES = 60;
+const size_t HEADLESS_DEFAULT_SOFT_THREADS = 4;
+
+int headless_main(Args args);
+
+#endif  // SOMETHING_HEADLESS_HPP_
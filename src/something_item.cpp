@@ -5,11 +5,12 @@ void Item::update(float delta_time)
     a = fmodf(a + ITEM_OSC_FREQ * delta_time, 2 * PI);
 }
 
-void Item::render(SDL_Renderer *renderer, Camera camera, RGBA shade) const
+void Item::render(Sprite_Batch *batch, Camera camera, RGBA shade) const
 {
     if (type != ITEM_NONE) {
         sprite.render(
-            renderer,
+            batch,
+            SPRITE_LAYER_ITEMS,
             camera.to_screen(texbox_world() + vec2(0.0f, sin(a) * ITEM_AMP_VALUE)),
             SDL_FLIP_NONE,
             shade);
@@ -22,7 +22,7 @@ struct Item
     Sample_S16_Index sound;
 
     void update(float delta_time);
-    void render(SDL_Renderer *renderer, Camera camera,
+    void render(Sprite_Batch *batch, Camera camera,
                 RGBA shade = {0, 0, 0, 0}) const;
     void render_debug(SDL_Renderer *renderer, Camera camera) const;
     Rectf hitbox_world() const;
@@ -1,8 +1,9 @@
 #include "something_fmw.hpp"
 #include "something_assets.hpp"
-
-const int SIMULATION_FPS = 60;
-const float SIMULATION_DELTA_TIME = 1.0f / SIMULATION_FPS;
+#include "something_simulation.hpp"
+#include "something_server.hpp"
+#include "something_headless.hpp"
+#include "something_mixer_bench.hpp"
 
 Dynamic_Array<Dynamic_Array<char>> load_room_files_from_dir(const char *room_dir_path)
 {
@@ -30,7 +31,7 @@ Dynamic_Array<Dynamic_Array<char>> load_room_files_from_dir(const char *room_dir
     return room_files;
 }
 
-void update_mouse_position(Game *game, SDL_Window *window)
+Vec2i mouse_screen_position(SDL_Window *window)
 {
     int mouse_x, mouse_y;
     SDL_GetMouseState(&mouse_x, &mouse_y);
@@ -64,49 +65,14 @@ void update_mouse_position(Game *game, SDL_Window *window)
         float new_mouse_y = (float) mouse_y - padding / 2;
         motion_y = (int) floorf(new_mouse_y / new_screen * SCREEN_HEIGHT);
     }
-    game->mouse_position =
-        game->camera.to_world(vec_cast<float>(vec2(motion_x, motion_y)));
-    game->collision_probe = game->mouse_position;
+    return vec2(motion_x, motion_y);
 }
 
-int main(int argc, char *argv[])
+void setup_tile_defs()
 {
-    (void) argc;
-    (void) argv;
-
-    Game *game = new Game {};
-    defer(delete game);
-
-    sec(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO));
-
-    SDL_Window *window =
-        sec(SDL_CreateWindow(
-                "Something",
-                0, 0, (int) SCREEN_WIDTH, (int) SCREEN_HEIGHT,
-                SDL_WINDOW_RESIZABLE));
-
-    SDL_Renderer *renderer =
-        sec(SDL_CreateRenderer(
-                window, -1,
-                SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED));
-
-    assets.load_conf(renderer, "./assets/assets.conf");
-
-    SDL_StopTextInput();
-
-    sec(SDL_RenderSetLogicalSize(renderer,
-                           (int) SCREEN_WIDTH,
-                           (int) SCREEN_HEIGHT));
-
     // TODO(#8): replace fantasy_tiles.png with our own assets
     auto tileset_texture = FANTASY_TEXTURE_INDEX;
 
-    game->mixer.volume = 0.2f;
-    game->keyboard = SDL_GetKeyboardState(NULL);
-
-    game->popup.font.bitmap = load_texture_from_bmp_file(renderer, "./assets/fonts/charmap-oldschool.bmp", {0, 0, 0, 255});
-    game->debug_font.bitmap = game->popup.font.bitmap;
-
     // TODO(#119): move tiles srcrect dimention to config.vars
     //   That may require add a new type to the config file.
     //   Might be a good opportunity to simplify adding new types to the system.
@@ -164,11 +130,75 @@ int main(int argc, char *argv[])
         ICE_BLOCK_TEXTURE_INDEX
     };
     tile_defs[TILE_ICE_3].top_texture = tile_defs[TILE_ICE_3].bottom_texture;
+}
 
-    game->background.layers[0] = sprite_from_texture_index(BACKGROUND_LIGHTS_TEXTURE_INDEX);
-    game->background.layers[1] = sprite_from_texture_index(BACKGROUND_MIDDLE_TEXTURE_INDEX);
-    game->background.layers[2] = sprite_from_texture_index(BACKGROUND_FRONT_TEXTURE_INDEX);
+void load_rooms(Game *game)
+{
+    auto room_files = load_room_files_from_dir("./assets/rooms/");
+
+    const int PADDING = 1;
+    for (int y = 0; y < 10; ++y) {
+        for (int x = 0; x < 10; ++x) {
+            const auto coord = vec2(x * (ROOM_WIDTH + PADDING), y * (ROOM_HEIGHT + PADDING));
+            const size_t room_index = random_u32() % room_files.size;
+            game->grid.load_room_from_file(room_files.data[room_index].data, coord);
+            game->add_camera_lock(rect(coord, ROOM_WIDTH, ROOM_HEIGHT));
+        }
+    }
+}
+
+// NOTE: the mixer is passed along, because the samples of the changed
+// sounds are freed and the slots that play them have to be stopped.
+// The watcher also reports the files the assets do not use, so it does
+// not bother anybody when nothing was reloaded.
+void reload_assets(Game *game, Simulation *simulation, SDL_Renderer *renderer,
+                   bool always_notify)
+{
+    sec(SDL_LockMutex(simulation->mutex));
+    auto reload = assets.reload(renderer, &game->mixer);
+    if (reload.full) {
+        game->popup.notify(FONT_SUCCESS_COLOR, "Reloaded assets file");
+    } else if (always_notify || reload.textures_count > 0 || reload.sounds_count > 0 || reload.framesen_count > 0) {
+        game->popup.notify(FONT_SUCCESS_COLOR, "Reloaded assets\n\n%d textures, %d sounds, %d animats",
+                           (int) reload.textures_count,
+                           (int) reload.sounds_count,
+                           (int) reload.framesen_count);
+    }
+    sec(SDL_UnlockMutex(simulation->mutex));
+}
+
+void usage(FILE *stream)
+{
+    println(stream, "Usage: ./something [--server [port] [seconds] | --client [port] [seconds] | --headless [frames] [--dump file] [--soft [threads]] [--image file] [--audio file] | --mixer-bench [callbacks] [voices...]]");
+}
 
+int main(int argc, char *argv[])
+{
+    Args args = {argc, argv};
+    args.shift();               // skip the program name
+
+    if (!args.empty()) {
+        const char *flag = args.shift();
+        if (strcmp(flag, "--server") == 0) {
+            return server_main(args);
+        } else if (strcmp(flag, "--client") == 0) {
+            return bot_client_main(args);
+        } else if (strcmp(flag, "--headless") == 0) {
+            return headless_main(args);
+        } else if (strcmp(flag, "--mixer-bench") == 0) {
+            return mixer_bench_main(args);
+        } else {
+            usage(stderr);
+            println(stderr, "ERROR: unknown flag `", flag, "`");
+            exit(1);
+        }
+    }
+
+    Game *game = new Game {};
+    defer(delete game);
+
+    // NOTE: the config is loaded before the renderer is created,
+    // because it decides whether the renderer waits for vsync
 #ifndef SOMETHING_RELEASE
     {
         auto result = reload_config_file(VARS_CONF_FILE_PATH);
@@ -177,8 +207,42 @@ int main(int argc, char *argv[])
             game->popup.notify(FONT_FAILURE_COLOR, "%s:%d: %s", VARS_CONF_FILE_PATH, result.line, result.message);
         }
     }
+#endif // SOMETHING_RELEASE
 
-    auto fmw = fmw_init(VARS_CONF_FILE_PATH);
+    sec(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO));
+
+    SDL_Window *window =
+        sec(SDL_CreateWindow(
+                "Something",
+                0, 0, (int) SCREEN_WIDTH, (int) SCREEN_HEIGHT,
+                SDL_WINDOW_RESIZABLE));
+
+    SDL_Renderer *renderer =
+        sec(SDL_CreateRenderer(
+                window, -1,
+                (FRAME_PACER_VSYNC ? SDL_RENDERER_PRESENTVSYNC : 0) | SDL_RENDERER_ACCELERATED));
+
+    assets.load(renderer);
+
+    SDL_StopTextInput();
+
+    sec(SDL_RenderSetLogicalSize(renderer,
+                           (int) SCREEN_WIDTH,
+                           (int) SCREEN_HEIGHT));
+
+    game->mixer.set_volume(0.2f);
+
+    game->popup.font.bitmap = load_texture_from_bmp_file(renderer, "./assets/fonts/charmap-oldschool.bmp", {0, 0, 0, 255});
+    game->debug_font.bitmap = game->popup.font.bitmap;
+
+    setup_tile_defs();
+
+    game->background.layers[0] = sprite_from_texture_index(BACKGROUND_LIGHTS_TEXTURE_INDEX);
+    game->background.layers[1] = sprite_from_texture_index(BACKGROUND_MIDDLE_TEXTURE_INDEX);
+    game->background.layers[2] = sprite_from_texture_index(BACKGROUND_FRONT_TEXTURE_INDEX);
+
+#ifndef SOMETHING_RELEASE
+    auto fmw = fmw_init("./assets/");
 #endif // SOMETHING_RELEASE
 
     static_assert(DEBUG_TOOLBAR_COUNT <= TOOLBAR_BUTTONS_CAPACITY);
@@ -261,36 +325,62 @@ int main(int argc, char *argv[])
         println(stderr, "[WARN] We didn't get expected audio format.");
         abort();
     }
+    game->mixer.device = dev;
     SDL_PauseAudioDevice(dev, 0);
     // SOUND END //////////////////////////////
 
     game->reset_entities();
 
-    auto room_files = load_room_files_from_dir("./assets/rooms/");
+    load_rooms(game);
 
-    const int PADDING = 1;
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 10; ++x) {
-            const auto coord = vec2(x * (ROOM_WIDTH + PADDING), y * (ROOM_HEIGHT + PADDING));
-            const size_t room_index = rand() % room_files.size;
-            game->grid.load_room_from_file(room_files.data[room_index].data, coord);
-            game->add_camera_lock(rect(coord, ROOM_WIDTH, ROOM_HEIGHT));
-        }
+    // NOTE: the tiles and the background are on the screen from the
+    // very first frame, so their atlases are uploaded right away
+    // instead of in the middle of it
+    for (size_t i = 0; i < TILE_COUNT; ++i) {
+        assets.prefetch(tile_defs[i].top_texture.texture_index);
+        assets.prefetch(tile_defs[i].bottom_texture.texture_index);
+    }
+    for (size_t i = 0; i < BACKGROUND_LAYERS_COUNT; ++i) {
+        assets.prefetch(game->background.layers[i].texture_index);
     }
 
     sec(SDL_SetRenderDrawBlendMode(
             renderer,
             SDL_BLENDMODE_BLEND));
 
-    Uint32 prev_ticks = SDL_GetTicks();
-    float lag_sec = 0;
+    Snapshot_Triple_Buffer *snapshots = new Snapshot_Triple_Buffer {};
+    defer(delete snapshots);
+    snapshots->init();
+    game->snapshot(snapshots->back_buffer());
+    snapshots->publish();
+
+    Simulation *simulation = new Simulation {};
+    defer(delete simulation);
+    simulation->game = game;
+    simulation->snapshots = snapshots;
+    simulation->mutex = sec(SDL_CreateMutex());
+    defer(SDL_DestroyMutex(simulation->mutex));
+    simulation->set_mouse_screen_position(mouse_screen_position(window));
+
+    SDL_Thread *simulation_thread_handle =
+        sec(SDL_CreateThread(simulation_thread, "Simulation", simulation));
+
+    Frame_Pacer *pacer = &game->frame_pacer;
+    pacer->init();
     float next_sec = 0;
     size_t frames_of_current_second = 0;
     size_t fps = 0;
-    while (!game->quit) {
-        Uint32 curr_ticks = SDL_GetTicks();
-        float elapsed_sec = (float) (curr_ticks - prev_ticks) / 1000.0f;
-        if(game->fps_debug) {
+    const Render_Snapshot *snapshot = snapshots->acquire();
+    while (!snapshot->quit) {
+        const float frame_period = FRAME_PACER_TARGET_FPS > 0 ? 1.0f / (float) FRAME_PACER_TARGET_FPS : 0.0f;
+        if (FRAME_PACER_LOW_LATENCY) {
+            // NOTE: wake up just in time to sample the input, render
+            // and present by the deadline
+            pacer->wait(frame_period, FRAME_PACER_SPIN_MS / 1000.0f, pacer->work_estimate);
+        }
+
+        float elapsed_sec = pacer->begin_frame();
+        if(snapshot->fps_debug) {
             game->frame_delays[game->frame_delays_begin] = elapsed_sec;
             game->frame_delays_begin = (game->frame_delays_begin + 1) % FPS_BARS_COUNT;
         }
@@ -302,44 +392,59 @@ int main(int argc, char *argv[])
             fps = frames_of_current_second;
             next_sec -= 1.0f;
             frames_of_current_second = 0;
+            pacer->publish_stats();
         }
 
-        prev_ticks = curr_ticks;
-        lag_sec += elapsed_sec;
-
         //// HANDLE INPUT //////////////////////////////
-        update_mouse_position(game, window);
+        simulation->set_mouse_screen_position(mouse_screen_position(window));
 
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
             switch (event.type) {
             case SDL_KEYDOWN: {
                 switch (event.key.keysym.sym) {
-                case SDLK_x: {
-                    if (game->step_debug) {
-                        game->update(SIMULATION_DELTA_TIME);
-                    }
-                } break;
-
                 case SDLK_F6: {
-                    // NOTE: it is important to clean all of the
-                    // samples from the mixer before reloading the
-                    // assets, because after assets are reloaded any
-                    // pointers stored in the mixer could be
-                    // invalidated.
-                    game->mixer.clean();
-                    assets.load_conf(renderer, "./assets/assets.conf");
-                    game->popup.notify(FONT_SUCCESS_COLOR, "Reloaded assets file");
+                    reload_assets(game, simulation, renderer, true);
                 } break;
                 }
             } break;
+
+            case SDL_RENDER_TARGETS_RESET:
+            case SDL_RENDER_DEVICE_RESET: {
+                // NOTE: the contents of the render targets are lost,
+                // the glyph runs are going to be baked again
+                glyph_run_cache.clean();
+            } break;
             }
 
-            game->handle_event(&event);
+            if (!simulation->inputs.push(&event)) {
+                println(stderr, "[WARN] Input queue overflow. Dropping event ", event.type);
+            }
         }
 
 #ifndef SOMETHING_RELEASE
-        if (fmw_poll(fmw)) {
+        bool vars_changed = false;
+        bool assets_changed = false;
+        Fmw_Change change = {};
+        while (fmw_poll(fmw, &change)) {
+            const String_View path = cstr_as_string_view(change.path);
+            if (path == cstr_as_string_view(VARS_CONF_FILE_PATH)) {
+                vars_changed = true;
+            } else if (path.has_prefix("./assets/rooms/"_sv)) {
+                // NOTE: the rooms are copied into the grid at random
+                // on start up and saved from the game itself, so there
+                // is nothing to reload them into yet
+            } else {
+                assets_changed = true;
+            }
+        }
+
+        if (assets_changed) {
+            reload_assets(game, simulation, renderer, false);
+        }
+
+        if (vars_changed) {
+            sec(SDL_LockMutex(simulation->mutex));
             auto result = reload_config_file(VARS_CONF_FILE_PATH);
             if (result.is_error) {
                 println(stderr, VARS_CONF_FILE_PATH, ":", result.line, ": ", result.message);
@@ -347,19 +452,20 @@ int main(int argc, char *argv[])
             } else {
                 game->popup.notify(FONT_SUCCESS_COLOR, "Reloaded config file\n\n%s", VARS_CONF_FILE_PATH);
             }
+            sec(SDL_UnlockMutex(simulation->mutex));
         }
 #endif // SOMETHING_RELEASE
         //// HANDLE INPUT END //////////////////////////////
 
-        //// UPDATE STATE //////////////////////////////
-        if (!game->step_debug) {
-            SDL_Delay(1);
-            while (lag_sec >= SIMULATION_DELTA_TIME) {
-                game->update(SIMULATION_DELTA_TIME);
-                lag_sec -= SIMULATION_DELTA_TIME;
+        snapshot = snapshots->acquire();
+
+        if (snapshot->console.enabled != (bool) SDL_IsTextInputActive()) {
+            if (snapshot->console.enabled) {
+                SDL_StartTextInput();
+            } else {
+                SDL_StopTextInput();
             }
         }
-        //// UPDATE STATE END //////////////////////////////
 
         //// RENDER //////////////////////////////
         const SDL_Color background_color = rgba_to_sdl(BACKGROUND_COLOR);
@@ -381,14 +487,28 @@ int main(int argc, char *argv[])
             SDL_Rect canvas = {0, 0, (int) floorf(SCREEN_WIDTH), (int) floorf(SCREEN_HEIGHT)};
             SDL_RenderFillRect(renderer, &canvas);
         }
-        game->render(renderer);
-        if (game->debug) {
-            game->render_debug_overlay(renderer, fps);
+        glyph_run_cache.begin_frame();
+        assets.begin_frame();
+        game->render(renderer, snapshot);
+        if (snapshot->debug) {
+            game->render_debug_overlay(renderer, snapshot, fps);
         }
         SDL_RenderPresent(renderer);
         //// RENDER END //////////////////////////////
+
+        pacer->end_work();
+        if (!FRAME_PACER_LOW_LATENCY) {
+            pacer->wait(frame_period, FRAME_PACER_SPIN_MS / 1000.0f, 0.0f);
+        }
     }
 
+    SDL_AtomicSet(&simulation->stop, 1);
+    SDL_WaitThread(simulation_thread_handle, NULL);
+
+#ifndef SOMETHING_RELEASE
+    fmw_free(fmw);
+#endif // SOMETHING_RELEASE
+
     SDL_Quit();
 
     return 0;
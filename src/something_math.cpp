@@ -234,8 +234,20 @@ Vec2f polar(float mag, float angle)
     return vec2(cosf(angle), sinf(angle)) * mag;
 }
 
+// NOTE: xorshift32 instead of rand() so the state of the generator
+// can be captured by the save states (see something_save_state.cpp)
+uint32_t random_state = 2463534242;
+
+uint32_t random_u32()
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
 float rand_float_range(float low, float high)
 {
-    const auto r = (float)rand()/(float)(RAND_MAX);
+    const auto r = (float)random_u32()/(float)(UINT32_MAX);
     return low + r * (high - low);
 }
@@ -0,0 +1,81 @@
+#include "./something_mixer_bench.hpp"
+
+static int parse_bench_amount(const char *arg, const char *what)
+{
+    auto amount = cstr_as_string_view(arg).as_integer<int>();
+    if (!amount.has_value || amount.unwrap <= 0) {
+        println(stderr, "ERROR: `", arg, "` is not a valid amount of ", what);
+        exit(1);
+    }
+
+    return amount.unwrap;
+}
+
+static void mixer_bench(size_t voices, int callbacks)
+{
+    if (voices > SAMPLE_MIXER_CAPACITY) {
+        println(stderr, "[MIXER] ", voices, " voices do not fit into the mixer, using ", SAMPLE_MIXER_CAPACITY);
+        voices = SAMPLE_MIXER_CAPACITY;
+    }
+
+    // NOTE: one long buffer of noise, every voice starts at a
+    // different offset so they do not all read the same cache lines,
+    // and none of them ends before the run does
+    const size_t VOICE_STRIDE = 997;
+    const size_t noise_len = (size_t) (callbacks + 1) * SOMETHING_SOUND_SAMPLES + voices * VOICE_STRIDE;
+    int16_t *noise = (int16_t*) malloc(noise_len * sizeof(*noise));
+    assert(noise != NULL);
+    defer(free(noise));
+    for (size_t i = 0; i < noise_len; ++i) {
+        noise[i] = (int16_t) (random_u32() & 0xFFFF);
+    }
+
+    Sample_Mixer *mixer = new Sample_Mixer {};
+    defer(delete mixer);
+    mixer->set_volume(0.2f);
+    for (size_t i = 0; i < voices; ++i) {
+        Sample_S16 sample = {};
+        sample.audio_buf = noise + i * VOICE_STRIDE;
+        sample.audio_len = (Uint32) (noise_len - i * VOICE_STRIDE);
+        mixer->play({i}, sample, 1.0f, 1.0f);
+    }
+    // NOTE: so the first callback does not pay for the queued plays
+    mixer->drain();
+
+    int16_t output[SOMETHING_SOUND_SAMPLES * SOMETHING_SOUND_CHANNELS];
+    float total = 0.0f;
+    float longest = 0.0f;
+    for (int i = 0; i < callbacks; ++i) {
+        const Uint64 begin = SDL_GetPerformanceCounter();
+        sample_mixer_audio_callback(mixer, (Uint8*) output, (int) sizeof(output));
+        const float elapsed = (float) (SDL_GetPerformanceCounter() - begin) / (float) SDL_GetPerformanceFrequency();
+        total += elapsed;
+        longest = max(longest, elapsed);
+    }
+
+    const float budget = (float) SOMETHING_SOUND_SAMPLES / (float) SOMETHING_SOUND_FREQ;
+    const float average = total / (float) callbacks;
+    println(stdout, "[MIXER] ", voices, " voices: avg ", average * 1000000.0f, " us, max ",
+            longest * 1000000.0f, " us per callback (", average / budget * 100.0f, "% of the ",
+            budget * 1000.0f, " ms the callback has)");
+}
+
+int mixer_bench_main(Args args)
+{
+    int callbacks = MIXER_BENCH_DEFAULT_CALLBACKS;
+    if (!args.empty()) {
+        callbacks = parse_bench_amount(args.shift(), "callbacks");
+    }
+
+    if (args.empty()) {
+        for (size_t i = 0; i < sizeof(MIXER_BENCH_DEFAULT_VOICES) / sizeof(MIXER_BENCH_DEFAULT_VOICES[0]); ++i) {
+            mixer_bench(MIXER_BENCH_DEFAULT_VOICES[i], callbacks);
+        }
+    } else {
+        while (!args.empty()) {
+            mixer_bench((size_t) parse_bench_amount(args.shift(), "voices"), callbacks);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+#ifndef SOMETHING_MIXER_BENCH_HPP_
+#define SOMETHING_MIXER_BENCH_HPP_
+
+// NOTE: `./something.debug --mixer-bench [callbacks] [voices...]` fills
+// the mixer with the given amounts of voices playing synthetic noise
+// and reports the time of the mixing per audio callback of
+// SOMETHING_SOUND_SAMPLES samples. No audio device is opened.
+const int MIXER_BENCH_DEFAULT_CALLBACKS = 1000;
+const size_t MIXER_BENCH_DEFAULT_VOICES[] = {5, 64, 256};
+
+int mixer_bench_main(Args args);
+
+#endif  // SOMETHING_MIXER_BENCH_HPP_
@@ -0,0 +1,350 @@
+#include "something_nav.hpp"
+
+const int NAV_UNREACHABLE = 0x7FFFFFFF;
+const size_t NAV_GOAL_NODE = NAV_NODES_CAPACITY;
+
+static Vec2i nav_side_direction(Nav_Side side)
+{
+    switch (side) {
+    case NAV_SIDE_RIGHT: return vec2(1, 0);
+    case NAV_SIDE_LEFT:  return vec2(-1, 0);
+    case NAV_SIDE_DOWN:  return vec2(0, 1);
+    case NAV_SIDE_UP:    return vec2(0, -1);
+    case NAV_SIDE_COUNT:
+    default: {
+        assert(0 && "unreachable");
+        return vec2(0, 0);
+    }
+    }
+}
+
+static Nav_Side nav_opposite_side(Nav_Side side)
+{
+    return (Nav_Side) (side ^ 1);
+}
+
+static bool vec2i_equal(Vec2i a, Vec2i b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+static int manhattan_distance(Vec2i a, Vec2i b)
+{
+    return abs(a.x - b.x) + abs(a.y - b.y);
+}
+
+uint16_t Nav_Room::distance_to(size_t portal, Vec2i tile) const
+{
+    assert(portal < portals_count);
+    if (!rect_contains_vec2(rect, tile)) {
+        return 0;
+    }
+    return portals[portal].distance[tile.y - rect.y][tile.x - rect.x];
+}
+
+void Nav_Graph::sync(const Recti *locks, size_t locks_count, uint32_t locks_generation, Tile_Grid *grid)
+{
+    if (locks_generation != this->locks_generation) {
+        this->locks_generation = locks_generation;
+        rooms_count = min(locks_count, NAV_ROOMS_CAPACITY);
+        for (size_t i = 0; i < rooms_count; ++i) {
+            const Recti a = locks[i];
+            assert(a.w <= ROOM_WIDTH && a.h <= ROOM_HEIGHT);
+
+            Nav_Room *room = &rooms[i];
+            room->rect = a;
+            room->dirty = true;
+            room->portals_count = 0;
+            for (size_t side = 0; side < NAV_SIDE_COUNT; ++side) {
+                room->neighbors[side] = {};
+            }
+
+            for (size_t j = 0; j < rooms_count; ++j) {
+                const Recti b = locks[j];
+                if (a.y == b.y && a.h == b.h) {
+                    if (b.x == a.x + a.w + 1) room->neighbors[NAV_SIDE_RIGHT] = {true, j};
+                    if (a.x == b.x + b.w + 1) room->neighbors[NAV_SIDE_LEFT]  = {true, j};
+                }
+                if (a.x == b.x && a.w == b.w) {
+                    if (b.y == a.y + a.h + 1) room->neighbors[NAV_SIDE_DOWN] = {true, j};
+                    if (a.y == b.y + b.h + 1) room->neighbors[NAV_SIDE_UP]   = {true, j};
+                }
+            }
+        }
+    } else if (grid->changes_overflow) {
+        for (size_t i = 0; i < rooms_count; ++i) {
+            rooms[i].dirty = true;
+        }
+    } else {
+        for (size_t i = 0; i < grid->changes_count; ++i) {
+            invalidate(grid->changes[i]);
+        }
+    }
+
+    grid->changes_count = 0;
+    grid->changes_overflow = false;
+}
+
+void Nav_Graph::invalidate(Vec2i tile)
+{
+    // NOTE: a room also depends on the gap and the border of its
+    // neighbors, because that's where its portals are.
+    const int BORDER = 2;
+    for (size_t i = 0; i < rooms_count; ++i) {
+        const Recti r = rooms[i].rect;
+        const Recti area = {r.x - BORDER, r.y - BORDER, r.w + 2 * BORDER, r.h + 2 * BORDER};
+        if (rect_contains_vec2(area, tile)) {
+            rooms[i].dirty = true;
+        }
+    }
+}
+
+static void nav_fill_distance(Nav_Portal *portal, Recti rect, Tile_Grid *grid)
+{
+    Room_Queue q = {};
+    memset(portal->distance, 0, sizeof(portal->distance));
+
+    q.nq(portal->tile);
+    portal->distance[portal->tile.y - rect.y][portal->tile.x - rect.x] = 1;
+    while (q.count > 0) {
+        const Vec2i p0 = q.dq();
+        const uint16_t d0 = portal->distance[p0.y - rect.y][p0.x - rect.x];
+        for (size_t side = 0; side < NAV_SIDE_COUNT; ++side) {
+            const Vec2i p1 = p0 + nav_side_direction((Nav_Side) side);
+            if (rect_contains_vec2(rect, p1) &&
+                grid->is_tile_empty_tile(p1) &&
+                portal->distance[p1.y - rect.y][p1.x - rect.x] == 0)
+            {
+                portal->distance[p1.y - rect.y][p1.x - rect.x] = (uint16_t) (d0 + 1);
+                q.nq(p1);
+            }
+        }
+    }
+}
+
+void Nav_Graph::rebuild_room(size_t room_index, Tile_Grid *grid)
+{
+    assert(room_index < rooms_count);
+    Nav_Room *room = &rooms[room_index];
+    const Recti r = room->rect;
+
+    room->portals_count = 0;
+    for (size_t side_index = 0; side_index < NAV_SIDE_COUNT; ++side_index) {
+        const Nav_Side side = (Nav_Side) side_index;
+        if (!room->neighbors[side].has_value) continue;
+
+        const Vec2i dir = nav_side_direction(side);
+        Vec2i begin = {};
+        Vec2i along = {};
+        int length = 0;
+        switch (side) {
+        case NAV_SIDE_RIGHT: begin = vec2(r.x + r.w - 1, r.y); along = vec2(0, 1); length = r.h; break;
+        case NAV_SIDE_LEFT:  begin = vec2(r.x, r.y);           along = vec2(0, 1); length = r.h; break;
+        case NAV_SIDE_DOWN:  begin = vec2(r.x, r.y + r.h - 1); along = vec2(1, 0); length = r.w; break;
+        case NAV_SIDE_UP:    begin = vec2(r.x, r.y);           along = vec2(1, 0); length = r.w; break;
+        case NAV_SIDE_COUNT:
+        default: {}
+        }
+
+        // NOTE: every run of open tiles along the side is a single
+        // portal placed in the middle of the run
+        int run_begin = -1;
+        for (int k = 0; k <= length; ++k) {
+            const Vec2i t = begin + along * k;
+            const bool open = k < length &&
+                grid->is_tile_empty_tile(t) &&
+                grid->is_tile_empty_tile(t + dir) &&
+                grid->is_tile_empty_tile(t + dir * 2);
+
+            if (open && run_begin < 0) {
+                run_begin = k;
+            } else if (!open && run_begin >= 0) {
+                if (room->portals_count < NAV_PORTALS_CAPACITY) {
+                    Nav_Portal *portal = &room->portals[room->portals_count++];
+                    portal->side = side;
+                    portal->tile = begin + along * ((run_begin + k - 1) / 2);
+                    nav_fill_distance(portal, r, grid);
+                }
+                run_begin = -1;
+            }
+        }
+    }
+
+    room->dirty = false;
+}
+
+Nav_Room *Nav_Graph::get_room(size_t room_index, Tile_Grid *grid)
+{
+    assert(room_index < rooms_count);
+    if (rooms[room_index].dirty) {
+        rebuild_room(room_index, grid);
+    }
+    return &rooms[room_index];
+}
+
+Maybe<size_t> Nav_Graph::room_of(Vec2i tile) const
+{
+    for (size_t i = 0; i < rooms_count; ++i) {
+        if (rect_contains_vec2(rooms[i].rect, tile)) {
+            return {true, i};
+        }
+    }
+    return {};
+}
+
+Maybe<size_t> Nav_Graph::linked_portal(size_t room_index, size_t portal_index, Tile_Grid *grid)
+{
+    const Nav_Room *room = get_room(room_index, grid);
+    assert(portal_index < room->portals_count);
+    const Nav_Portal *portal = &room->portals[portal_index];
+
+    const auto neighbor_index = room->neighbors[portal->side];
+    if (!neighbor_index.has_value) return {};
+
+    const Nav_Room *neighbor = get_room(neighbor_index.unwrap, grid);
+    const Vec2i target = portal->tile + nav_side_direction(portal->side) * 2;
+    for (size_t i = 0; i < neighbor->portals_count; ++i) {
+        if (neighbor->portals[i].side == nav_opposite_side(portal->side) &&
+            vec2i_equal(neighbor->portals[i].tile, target)) {
+            return {true, i};
+        }
+    }
+    return {};
+}
+
+void Nav_Graph::heap_push(Nav_Heap_Item item)
+{
+    assert(heap_count < NAV_HEAP_CAPACITY);
+    size_t i = heap_count++;
+    heap[i] = item;
+    while (i > 0 && heap[(i - 1) / 2].cost > heap[i].cost) {
+        swap(&heap[(i - 1) / 2], &heap[i]);
+        i = (i - 1) / 2;
+    }
+}
+
+Nav_Heap_Item Nav_Graph::heap_pop()
+{
+    assert(heap_count > 0);
+    const Nav_Heap_Item result = heap[0];
+    heap[0] = heap[--heap_count];
+
+    size_t i = 0;
+    for (;;) {
+        size_t smallest = i;
+        const size_t l = 2 * i + 1;
+        const size_t r = 2 * i + 2;
+        if (l < heap_count && heap[l].cost < heap[smallest].cost) smallest = l;
+        if (r < heap_count && heap[r].cost < heap[smallest].cost) smallest = r;
+        if (smallest == i) break;
+        swap(&heap[smallest], &heap[i]);
+        i = smallest;
+    }
+
+    return result;
+}
+
+void Nav_Graph::relax(size_t node, int cost, Vec2i first_step, int max_cost)
+{
+    if (cost <= max_cost && cost < costs[node] && heap_count < NAV_HEAP_CAPACITY) {
+        costs[node] = cost;
+        first_steps[node] = first_step;
+        heap_push({cost, node});
+    }
+}
+
+// NOTE: the neighbor of src that is one step closer to the portal
+static Maybe<Vec2i> nav_step_towards(const Nav_Room *room, size_t portal, Vec2i src)
+{
+    const uint16_t d = room->distance_to(portal, src);
+    if (d <= 1) return {};
+
+    for (size_t side = 0; side < NAV_SIDE_COUNT; ++side) {
+        const Vec2i next = src + nav_side_direction((Nav_Side) side);
+        if (room->distance_to(portal, next) == d - 1) {
+            return {true, next};
+        }
+    }
+    return {};
+}
+
+Maybe<Vec2i> Nav_Graph::next_step(Tile_Grid *grid, Vec2i src, Vec2i dst, int max_cost)
+{
+    const auto src_room = room_of(src);
+    const auto dst_room = room_of(dst);
+    if (src_room.has_value && dst_room.has_value && src_room.unwrap == dst_room.unwrap) {
+        return {};
+    }
+
+    for (size_t i = 0; i <= NAV_NODES_CAPACITY; ++i) {
+        costs[i] = NAV_UNREACHABLE;
+    }
+    heap_count = 0;
+
+    // Start nodes //////////////////////////////
+    if (src_room.has_value) {
+        const Nav_Room *room = get_room(src_room.unwrap, grid);
+        for (size_t p = 0; p < room->portals_count; ++p) {
+            const uint16_t d = room->distance_to(p, src);
+            if (d == 0) continue;
+
+            const Nav_Portal *portal = &room->portals[p];
+            Vec2i first_step = portal->tile + nav_side_direction(portal->side) * 2;
+            if (d > 1) {
+                auto step = nav_step_towards(room, p, src);
+                if (!step.has_value) continue;
+                first_step = step.unwrap;
+            }
+            relax(src_room.unwrap * NAV_PORTALS_CAPACITY + p, d - 1, first_step, max_cost);
+        }
+    } else {
+        // NOTE: src is in the gap between the rooms
+        for (size_t r = 0; r < rooms_count; ++r) {
+            const Recti rect = rooms[r].rect;
+            if (!rect_contains_vec2(Recti {rect.x - 1, rect.y - 1, rect.w + 2, rect.h + 2}, src)) continue;
+
+            const Nav_Room *room = get_room(r, grid);
+            for (size_t p = 0; p < room->portals_count; ++p) {
+                if (manhattan_distance(room->portals[p].tile, src) == 1) {
+                    relax(r * NAV_PORTALS_CAPACITY + p, 1, room->portals[p].tile, max_cost);
+                }
+            }
+        }
+    }
+
+    // Search //////////////////////////////
+    while (heap_count > 0) {
+        const Nav_Heap_Item item = heap_pop();
+        if (item.cost > costs[item.node]) continue;
+        if (item.node == NAV_GOAL_NODE) return {true, first_steps[NAV_GOAL_NODE]};
+
+        const size_t r = item.node / NAV_PORTALS_CAPACITY;
+        const size_t p = item.node % NAV_PORTALS_CAPACITY;
+        const Vec2i first_step = first_steps[item.node];
+        const Nav_Room *room = get_room(r, grid);
+        const Vec2i tile = room->portals[p].tile;
+
+        if (dst_room.has_value) {
+            if (dst_room.unwrap == r) {
+                const uint16_t d = room->distance_to(p, dst);
+                if (d > 0) relax(NAV_GOAL_NODE, item.cost + d - 1, first_step, max_cost);
+            }
+        } else if (manhattan_distance(tile, dst) == 1) {
+            relax(NAV_GOAL_NODE, item.cost + 1, first_step, max_cost);
+        }
+
+        const auto link = linked_portal(r, p, grid);
+        if (link.has_value) {
+            const size_t neighbor = room->neighbors[room->portals[p].side].unwrap;
+            relax(neighbor * NAV_PORTALS_CAPACITY + link.unwrap, item.cost + 2, first_step, max_cost);
+        }
+
+        for (size_t q = 0; q < room->portals_count; ++q) {
+            if (q == p) continue;
+            const uint16_t d = room->distance_to(q, tile);
+            if (d > 0) relax(r * NAV_PORTALS_CAPACITY + q, item.cost + d - 1, first_step, max_cost);
+        }
+    }
+
+    return {};
+}
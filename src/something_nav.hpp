@@ -0,0 +1,84 @@
+#ifndef SOMETHING_NAV_HPP_
+#define SOMETHING_NAV_HPP_
+
+// NOTE: Nav_Graph is a hierarchical (HPA*-style) navigation graph on
+// top of the rooms (camera locks). Rooms that are separated by a
+// single column or row of tiles are neighbors. Every run of tiles where
+// a room, the gap and its neighbor are all empty is a portal. For
+// every portal the distances to it from every tile of its room are
+// cached, which gives both the portal-to-portal costs and the next step
+// towards the portal. Paths between rooms are then searched over the
+// portals only. A room's cache is rebuilt only when the tiles of that
+// room (or of its borders with the neighbors) change.
+
+const size_t NAV_ROOMS_CAPACITY = 200;
+const size_t NAV_PORTALS_CAPACITY = 16;
+const size_t NAV_NODES_CAPACITY = NAV_ROOMS_CAPACITY * NAV_PORTALS_CAPACITY;
+const size_t NAV_HEAP_CAPACITY = NAV_NODES_CAPACITY * 4;
+
+enum Nav_Side
+{
+    NAV_SIDE_RIGHT = 0,
+    NAV_SIDE_LEFT,
+    NAV_SIDE_DOWN,
+    NAV_SIDE_UP,
+    NAV_SIDE_COUNT
+};
+
+struct Nav_Portal
+{
+    Nav_Side side;
+    Vec2i tile;
+    // NOTE: 0 means the tile cannot reach the portal, otherwise it's
+    // the distance to the portal in tiles plus 1.
+    uint16_t distance[ROOM_HEIGHT][ROOM_WIDTH];
+};
+
+struct Nav_Room
+{
+    Recti rect;
+    bool dirty;
+    Maybe<size_t> neighbors[NAV_SIDE_COUNT];
+    Nav_Portal portals[NAV_PORTALS_CAPACITY];
+    size_t portals_count;
+
+    uint16_t distance_to(size_t portal, Vec2i tile) const;
+};
+
+struct Nav_Heap_Item
+{
+    int cost;
+    size_t node;
+};
+
+struct Nav_Graph
+{
+    Nav_Room rooms[NAV_ROOMS_CAPACITY];
+    size_t rooms_count;
+    // NOTE: the generation of the camera locks the rooms were made of
+    uint32_t locks_generation;
+
+    // Search state
+    int costs[NAV_NODES_CAPACITY + 1];
+    Vec2i first_steps[NAV_NODES_CAPACITY + 1];
+    Nav_Heap_Item heap[NAV_HEAP_CAPACITY];
+    size_t heap_count;
+
+    void sync(const Recti *locks, size_t locks_count, uint32_t locks_generation, Tile_Grid *grid);
+    void invalidate(Vec2i tile);
+    void rebuild_room(size_t room_index, Tile_Grid *grid);
+    Nav_Room *get_room(size_t room_index, Tile_Grid *grid);
+    Maybe<size_t> room_of(Vec2i tile) const;
+    Maybe<size_t> linked_portal(size_t room_index, size_t portal_index, Tile_Grid *grid);
+
+    void heap_push(Nav_Heap_Item item);
+    Nav_Heap_Item heap_pop();
+    void relax(size_t node, int cost, Vec2i first_step, int max_cost);
+
+    // NOTE: the next tile to go to on the way from src to dst when
+    // they are in different rooms. Paths longer than max_cost tiles
+    // are not considered.
+    Maybe<Vec2i> next_step(Tile_Grid *grid, Vec2i src, Vec2i dst, int max_cost);
+};
+
+#endif  // SOMETHING_NAV_HPP_
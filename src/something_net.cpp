@@ -0,0 +1,173 @@
+#ifdef _WIN32
+#  include <winsock2.h>
+#else
+#  include <sys/socket.h>
+#  include <netinet/in.h>
+#  include <arpa/inet.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif // _WIN32
+
+#include "something_net.hpp"
+
+bool operator==(Net_Address a, Net_Address b)
+{
+    return a.host == b.host && a.port == b.port;
+}
+
+Net_Address net_loopback_address(uint16_t port)
+{
+    return {INADDR_LOOPBACK, port};
+}
+
+void net_init()
+{
+#ifdef _WIN32
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        println(stderr, "Could not initialize Winsock");
+        exit(1);
+    }
+#endif // _WIN32
+}
+
+void net_quit()
+{
+#ifdef _WIN32
+    WSACleanup();
+#endif // _WIN32
+}
+
+void Net_Socket::open(uint16_t port)
+{
+    handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef _WIN32
+    if (handle == INVALID_SOCKET) {
+#else
+    if (handle < 0) {
+#endif // _WIN32
+        println(stderr, "Could not create UDP socket: ", strerror(errno));
+        exit(1);
+    }
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (bind(handle, (const sockaddr *) &address, sizeof(address)) < 0) {
+        println(stderr, "Could not bind UDP socket to port ", port, ": ", strerror(errno));
+        exit(1);
+    }
+
+#ifdef _WIN32
+    u_long non_blocking = 1;
+    if (ioctlsocket(handle, FIONBIO, &non_blocking) != 0) {
+#else
+    if (fcntl(handle, F_SETFL, O_NONBLOCK) < 0) {
+#endif // _WIN32
+        println(stderr, "Could not make UDP socket non-blocking: ", strerror(errno));
+        exit(1);
+    }
+}
+
+void Net_Socket::close()
+{
+#ifdef _WIN32
+    closesocket(handle);
+#else
+    ::close(handle);
+#endif // _WIN32
+}
+
+void Net_Socket::send(Net_Address to, const void *data, size_t size)
+{
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(to.host);
+    address.sin_port = htons(to.port);
+
+    // NOTE: UDP does not guarantee delivery anyway, so failed sends
+    // are treated the same way as lost packets.
+    sendto(handle, (const char *) data, (int) size, 0,
+           (const sockaddr *) &address, sizeof(address));
+}
+
+Maybe<size_t> Net_Socket::receive(Net_Address *from, void *data, size_t capacity)
+{
+    sockaddr_in address = {};
+#ifdef _WIN32
+    int address_size = sizeof(address);
+#else
+    socklen_t address_size = sizeof(address);
+#endif // _WIN32
+
+    const auto n = recvfrom(handle, (char *) data, (int) capacity, 0,
+                            (sockaddr *) &address, &address_size);
+    if (n < 0) {
+        return {};
+    }
+
+    from->host = ntohl(address.sin_addr.s_addr);
+    from->port = ntohs(address.sin_port);
+    return {true, (size_t) n};
+}
+
+size_t net_delta_encode(const Net_World *baseline, const Net_World *world,
+                        uint8_t *output, size_t capacity)
+{
+    const uint8_t *a = (const uint8_t *) baseline;
+    const uint8_t *b = (const uint8_t *) world;
+    const size_t n = sizeof(Net_World);
+
+    size_t size = 0;
+    size_t i = 0;
+    while (i < n) {
+        const uint8_t x = a[i] ^ b[i];
+        if (x != 0) {
+            if (size + 1 > capacity) return 0;
+            output[size++] = x;
+            i += 1;
+        } else {
+            uint8_t run = 0;
+            while (i < n && run < 255 && (a[i] ^ b[i]) == 0) {
+                run += 1;
+                i += 1;
+            }
+
+            if (size + 2 > capacity) return 0;
+            output[size++] = 0;
+            output[size++] = run;
+        }
+    }
+
+    return size;
+}
+
+bool net_delta_decode(const Net_World *baseline,
+                      const uint8_t *input, size_t size,
+                      Net_World *world)
+{
+    const uint8_t *a = (const uint8_t *) baseline;
+    uint8_t *b = (uint8_t *) world;
+    const size_t n = sizeof(Net_World);
+
+    size_t i = 0;
+    size_t j = 0;
+    while (j < size) {
+        if (input[j] != 0) {
+            if (i >= n) return false;
+            b[i] = a[i] ^ input[j];
+            i += 1;
+            j += 1;
+        } else {
+            if (j + 1 >= size) return false;
+            const size_t run = input[j + 1];
+            if (i + run > n) return false;
+            memcpy(b + i, a + i, run);
+            i += run;
+            j += 2;
+        }
+    }
+
+    return i == n;
+}
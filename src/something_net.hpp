@@ -0,0 +1,132 @@
+#ifndef SOMETHING_NET_HPP_
+#define SOMETHING_NET_HPP_
+
+#ifdef _WIN32
+typedef SOCKET Net_Socket_Handle;
+#else
+typedef int Net_Socket_Handle;
+#endif // _WIN32
+
+const uint16_t NET_DEFAULT_PORT = 6969;
+// NOTE: biggest UDP datagram that is guaranteed to go through the
+// loopback interface on all the platforms we care about
+const size_t NET_PACKET_CAPACITY = 60 * 1024;
+
+struct Net_Address
+{
+    uint32_t host;
+    uint16_t port;
+};
+
+bool operator==(Net_Address a, Net_Address b);
+
+Net_Address net_loopback_address(uint16_t port);
+
+struct Net_Socket
+{
+    Net_Socket_Handle handle;
+
+    void open(uint16_t port);
+    void close();
+    void send(Net_Address to, const void *data, size_t size);
+    // NOTE: never blocks. Returns {false} when there is nothing to receive.
+    Maybe<size_t> receive(Net_Address *from, void *data, size_t capacity);
+};
+
+void net_init();
+void net_quit();
+
+// PROTOCOL //////////////////////////////
+//
+// NOTE: Both sides of the connection are expected to be the same
+// build running on the same machine, so the packets are plain structs
+// without any byte order or padding conversions.
+
+enum Net_Packet_Type: uint8_t
+{
+    // Client -> Server
+    NET_PACKET_CONNECT = 0,
+    NET_PACKET_INPUT,
+    NET_PACKET_DISCONNECT,
+    // Server -> Client
+    NET_PACKET_WELCOME,
+    NET_PACKET_REJECT,
+    NET_PACKET_SNAPSHOT,
+};
+
+const uint8_t NET_BUTTON_LEFT  = 1 << 0;
+const uint8_t NET_BUTTON_RIGHT = 1 << 1;
+const uint8_t NET_BUTTON_JUMP  = 1 << 2;
+const uint8_t NET_BUTTON_SHOOT = 1 << 3;
+
+const uint32_t NET_NO_TICK = 0xFFFFFFFF;
+
+struct Net_Input
+{
+    // NOTE: the latest snapshot tick the client has received. The
+    // server delta compresses the next snapshots against it.
+    uint32_t ack_tick;
+    uint8_t buttons;
+    Vec2f aim;
+};
+
+struct Net_Input_Packet
+{
+    Net_Packet_Type type;
+    Net_Input input;
+};
+
+struct Net_Welcome_Packet
+{
+    Net_Packet_Type type;
+    uint32_t you;
+};
+
+struct Net_Entity
+{
+    uint8_t present;
+    uint8_t state;
+    uint8_t alive_state;
+    uint8_t jump_state;
+    int32_t lives;
+    Vec2f pos;
+    Vec2f vel;
+    Vec2f gun_dir;
+};
+
+const size_t NET_CHUNKS_CAPACITY = 4;
+const uint16_t NET_NO_CHUNK = 0xFFFF;
+
+struct Net_Chunk
+{
+    uint16_t x;
+    uint16_t y;
+    uint8_t tiles[TILE_CHUNK_SIZE][TILE_CHUNK_SIZE];
+};
+
+// NOTE: Net_World is the part of the Game a single client can see:
+// the entities and the tile chunks of the room it is in.
+struct Net_World
+{
+    uint32_t tick;
+    uint32_t you;
+    Net_Entity entities[ENTITIES_COUNT];
+    Net_Chunk chunks[NET_CHUNKS_CAPACITY];
+};
+
+struct Net_Snapshot_Header
+{
+    Net_Packet_Type type;
+    uint32_t tick;
+    uint32_t baseline_tick;
+};
+
+// NOTE: world is XORed with the baseline and the runs of zeros in
+// the result are run-length encoded. Returns the size of the output.
+size_t net_delta_encode(const Net_World *baseline, const Net_World *world,
+                        uint8_t *output, size_t capacity);
+bool net_delta_decode(const Net_World *baseline,
+                      const uint8_t *input, size_t size,
+                      Net_World *world);
+
+#endif  // SOMETHING_NET_HPP_
@@ -0,0 +1,219 @@
+#ifndef SOMETHING_PACK_HPP_
+#define SOMETHING_PACK_HPP_
+
+// NOTE: This file is shared between the game and pack_baker, the same
+// way something_parsers.hpp is shared with assets_typer. Both of them
+// must lay out the atlases identically, so the layout lives here.
+
+const size_t ASSETS_ATLASES_CAPACITY = 16;
+const int ASSETS_ATLAS_SIZE = 2048;
+const int ASSETS_ATLAS_PADDING = 1;
+
+struct Atlas_Slot
+{
+    size_t atlas;
+    SDL_Rect rect;
+    SDL_Rect mask_rect;
+};
+
+struct Atlas_Layout
+{
+    size_t atlases_count;
+    SDL_Point atlas_sizes[ASSETS_ATLASES_CAPACITY];
+};
+
+// NOTE: Shelf packing. The textures go from the tallest to the
+// shortest, each one takes a slot for itself and its mask. No page is
+// ever bigger than page_size. Returns the index of the texture that did
+// not fit into the atlases, if any.
+inline
+Maybe<size_t> layout_atlases(const SDL_Point *sizes, size_t count, SDL_Point page_size,
+                             Atlas_Slot *slots, Atlas_Layout *layout)
+{
+    *layout = {};
+
+    size_t *order = (size_t*) malloc(sizeof(*order) * (count + 1));
+    assert(order != NULL);
+    defer(free(order));
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = i;
+        for (size_t j = i; j > 0 && sizes[order[j - 1]].y < sizes[order[j]].y; --j) {
+            swap(&order[j - 1], &order[j]);
+        }
+    }
+
+    Maybe<size_t> shared_atlas = {};
+    SDL_Point shelf = {};
+    int shelf_height = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Atlas_Slot *slot = &slots[order[i]];
+        const int w = sizes[order[i]].x;
+        const int h = sizes[order[i]].y;
+        const int slot_w = 2 * (w + ASSETS_ATLAS_PADDING);
+        const int slot_h = h + ASSETS_ATLAS_PADDING;
+        const bool oversized = slot_w > page_size.x || slot_h > page_size.y;
+
+        if (!oversized && shared_atlas.has_value && shelf.x + slot_w > page_size.x) {
+            shelf.x = 0;
+            shelf.y += shelf_height;
+            shelf_height = 0;
+        }
+
+        if (oversized || !shared_atlas.has_value || shelf.y + slot_h > page_size.y) {
+            if (layout->atlases_count >= ASSETS_ATLASES_CAPACITY) {
+                return {true, order[i]};
+            }
+
+            layout->atlas_sizes[layout->atlases_count] = {};
+            if (oversized) {
+                // NOTE: the texture and its mask do not fit next to each
+                // other into a page, so the texture gets a page of its
+                // own with the mask below it and the current shelf stays
+                // as it is. The page can't be bigger than page_size,
+                // that's what the renderer is able to create.
+                const int stacked_w = w + ASSETS_ATLAS_PADDING;
+                const int stacked_h = 2 * (h + ASSETS_ATLAS_PADDING);
+                if (stacked_w > page_size.x || stacked_h > page_size.y) {
+                    return {true, order[i]};
+                }
+
+                slot->atlas = layout->atlases_count;
+                slot->rect = {0, 0, w, h};
+                slot->mask_rect = {0, h + ASSETS_ATLAS_PADDING, w, h};
+                layout->atlas_sizes[layout->atlases_count] = {stacked_w, stacked_h};
+                layout->atlases_count += 1;
+                continue;
+            }
+
+            shared_atlas = {true, layout->atlases_count};
+            layout->atlases_count += 1;
+            shelf = {};
+            shelf_height = 0;
+        }
+
+        SDL_Point *atlas_size = &layout->atlas_sizes[shared_atlas.unwrap];
+        slot->atlas = shared_atlas.unwrap;
+        slot->rect = {shelf.x, shelf.y, w, h};
+        slot->mask_rect = {shelf.x + w + ASSETS_ATLAS_PADDING, shelf.y, w, h};
+        atlas_size->x = max(atlas_size->x, shelf.x + slot_w);
+        atlas_size->y = max(atlas_size->y, shelf.y + slot_h);
+
+        shelf.x += slot_w;
+        shelf_height = max(shelf_height, slot_h);
+    }
+
+    return {};
+}
+
+// NOTE: the pixels are RGBA32, the mask keeps only the alpha of the
+// source and makes the color white, so it can be tinted with the
+// color mod
+inline
+void blit_into_atlas(void *atlas_pixels, int atlas_pitch,
+                     const void *pixels, int pitch, int w, int h,
+                     SDL_Rect rect, bool mask)
+{
+    for (int row = 0; row < h; ++row) {
+        const uint32_t *src_row = (const uint32_t*) ((const uint8_t *) pixels + row * pitch);
+        uint32_t *dst_row = (uint32_t*) ((uint8_t *) atlas_pixels + (rect.y + row) * atlas_pitch) + rect.x;
+        for (int col = 0; col < w; ++col) {
+            dst_row[col] = mask ? src_row[col] | 0x00FFFFFF : src_row[col];
+        }
+    }
+}
+
+// NOTE: Layout of the release data pack built by pack_baker:
+//
+//   Pack_Header
+//   Pack_Atlas   [atlases_count]
+//   Pack_Texture [textures_count]
+//   Pack_Sound   [sounds_count]
+//   Pack_Frames  [framesen_count]
+//   Pack_Sprite  [sprites_count]
+//   strings      (ids and paths, not NULL-terminated)
+//   atlas pixels (RGBA32 with the masks already in place)
+//   sound samples (signed 16 bit in the mixer's format)
+//
+// Every table and blob starts at a multiple of PACK_ALIGNMENT from the
+// beginning of the file, so the game uses them right from the mapped
+// memory. The numbers are in the byte order of the machine that baked
+// the pack, which is the machine the release is built on.
+const char PACK_MAGIC[8] = {'S', 'M', 'T', 'H', 'P', 'A', 'C', 'K'};
+const uint32_t PACK_VERSION = 2;
+const uint64_t PACK_ALIGNMENT = 64;
+
+struct Pack_String
+{
+    uint32_t offset;
+    uint32_t count;
+};
+
+struct Pack_Blob
+{
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct Pack_Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t atlases_count;
+    uint32_t textures_count;
+    uint32_t sounds_count;
+    uint32_t framesen_count;
+    uint32_t sprites_count;
+    Pack_Blob atlases;
+    Pack_Blob textures;
+    Pack_Blob sounds;
+    Pack_Blob framesen;
+    Pack_Blob sprites;
+    Pack_Blob strings;
+};
+
+struct Pack_Atlas
+{
+    int32_t w;
+    int32_t h;
+    int32_t pitch;
+    uint32_t reserved;
+    Pack_Blob pixels;
+};
+
+struct Pack_Texture
+{
+    Pack_String id;
+    Pack_String path;
+    uint32_t atlas;
+    int32_t rect[4];
+    int32_t mask_rect[4];
+};
+
+struct Pack_Sound
+{
+    Pack_String id;
+    Pack_String path;
+    // NOTE: in bytes, same as SDL_LoadWAV
+    Pack_Blob samples;
+};
+
+struct Pack_Frames
+{
+    Pack_String id;
+    Pack_String path;
+    uint32_t sprites_offset;
+    uint32_t sprites_count;
+    // NOTE: in seconds
+    float duration;
+};
+
+// NOTE: laid out the same way as Sprite on the machines where size_t
+// is 64 bits, so the game uses the frame table of the pack as it is
+// (see PACK_SPRITE_IS_SPRITE in something_assets.cpp)
+struct Pack_Sprite
+{
+    int32_t srcrect[4];
+    uint64_t texture_index;
+};
+
+#endif  // SOMETHING_PACK_HPP_
@@ -49,6 +49,160 @@ Config_Parse_Result parse_vars_conf(String_View input, F f)
     return parse_success();
 }
 
-// TODO(#290): add animat files parser to something_parsers.hpp
+// NOTE: FNV-1a of an asset id with a seed. assets_typer searches for
+// the seed that gives every id of a kind of assets its own slot in the
+// generated table, so the lookups at runtime are a single probe.
+inline
+uint32_t asset_id_hash(String_View id, uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; i < id.count; ++i) {
+        hash ^= (uint8_t) id.data[i];
+        hash *= 16777619u;
+    }
+
+    // NOTE: the table is indexed by the low bits, and the low bits of
+    // FNV-1a depend only on the low bits of the seed, so the high
+    // bits are folded into them
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+// NOTE: 64 bit FNV-1a of arbitrary bytes, for the contents that are
+// looked up or compared by their hash (text runs, files)
+inline
+uint64_t fnv1a_64(const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t*) data;
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+enum Animat_Key
+{
+    ANIMAT_KEY_TEXTURE = 0,
+    ANIMAT_KEY_COUNT,
+    ANIMAT_KEY_DURATION,
+    ANIMAT_KEY_FRAME_X,
+    ANIMAT_KEY_FRAME_Y,
+    ANIMAT_KEY_FRAME_W,
+    ANIMAT_KEY_FRAME_H,
+};
+
+struct Animat_Entry
+{
+    Animat_Key key;
+    // NOTE: set only for ANIMAT_KEY_TEXTURE
+    String_View texture;
+    // NOTE: set only for ANIMAT_KEY_FRAME_*
+    size_t frame_index;
+    int value;
+};
+
+// NOTE: Format of the animat files:
+//   texture = TEXTURE_ID
+//   count = FRAMES_COUNT
+//   duration = MILLISECONDS
+//   frames.INDEX.{x,y,w,h} = PIXELS
+// The structure of the file (numbers, known keys, the frame index
+// being within the count, the texture coming before the frames) is
+// checked here, resolving the texture id is up to the caller.
+template <typename F>
+Config_Parse_Result parse_animat_file(String_View input, F f)
+{
+    bool has_count = false;
+    bool has_texture = false;
+    size_t count = 0;
+
+    for (size_t line_number = 1; input.count != 0; ++line_number) {
+        auto value = input.chop_by_delim('\n');
+        auto key = value.chop_by_delim('=').trim();
+        if (key.count == 0 || *key.data == '#') continue;
+        value = value.trim();
+
+        auto subkey = key.chop_by_delim('.').trim();
+
+        Animat_Entry entry = {};
+        if (subkey == "count"_sv) {
+            if (has_count) {
+                return parse_failure("`count` provided twice", line_number);
+            }
+
+            auto count_result = value.as_integer<int>();
+            if (!count_result.has_value || count_result.unwrap < 0) {
+                return parse_failure("`count` is not a number", line_number);
+            }
+
+            has_count = true;
+            count = (size_t) count_result.unwrap;
+            entry.key = ANIMAT_KEY_COUNT;
+            entry.value = count_result.unwrap;
+        } else if (subkey == "texture"_sv) {
+            has_texture = true;
+            entry.key = ANIMAT_KEY_TEXTURE;
+            entry.texture = value;
+        } else if (subkey == "duration"_sv) {
+            auto result = value.as_integer<int>();
+            if (!result.has_value) {
+                return parse_failure("`duration` is not a number", line_number);
+            }
+
+            entry.key = ANIMAT_KEY_DURATION;
+            entry.value = result.unwrap;
+        } else if (subkey == "frames"_sv) {
+            auto result = key.chop_by_delim('.').trim().as_integer<int>();
+            if (!result.has_value || result.unwrap < 0) {
+                return parse_failure("frame index is not a number", line_number);
+            }
+
+            entry.frame_index = (size_t) result.unwrap;
+            if (entry.frame_index >= count) {
+                return parse_failure("frame index is bigger than the `count`", line_number);
+            }
+
+            if (!has_texture) {
+                return parse_failure("spritesheet was not loaded", line_number);
+            }
+
+            subkey = key.chop_by_delim('.').trim();
+            if (key.count != 0) {
+                return parse_failure("unknown subkey", line_number);
+            }
+
+            auto result_value = value.as_integer<int>();
+            if (!result_value.has_value) {
+                return parse_failure("value is not a number", line_number);
+            }
+            entry.value = result_value.unwrap;
+
+            if (subkey == "x"_sv) {
+                entry.key = ANIMAT_KEY_FRAME_X;
+            } else if (subkey == "y"_sv) {
+                entry.key = ANIMAT_KEY_FRAME_Y;
+            } else if (subkey == "w"_sv) {
+                entry.key = ANIMAT_KEY_FRAME_W;
+            } else if (subkey == "h"_sv) {
+                entry.key = ANIMAT_KEY_FRAME_H;
+            } else {
+                return parse_failure("unknown subkey", line_number);
+            }
+        } else {
+            return parse_failure("unknown subkey", line_number);
+        }
+
+        auto result = f(line_number, entry);
+        if (result.is_error) {
+            return result;
+        }
+    }
+
+    return parse_success();
+}
 
 #endif  // SEPARATE_FILE_HPP_
@@ -1,19 +1,26 @@
 #include "something_color.hpp"
 #include "something_particles.hpp"
 
-void Particles::render(SDL_Renderer *renderer, Camera camera) const
+void Particle_Snapshot::render(Sprite_Batch *batch, Camera camera) const
 {
-    for (size_t i = 0; i < count; ++i) {
+    batch->fill_rect(SPRITE_LAYER_PARTICLES, camera.to_screen(rect), color);
+}
+
+size_t Particles::snapshot(Particle_Snapshot *output, size_t capacity, Rectf view) const
+{
+    size_t output_count = 0;
+    for (size_t i = 0; i < count && output_count < capacity; ++i) {
         const size_t j = (begin + i) % PARTICLES_CAPACITY;
-        if (lifetimes[j] > 0.0f) {
-            const Rectf particle = rect(
+        if (lifetimes[j] > 0.0f && rect_contains_vec2(view, positions[j])) {
+            const auto opacity = lifetimes[j] / PARTICLE_LIFETIME;
+            output[output_count].rect = rect(
                 positions[j] - vec2(sizes[j], sizes[j]) * 0.5f,
                 sizes[j], sizes[j]);
-            const auto opacity = lifetimes[j] / PARTICLE_LIFETIME;
-            fill_rect(renderer, camera.to_screen(particle),
-                      {colors[j].r, colors[j].g, colors[j].b, colors[j].a * opacity});
+            output[output_count].color = {colors[j].r, colors[j].g, colors[j].b, colors[j].a * opacity};
+            output_count += 1;
         }
     }
+    return output_count;
 }
 
 
@@ -3,6 +3,14 @@
 
 const size_t PARTICLES_CAPACITY = 1024;
 
+struct Particle_Snapshot
+{
+    Rectf rect;
+    RGBA color;
+
+    void render(Sprite_Batch *batch, Camera camera) const;
+};
+
 struct Particles
 {
     enum State
@@ -24,7 +32,7 @@ struct Particles
     size_t begin;
     size_t count;
 
-    void render(SDL_Renderer *renderer, Camera camera) const;
+    size_t snapshot(Particle_Snapshot *output, size_t capacity, Rectf view) const;
     void update(float dt, Tile_Grid *grid);
     void push(float impact);
     void pop();
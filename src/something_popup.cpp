@@ -20,7 +20,7 @@ Vec2f shadow_offset_dir(float ratio)
     return vec2((float) FONT_POPUP_SIZE * ratio, (float) FONT_POPUP_SIZE * ratio);
 }
 
-void Popup::render(SDL_Renderer *renderer)
+void Popup::render(SDL_Renderer *renderer) const
 {
     if (buffer_size > 0 && a > 1e-6) {
         const auto font_size = vec2(FONT_POPUP_SIZE, FONT_POPUP_SIZE);
@@ -37,7 +37,7 @@ void Popup::render(SDL_Renderer *renderer)
 
         // TEXT   //////////////////////////////
         RGBA front_color = color;
-        color.a          = alpha;
+        front_color.a    = alpha;
         font.render(renderer, position, font_size, front_color, buffer);
     }
 }
@@ -12,7 +12,7 @@ struct Popup
     float a;
 
     void notify(RGBA color, const char *format, ...);
-    void render(SDL_Renderer *renderer);
+    void render(SDL_Renderer *renderer) const;
     void update(float delta_time);
 };
 
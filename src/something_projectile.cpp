@@ -23,12 +23,13 @@ void Projectile::kill()
 const float PROJECTILE_WIDTH  = 40.0f;
 const float PROJECTILE_HEIGHT = 40.0f;
 
-void Projectile::render(SDL_Renderer *renderer, Camera *camera)
+void Projectile::render(Sprite_Batch *batch, Camera *camera) const
 {
     switch (state) {
     case Projectile_State::Active: {
         active_animat.render(
-            renderer,
+            batch,
+            SPRITE_LAYER_PROJECTILES,
             camera->to_screen(pos),
             SDL_FLIP_NONE,
             {0, 0, 0, 0},
@@ -37,7 +38,8 @@ void Projectile::render(SDL_Renderer *renderer, Camera *camera)
 
     case Projectile_State::Poof: {
         poof_animat.render(
-            renderer,
+            batch,
+            SPRITE_LAYER_PROJECTILES,
             camera->to_screen(pos),
             SDL_FLIP_NONE,
             {0, 0, 0, 0},
@@ -81,6 +83,7 @@ void Projectile::update(float dt, Tile_Grid *grid)
         auto tile = grid->tile_at_abs(pos);
         if (tile && tile_defs[*tile].is_collidable) {
             damage_tile(tile);
+            grid->mark_tile_changed(grid->abs_to_tile_coord(pos));
             kill();
         }
 
@@ -102,7 +105,7 @@ void Projectile::update(float dt, Tile_Grid *grid)
     }
 }
 
-Rectf Projectile::hitbox()
+Rectf Projectile::hitbox() const
 {
     return Rectf {
         this->pos.x - PROJECTILE_HITBOX_WIDTH * 0.5f,
@@ -112,6 +115,18 @@ Rectf Projectile::hitbox()
     };
 }
 
+const float PROJECTILE_TRACKING_PADDING = 50.0f;
+
+Rectf Projectile::tracking_hitbox() const
+{
+    return Rectf {
+        pos.x - PROJECTILE_TRACKING_PADDING * 0.5f,
+        pos.y - PROJECTILE_TRACKING_PADDING * 0.5f,
+        PROJECTILE_TRACKING_PADDING,
+        PROJECTILE_TRACKING_PADDING
+    };
+}
+
 Projectile water_projectile(Vec2f pos, Vec2f vel, Entity_Index shooter)
 {
     Projectile result = {};
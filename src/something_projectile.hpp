@@ -39,10 +39,11 @@ struct Projectile
     float lifetime;
 
     void damage_tile(Tile *tile);
-    void render(SDL_Renderer *renderer, Camera *camera);
+    void render(Sprite_Batch *batch, Camera *camera) const;
     void update(float dt, Tile_Grid *grid);
     void kill();
-    Rectf hitbox();
+    Rectf hitbox() const;
+    Rectf tracking_hitbox() const;
 };
 
 Projectile rock_projectile(Vec2f pos, Vec2f vel, Entity_Index shooter);
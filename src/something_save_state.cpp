@@ -0,0 +1,295 @@
+#include "something_game.hpp"
+#include "something_save_state.hpp"
+
+// NOTE: Entity::particles is the last field of the Entity and it is
+// purely cosmetic, so it is not saved. Everything before it is saved
+// as is.
+const size_t ENTITY_SAVED_SIZE = offsetof(Entity, particles);
+
+struct Save_State_Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entity_size;
+    uint32_t projectile_size;
+    uint32_t item_size;
+    uint32_t entities_count;
+    uint32_t projectiles_count;
+    uint32_t items_count;
+    uint32_t tile_chunk_size;
+};
+
+Save_State_Header current_save_state_header()
+{
+    Save_State_Header header = {};
+    header.magic = SAVE_STATE_MAGIC;
+    header.version = SAVE_STATE_VERSION;
+    header.entity_size = (uint32_t) ENTITY_SAVED_SIZE;
+    header.projectile_size = (uint32_t) sizeof(Projectile);
+    header.item_size = (uint32_t) sizeof(Item);
+    header.entities_count = (uint32_t) ENTITIES_COUNT;
+    header.projectiles_count = (uint32_t) PROJECTILES_COUNT;
+    header.items_count = (uint32_t) ITEMS_COUNT;
+    header.tile_chunk_size = (uint32_t) TILE_CHUNK_SIZE;
+    return header;
+}
+
+void Save_State::clear()
+{
+    bytes.size = 0;
+}
+
+void Save_State::write_bytes(const void *data, size_t size)
+{
+    while (bytes.size + size > bytes.capacity) {
+        bytes.expand_capacity();
+    }
+    bytes.concat((const char *) data, size);
+}
+
+bool Save_State_Reader::read_bytes(void *data, size_t size)
+{
+    if (input.count < size) {
+        return false;
+    }
+
+    if (data) {
+        memcpy(data, input.data, size);
+    }
+    input.chop(size);
+    return true;
+}
+
+void save_game_state(Game *game, Save_State *state)
+{
+    state->clear();
+    state->write(current_save_state_header());
+
+    state->write(game->camera);
+    state->write(random_state);
+    state->write(game->ai_tick);
+
+    state->write((uint32_t) game->camera_locks_count);
+    state->write_bytes(game->camera_locks, sizeof(game->camera_locks[0]) * game->camera_locks_count);
+
+    for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
+        state->write_bytes(&game->entities[i], ENTITY_SAVED_SIZE);
+    }
+    state->write(game->projectiles);
+    state->write(game->items);
+
+    uint32_t chunks_count = 0;
+    for (size_t cy = 0; cy < TILE_CHUNKS_HEIGHT; ++cy) {
+        for (size_t cx = 0; cx < TILE_CHUNKS_WIDTH; ++cx) {
+            chunks_count += game->grid.dirty_chunks[cy][cx];
+        }
+    }
+
+    state->write(chunks_count);
+    for (size_t cy = 0; cy < TILE_CHUNKS_HEIGHT; ++cy) {
+        for (size_t cx = 0; cx < TILE_CHUNKS_WIDTH; ++cx) {
+            if (game->grid.dirty_chunks[cy][cx]) {
+                state->write((uint32_t) cx);
+                state->write((uint32_t) cy);
+                for (int y = 0; y < TILE_CHUNK_SIZE; ++y) {
+                    state->write_bytes(
+                        &game->grid.tiles[cy * TILE_CHUNK_SIZE + y][cx * TILE_CHUNK_SIZE],
+                        sizeof(Tile) * TILE_CHUNK_SIZE);
+                }
+            }
+        }
+    }
+}
+
+// NOTE: the state is read as raw bytes, so every enum and index in it
+// is checked before any of it reaches the Game. A corrupted state
+// would otherwise index the assets or the tile defs out of bounds.
+static bool frames_index_is_valid(Frames_Index index)
+{
+    return index.unwrap < assets.framesen_count;
+}
+
+static bool sample_index_is_valid(Sample_S16_Index index)
+{
+    return index.unwrap < assets.sounds_count;
+}
+
+static const char *validate_projectile(const Projectile *projectile)
+{
+    if ((size_t) projectile->state > (size_t) Projectile_State::Poof) return "unknown projectile state";
+    if ((size_t) projectile->kind > (size_t) Projectile_Kind::Water) return "unknown projectile kind";
+    if ((size_t) projectile->tile_damage > (size_t) Tile_Damage::Ice) return "unknown projectile tile damage";
+    if (projectile->shooter.unwrap >= ENTITIES_COUNT) return "projectile shooter is out of bounds";
+    if (!frames_index_is_valid(projectile->active_animat.frames_index) ||
+        !frames_index_is_valid(projectile->poof_animat.frames_index)) {
+        return "projectile animat is out of bounds";
+    }
+    return NULL;
+}
+
+static const char *validate_weapon(const Weapon *weapon)
+{
+    if ((size_t) weapon->type > (size_t) Weapon_Type::Placer) return "unknown weapon type";
+    if (weapon->placer.tile >= TILE_COUNT) return "weapon places an unknown tile";
+    if (weapon->shoot_sample.has_value && !sample_index_is_valid(weapon->shoot_sample.unwrap)) {
+        return "weapon sample is out of bounds";
+    }
+    return validate_projectile(&weapon->gun.projectile);
+}
+
+static const char *validate_entity(const Entity *entity)
+{
+    if ((size_t) entity->state > (size_t) Entity_State::Poof) return "unknown entity state";
+    if ((size_t) entity->alive_state > (size_t) Alive_State::Walking) return "unknown entity alive state";
+    if ((size_t) entity->jump_state > (size_t) Jump_State::Jump) return "unknown entity jump state";
+    if ((size_t) entity->walking_direction > (size_t) Entity::Left) return "unknown entity direction";
+
+    if (entity->weapon_slots_count > WEAPON_SLOTS_CAPACITY) return "too many weapon slots";
+    if (entity->weapon_slots_count > 0 && entity->weapon_current >= entity->weapon_slots_count) {
+        return "current weapon is out of bounds";
+    }
+    for (size_t i = 0; i < entity->weapon_slots_count; ++i) {
+        const char *error = validate_weapon(&entity->weapon_slots[i]);
+        if (error) return error;
+    }
+
+    if (!frames_index_is_valid(entity->idle.frames_index) ||
+        !frames_index_is_valid(entity->walking.frames_index)) {
+        return "entity animat is out of bounds";
+    }
+    for (size_t i = 0; i < JUMP_SAMPLES_CAPACITY; ++i) {
+        if (!sample_index_is_valid(entity->jump_samples[i])) return "entity sample is out of bounds";
+    }
+    return NULL;
+}
+
+static const char *validate_item(const Item *item)
+{
+    if ((size_t) item->type > (size_t) ITEM_ICE_BLOCK) return "unknown item type";
+    if (item->sprite.texture_index.unwrap >= assets.textures_count) return "item sprite is out of bounds";
+    if (!sample_index_is_valid(item->sound)) return "item sample is out of bounds";
+    return NULL;
+}
+
+// NOTE: the Entity is too big for the stack because of the particles
+static Entity save_state_entity = {};
+
+// NOTE: When game is NULL the state is only validated.
+static const char *parse_game_state(Game *game, String_View state)
+{
+    Save_State_Reader reader = {state};
+
+    Save_State_Header header = {};
+    if (!reader.read(&header)) return "state is too small";
+    if (header.magic != SAVE_STATE_MAGIC) return "not a save state";
+    if (header.version != SAVE_STATE_VERSION) return "unsupported save state version";
+
+    const Save_State_Header expected = current_save_state_header();
+    if (memcmp(&header, &expected, sizeof(header)) != 0) {
+        return "save state was made by an incompatible build";
+    }
+
+    if (!reader.read(game ? &game->camera : NULL)) return "unexpected end of state";
+    if (!reader.read(game ? &random_state : NULL)) return "unexpected end of state";
+    if (!reader.read(game ? &game->ai_tick : NULL)) return "unexpected end of state";
+
+    uint32_t camera_locks_count = 0;
+    if (!reader.read(&camera_locks_count)) return "unexpected end of state";
+    if (camera_locks_count > CAMERA_LOCKS_CAPACITY) return "too many camera locks";
+    if (game) game->camera_locks_count = camera_locks_count;
+    if (!reader.read_bytes(game ? game->camera_locks : NULL,
+                           sizeof(Recti) * camera_locks_count)) {
+        return "unexpected end of state";
+    }
+    if (game) game->camera_locks_generation += 1;
+
+    for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
+        if (game) {
+            if (!reader.read_bytes(&game->entities[i], ENTITY_SAVED_SIZE)) return "unexpected end of state";
+            game->entities[i].particles.count = 0;
+        } else {
+            if (!reader.read_bytes(&save_state_entity, ENTITY_SAVED_SIZE)) return "unexpected end of state";
+            const char *error = validate_entity(&save_state_entity);
+            if (error) return error;
+        }
+    }
+
+    for (size_t i = 0; i < PROJECTILES_COUNT; ++i) {
+        Projectile projectile = {};
+        if (!reader.read(&projectile)) return "unexpected end of state";
+        if (game) {
+            game->projectiles[i] = projectile;
+        } else {
+            const char *error = validate_projectile(&projectile);
+            if (error) return error;
+        }
+    }
+
+    for (size_t i = 0; i < ITEMS_COUNT; ++i) {
+        Item item = {};
+        if (!reader.read(&item)) return "unexpected end of state";
+        if (game) {
+            game->items[i] = item;
+        } else {
+            const char *error = validate_item(&item);
+            if (error) return error;
+        }
+    }
+
+    uint32_t chunks_count = 0;
+    if (!reader.read(&chunks_count)) return "unexpected end of state";
+
+    if (game) {
+        // NOTE: chunks that were modified after the state was saved
+        // have to be cleaned up before the saved ones are restored.
+        for (size_t cy = 0; cy < TILE_CHUNKS_HEIGHT; ++cy) {
+            for (size_t cx = 0; cx < TILE_CHUNKS_WIDTH; ++cx) {
+                if (game->grid.dirty_chunks[cy][cx]) {
+                    for (int y = 0; y < TILE_CHUNK_SIZE; ++y) {
+                        memset(&game->grid.tiles[cy * TILE_CHUNK_SIZE + y][cx * TILE_CHUNK_SIZE],
+                               0, sizeof(Tile) * TILE_CHUNK_SIZE);
+                    }
+                    game->grid.dirty_chunks[cy][cx] = false;
+                }
+            }
+        }
+
+        game->grid.mark_all_tiles_changed();
+    }
+
+    for (uint32_t i = 0; i < chunks_count; ++i) {
+        uint32_t cx = 0;
+        uint32_t cy = 0;
+        if (!reader.read(&cx) || !reader.read(&cy)) return "unexpected end of state";
+        if (cx >= TILE_CHUNKS_WIDTH || cy >= TILE_CHUNKS_HEIGHT) return "tile chunk is out of bounds";
+
+        for (int y = 0; y < TILE_CHUNK_SIZE; ++y) {
+            Tile row[TILE_CHUNK_SIZE] = {};
+            if (!reader.read(&row)) return "unexpected end of state";
+            for (int x = 0; x < TILE_CHUNK_SIZE; ++x) {
+                if (row[x] >= TILE_COUNT) return "unknown tile";
+            }
+            if (game) {
+                memcpy(&game->grid.tiles[cy * TILE_CHUNK_SIZE + y][cx * TILE_CHUNK_SIZE], row, sizeof(row));
+            }
+        }
+
+        if (game) game->grid.dirty_chunks[cy][cx] = true;
+    }
+
+    if (reader.input.count > 0) return "unexpected data at the end of state";
+
+    if (game) game->tracking_projectile = {};
+
+    return NULL;
+}
+
+const char *load_game_state(Game *game, String_View state)
+{
+    const char *error = parse_game_state(NULL, state);
+    if (error) {
+        return error;
+    }
+
+    return parse_game_state(game, state);
+}
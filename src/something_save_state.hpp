@@ -0,0 +1,49 @@
+#ifndef SOMETHING_SAVE_STATE_HPP_
+#define SOMETHING_SAVE_STATE_HPP_
+
+// NOTE: "SMSV" in little endian
+const uint32_t SAVE_STATE_MAGIC = 0x56534D53;
+// NOTE: bump it every time the layout of the save state changes
+const uint32_t SAVE_STATE_VERSION = 2;
+
+// NOTE: Save_State is a versioned binary blob of the simulation part
+// of the Game: entities, projectiles, items, modified tile chunks,
+// camera, camera locks and the state of the random generator. Things
+// like the console, the popup or the particles are not saved. The
+// bytes are reused between saves, so saving into the same Save_State
+// repeatedly (e.g. for rewinding) does not allocate.
+struct Save_State
+{
+    Dynamic_Array<char> bytes;
+
+    void clear();
+    void write_bytes(const void *data, size_t size);
+
+    template <typename T>
+    void write(const T &x)
+    {
+        write_bytes(&x, sizeof(x));
+    }
+};
+
+struct Save_State_Reader
+{
+    String_View input;
+
+    bool read_bytes(void *data, size_t size);
+
+    template <typename T>
+    bool read(T *x)
+    {
+        return read_bytes(x, sizeof(*x));
+    }
+};
+
+struct Game;
+
+void save_game_state(Game *game, Save_State *state);
+// NOTE: returns NULL on success, otherwise the reason why the state
+// could not be loaded. The Game is not modified in case of an error.
+const char *load_game_state(Game *game, String_View state);
+
+#endif  // SOMETHING_SAVE_STATE_HPP_
@@ -1,8 +1,21 @@
 #include "something_select_popup.hpp"
 
 // TODO(#169): Select_Popup does not handle well out of the screen rendering
-void Select_Popup::render(SDL_Renderer *renderer, Bitmap_Font *font, Vec2f pos)
+static float select_popup_item_height()
 {
+    return BITMAP_FONT_CHAR_HEIGHT * SELECT_POPUP_FONT_SIZE + SELECT_POPUP_PAD * 2;
+}
+
+bool Select_Popup::flips_at(Vec2f pos) const
+{
+    pos.y -= SELECT_POPUP_PAD;
+    return pos.y + items_size * select_popup_item_height() > SCREEN_HEIGHT;
+}
+
+void Select_Popup::render(SDL_Renderer *renderer, Bitmap_Font *font, Vec2f pos) const
+{
+    const bool flipped = flips_at(pos);
+
     pos.y -= SELECT_POPUP_PAD; // To align baseline of first item in Select_Popup to already typed text in console
     size_t longest_length = 0;
     for (size_t i = 0; i < items_size; ++i) {
@@ -10,10 +23,9 @@ void Select_Popup::render(SDL_Renderer *renderer, Bitmap_Font *font, Vec2f pos)
     }
 
     const float popup_width = longest_length * BITMAP_FONT_CHAR_WIDTH * SELECT_POPUP_FONT_SIZE + SELECT_POPUP_PAD * 2;
-    const float item_height = BITMAP_FONT_CHAR_HEIGHT * SELECT_POPUP_FONT_SIZE + SELECT_POPUP_PAD * 2;
+    const float item_height = select_popup_item_height();
     const float popup_height = items_size * item_height;
 
-    flipped = pos.y + popup_height > SCREEN_HEIGHT;
     if(flipped) {
         pos.y -= popup_height - BITMAP_FONT_CHAR_HEIGHT * CONSOLE_FONT_SIZE - SELECT_POPUP_PAD * 2;
     }
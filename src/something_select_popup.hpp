@@ -10,7 +10,8 @@ struct Select_Popup
     size_t items_cursor;
     bool flipped;
 
-    void render(SDL_Renderer *renderer, Bitmap_Font *font, Vec2f pos);
+    void render(SDL_Renderer *renderer, Bitmap_Font *font, Vec2f pos) const;
+    bool flips_at(Vec2f pos) const;
     void update(float dt);
 
     void up();
@@ -0,0 +1,623 @@
+#include "something_server.hpp"
+#include "something_net.hpp"
+
+// NOTE: how many of the last sent snapshots are remembered for each
+// client. Acknowledgements older than that fall back to full
+// (non-delta) snapshots.
+const size_t NET_HISTORY_CAPACITY = 32;
+const float NET_CLIENT_TIMEOUT = 5.0f;
+const float NET_CONNECT_TIMEOUT = 5.0f;
+const float NET_CONNECT_RETRY = 0.1f;
+const float NET_DEFAULT_BOT_SECONDS = 10.0f;
+
+static uint16_t parse_port(Args *args)
+{
+    if (args->empty()) {
+        return NET_DEFAULT_PORT;
+    }
+
+    const char *arg = args->shift();
+    auto port = cstr_as_string_view(arg).as_integer<int>();
+    if (!port.has_value || port.unwrap <= 0 || port.unwrap > 65535) {
+        println(stderr, "ERROR: `", arg, "` is not a valid port");
+        exit(1);
+    }
+
+    return (uint16_t) port.unwrap;
+}
+
+static Maybe<float> parse_seconds(Args *args)
+{
+    if (args->empty()) {
+        return {};
+    }
+
+    const char *arg = args->shift();
+    auto seconds = cstr_as_string_view(arg).as_integer<int>();
+    if (!seconds.has_value || seconds.unwrap <= 0) {
+        println(stderr, "ERROR: `", arg, "` is not a valid amount of seconds");
+        exit(1);
+    }
+
+    return {true, (float) seconds.unwrap};
+}
+
+// NOTE: The server never shows anything, but the assets still have to
+// be loaded for the animations and tile definitions, and loading them
+// requires an SDL_Renderer.
+static SDL_Renderer *create_headless_renderer()
+{
+    SDL_Surface *surface = sec(SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_RGBA32));
+    return sec(SDL_CreateSoftwareRenderer(surface));
+}
+
+static float seconds_since(Uint64 begin)
+{
+    return (float) (SDL_GetPerformanceCounter() - begin) / (float) SDL_GetPerformanceFrequency();
+}
+
+// SERVER //////////////////////////////
+
+struct Server_Client
+{
+    bool connected;
+    Net_Address address;
+    Net_Input input;
+    Net_Input prev_input;
+    float silence;
+    Net_World history[NET_HISTORY_CAPACITY];
+};
+
+struct Server_Metrics
+{
+    size_t ticks;
+    float tick_time_total;
+    float tick_time_max;
+    size_t bytes_sent;
+    size_t bytes_received;
+    size_t snapshots_sent;
+    size_t full_snapshots_sent;
+};
+
+struct Server
+{
+    Game *game;
+    Net_Socket socket;
+    uint32_t tick;
+    Server_Client clients[PLAYERS_CAPACITY];
+    Server_Metrics metrics;
+    uint8_t packet[NET_PACKET_CAPACITY];
+
+    void receive_packets();
+    void handle_packet(Net_Address from, const uint8_t *data, size_t size);
+    void spawn_player(size_t index);
+    void drop_client(size_t index);
+    void apply_inputs();
+    void collect_world(size_t index, Net_World *world);
+    void send_snapshots();
+    void check_timeouts(float dt);
+    void report_metrics(float seconds);
+};
+
+void Server::receive_packets()
+{
+    Net_Address from = {};
+    for (auto n = socket.receive(&from, packet, NET_PACKET_CAPACITY);
+         n.has_value;
+         n = socket.receive(&from, packet, NET_PACKET_CAPACITY))
+    {
+        metrics.bytes_received += n.unwrap;
+        handle_packet(from, packet, n.unwrap);
+    }
+}
+
+void Server::handle_packet(Net_Address from, const uint8_t *data, size_t size)
+{
+    if (size < 1) return;
+
+    Maybe<size_t> client = {};
+    for (size_t i = 0; i < PLAYERS_CAPACITY; ++i) {
+        if (clients[i].connected && clients[i].address == from) {
+            client = {true, i};
+        }
+    }
+
+    switch ((Net_Packet_Type) data[0]) {
+    case NET_PACKET_CONNECT: {
+        if (!client.has_value) {
+            for (size_t i = 0; i < PLAYERS_CAPACITY && !client.has_value; ++i) {
+                if (!clients[i].connected) {
+                    client = {true, i};
+                }
+            }
+
+            if (!client.has_value) {
+                const Net_Packet_Type reject = NET_PACKET_REJECT;
+                socket.send(from, &reject, sizeof(reject));
+                return;
+            }
+
+            Server_Client *new_client = &clients[client.unwrap];
+            *new_client = {};
+            new_client->connected = true;
+            new_client->address = from;
+            new_client->input.ack_tick = NET_NO_TICK;
+            for (size_t i = 0; i < NET_HISTORY_CAPACITY; ++i) {
+                new_client->history[i].tick = NET_NO_TICK;
+            }
+            spawn_player(client.unwrap);
+
+            println(stdout, "[SERVER] Client ", client.unwrap, " connected from port ", from.port);
+        }
+
+        Net_Welcome_Packet welcome = {};
+        welcome.type = NET_PACKET_WELCOME;
+        welcome.you = (uint32_t) client.unwrap;
+        socket.send(from, &welcome, sizeof(welcome));
+    } break;
+
+    case NET_PACKET_INPUT: {
+        if (client.has_value && size == sizeof(Net_Input_Packet)) {
+            Net_Input_Packet input = {};
+            memcpy(&input, data, sizeof(input));
+            clients[client.unwrap].input = input.input;
+            clients[client.unwrap].silence = 0.0f;
+        }
+    } break;
+
+    case NET_PACKET_DISCONNECT: {
+        if (client.has_value) {
+            drop_client(client.unwrap);
+        }
+    } break;
+
+    case NET_PACKET_WELCOME:
+    case NET_PACKET_REJECT:
+    case NET_PACKET_SNAPSHOT:
+    default: {}
+    }
+}
+
+void Server::spawn_player(size_t index)
+{
+    game->entities[index] = player_entity(vec2(200.0f + (float) index * TILE_SIZE, 200.0f));
+}
+
+void Server::drop_client(size_t index)
+{
+    println(stdout, "[SERVER] Client ", index, " disconnected");
+    clients[index].connected = false;
+    game->entities[index].state = Entity_State::Ded;
+}
+
+void Server::apply_inputs()
+{
+    for (size_t i = 0; i < PLAYERS_CAPACITY; ++i) {
+        if (!clients[i].connected) continue;
+
+        Entity *entity = &game->entities[i];
+        if (entity->state == Entity_State::Ded) {
+            spawn_player(i);
+        }
+        if (entity->state != Entity_State::Alive) continue;
+
+        const Net_Input input = clients[i].input;
+        const Net_Input prev_input = clients[i].prev_input;
+
+        entity->point_gun_at(input.aim);
+
+        if (input.buttons & NET_BUTTON_LEFT) {
+            entity->move(Entity::Left);
+        } else if (input.buttons & NET_BUTTON_RIGHT) {
+            entity->move(Entity::Right);
+        } else {
+            entity->stop();
+        }
+
+        if ((input.buttons & NET_BUTTON_JUMP) && !(prev_input.buttons & NET_BUTTON_JUMP)) {
+            game->entity_jump({i});
+        }
+
+        if (input.buttons & NET_BUTTON_SHOOT) {
+            game->entity_shoot({i});
+        }
+
+        clients[i].prev_input = input;
+    }
+}
+
+void Server::collect_world(size_t index, Net_World *world)
+{
+    memset(world, 0, sizeof(*world));
+    world->tick = tick;
+    world->you = (uint32_t) index;
+
+    // NOTE: the client only sees the room it is in. Outside of the
+    // rooms it sees roughly a screen around itself.
+    const Entity *you = &game->entities[index];
+    Rectf area = rect(you->pos - vec2(SCREEN_WIDTH, SCREEN_HEIGHT) * 0.5f,
+                      SCREEN_WIDTH, SCREEN_HEIGHT);
+    for (size_t i = 0; i < game->camera_locks_count; ++i) {
+        Rectf lock_abs = rect_cast<float>(game->camera_locks[i]) * TILE_SIZE;
+        if (rect_contains_vec2(lock_abs, you->pos)) {
+            area = rect(vec2(lock_abs.x, lock_abs.y) - vec2(TILE_SIZE, TILE_SIZE),
+                        lock_abs.w + TILE_SIZE * 2.0f,
+                        lock_abs.h + TILE_SIZE * 2.0f);
+        }
+    }
+
+    for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
+        const Entity *entity = &game->entities[i];
+        if (entity->state == Entity_State::Ded) continue;
+        if (i != index && !rects_overlap(area, entity->hitbox_world())) continue;
+
+        Net_Entity *net_entity = &world->entities[i];
+        net_entity->present = 1;
+        net_entity->state = (uint8_t) entity->state;
+        net_entity->alive_state = (uint8_t) entity->alive_state;
+        net_entity->jump_state = (uint8_t) entity->jump_state;
+        net_entity->lives = entity->lives;
+        net_entity->pos = entity->pos;
+        net_entity->vel = entity->vel;
+        net_entity->gun_dir = entity->gun_dir;
+    }
+
+    const Vec2i tile_begin = game->grid.abs_to_tile_coord(vec2(area.x, area.y));
+    const Vec2i tile_end = game->grid.abs_to_tile_coord(vec2(area.x + area.w, area.y + area.h));
+
+    size_t chunks_count = 0;
+    for (int cy = tile_begin.y / TILE_CHUNK_SIZE; cy <= tile_end.y / TILE_CHUNK_SIZE; ++cy) {
+        for (int cx = tile_begin.x / TILE_CHUNK_SIZE; cx <= tile_end.x / TILE_CHUNK_SIZE; ++cx) {
+            if (cx < 0 || cx >= (int) TILE_CHUNKS_WIDTH) continue;
+            if (cy < 0 || cy >= (int) TILE_CHUNKS_HEIGHT) continue;
+            if (chunks_count >= NET_CHUNKS_CAPACITY) continue;
+
+            Net_Chunk *chunk = &world->chunks[chunks_count++];
+            chunk->x = (uint16_t) cx;
+            chunk->y = (uint16_t) cy;
+            for (int y = 0; y < TILE_CHUNK_SIZE; ++y) {
+                for (int x = 0; x < TILE_CHUNK_SIZE; ++x) {
+                    chunk->tiles[y][x] = (uint8_t) game->grid.tiles[cy * TILE_CHUNK_SIZE + y][cx * TILE_CHUNK_SIZE + x];
+                }
+            }
+        }
+    }
+
+    for (size_t i = chunks_count; i < NET_CHUNKS_CAPACITY; ++i) {
+        world->chunks[i].x = NET_NO_CHUNK;
+        world->chunks[i].y = NET_NO_CHUNK;
+    }
+}
+
+void Server::send_snapshots()
+{
+    static const Net_World empty_world = {};
+
+    for (size_t i = 0; i < PLAYERS_CAPACITY; ++i) {
+        Server_Client *client = &clients[i];
+        if (!client->connected) continue;
+
+        Net_World *world = &client->history[tick % NET_HISTORY_CAPACITY];
+        collect_world(i, world);
+
+        Net_Snapshot_Header header = {};
+        header.type = NET_PACKET_SNAPSHOT;
+        header.tick = tick;
+        header.baseline_tick = NET_NO_TICK;
+
+        const Net_World *baseline = &empty_world;
+        const uint32_t ack = client->input.ack_tick;
+        if (ack != NET_NO_TICK && ack < tick && tick - ack < NET_HISTORY_CAPACITY &&
+            client->history[ack % NET_HISTORY_CAPACITY].tick == ack)
+        {
+            baseline = &client->history[ack % NET_HISTORY_CAPACITY];
+            header.baseline_tick = ack;
+        }
+
+        memcpy(packet, &header, sizeof(header));
+        const size_t size = net_delta_encode(
+            baseline, world,
+            packet + sizeof(header),
+            NET_PACKET_CAPACITY - sizeof(header));
+        if (size == 0) {
+            println(stderr, "[WARN] Snapshot for client ", i, " does not fit into a packet");
+            continue;
+        }
+
+        socket.send(client->address, packet, sizeof(header) + size);
+        metrics.bytes_sent += sizeof(header) + size;
+        metrics.snapshots_sent += 1;
+        if (header.baseline_tick == NET_NO_TICK) {
+            metrics.full_snapshots_sent += 1;
+        }
+    }
+}
+
+void Server::check_timeouts(float dt)
+{
+    for (size_t i = 0; i < PLAYERS_CAPACITY; ++i) {
+        if (clients[i].connected) {
+            clients[i].silence += dt;
+            if (clients[i].silence > NET_CLIENT_TIMEOUT) {
+                println(stdout, "[SERVER] Client ", i, " timed out");
+                drop_client(i);
+            }
+        }
+    }
+}
+
+void Server::report_metrics(float seconds)
+{
+    size_t clients_count = 0;
+    for (size_t i = 0; i < PLAYERS_CAPACITY; ++i) {
+        clients_count += clients[i].connected;
+    }
+
+    const float ticks = (float) max(metrics.ticks, (size_t) 1);
+    const float snapshots = (float) max(metrics.snapshots_sent, (size_t) 1);
+    println(stdout, "[SERVER] tick ", tick,
+            " | clients ", clients_count,
+            " | tick avg ", metrics.tick_time_total / ticks * 1000.0f, "ms",
+            " max ", metrics.tick_time_max * 1000.0f, "ms",
+            " | out ", (float) metrics.bytes_sent / seconds / 1024.0f, "KB/s",
+            " in ", (float) metrics.bytes_received / seconds / 1024.0f, "KB/s",
+            " | snapshot avg ", (float) metrics.bytes_sent / snapshots, " bytes",
+            " full ", metrics.full_snapshots_sent);
+    metrics = {};
+}
+
+int server_main(Args args)
+{
+    const uint16_t port = parse_port(&args);
+    const Maybe<float> duration = parse_seconds(&args);
+
+    sec(SDL_Init(0));
+    SDL_Renderer *renderer = create_headless_renderer();
+    assets.load(renderer);
+
+#ifndef SOMETHING_RELEASE
+    {
+        auto result = reload_config_file(VARS_CONF_FILE_PATH);
+        if (result.is_error) {
+            println(stderr, VARS_CONF_FILE_PATH, ":", result.line, ": ", result.message);
+            exit(1);
+        }
+    }
+#endif // SOMETHING_RELEASE
+
+    setup_tile_defs();
+
+    Game *game = new Game {};
+    defer(delete game);
+    load_rooms(game);
+
+    Server *server = new Server {};
+    defer(delete server);
+    server->game = game;
+
+    net_init();
+    defer(net_quit());
+    server->socket.open(port);
+    defer(server->socket.close());
+    println(stdout, "[SERVER] Listening on 127.0.0.1:", port);
+
+    Uint32 prev_ticks = SDL_GetTicks();
+    float lag_sec = 0;
+    float total_sec = 0;
+    float report_sec = 0;
+    while (!duration.has_value || total_sec < duration.unwrap) {
+        Uint32 curr_ticks = SDL_GetTicks();
+        float elapsed_sec = (float) (curr_ticks - prev_ticks) / 1000.0f;
+        prev_ticks = curr_ticks;
+        lag_sec += elapsed_sec;
+        total_sec += elapsed_sec;
+        report_sec += elapsed_sec;
+
+        server->receive_packets();
+
+        while (lag_sec >= SIMULATION_DELTA_TIME) {
+            const Uint64 begin = SDL_GetPerformanceCounter();
+            server->apply_inputs();
+            game->update(SIMULATION_DELTA_TIME);
+            server->tick += 1;
+            server->send_snapshots();
+            server->check_timeouts(SIMULATION_DELTA_TIME);
+            const float tick_time = seconds_since(begin);
+
+            server->metrics.ticks += 1;
+            server->metrics.tick_time_total += tick_time;
+            server->metrics.tick_time_max = max(server->metrics.tick_time_max, tick_time);
+            lag_sec -= SIMULATION_DELTA_TIME;
+        }
+
+        if (report_sec >= 1.0f) {
+            server->report_metrics(report_sec);
+            report_sec = 0.0f;
+        }
+
+        SDL_Delay(1);
+    }
+
+    SDL_Quit();
+    return 0;
+}
+
+// BOT CLIENT //////////////////////////////
+
+struct Bot_Client_Metrics
+{
+    size_t bytes_received;
+    size_t snapshots_received;
+    size_t snapshots_dropped;
+};
+
+int bot_client_main(Args args)
+{
+    const uint16_t port = parse_port(&args);
+    const Maybe<float> duration = parse_seconds(&args);
+    const float seconds = duration.has_value ? duration.unwrap : NET_DEFAULT_BOT_SECONDS;
+
+    sec(SDL_Init(0));
+    net_init();
+    defer(net_quit());
+
+    Net_Socket socket = {};
+    socket.open(0);
+    defer(socket.close());
+    const Net_Address server_address = net_loopback_address(port);
+
+    uint8_t *packet = new uint8_t[NET_PACKET_CAPACITY];
+    defer(delete[] packet);
+    Net_World *history = new Net_World[NET_HISTORY_CAPACITY] {};
+    defer(delete[] history);
+    for (size_t i = 0; i < NET_HISTORY_CAPACITY; ++i) {
+        history[i].tick = NET_NO_TICK;
+    }
+    static const Net_World empty_world = {};
+
+    // CONNECTING //////////////////////////////
+    Maybe<uint32_t> you = {};
+    {
+        const Uint64 begin = SDL_GetPerformanceCounter();
+        float next_retry = 0.0f;
+        while (!you.has_value) {
+            const float t = seconds_since(begin);
+            if (t > NET_CONNECT_TIMEOUT) {
+                println(stderr, "ERROR: could not connect to 127.0.0.1:", port);
+                exit(1);
+            }
+
+            if (t >= next_retry) {
+                const Net_Packet_Type connect = NET_PACKET_CONNECT;
+                socket.send(server_address, &connect, sizeof(connect));
+                next_retry = t + NET_CONNECT_RETRY;
+            }
+
+            Net_Address from = {};
+            auto n = socket.receive(&from, packet, NET_PACKET_CAPACITY);
+            if (n.has_value && from == server_address && n.unwrap > 0) {
+                if (packet[0] == NET_PACKET_REJECT) {
+                    println(stderr, "ERROR: the server is full");
+                    exit(1);
+                }
+
+                if (packet[0] == NET_PACKET_WELCOME && n.unwrap == sizeof(Net_Welcome_Packet)) {
+                    Net_Welcome_Packet welcome = {};
+                    memcpy(&welcome, packet, sizeof(welcome));
+                    you = {true, welcome.you};
+                }
+            }
+
+            SDL_Delay(1);
+        }
+    }
+    println(stdout, "[CLIENT ", you.unwrap, "] Connected to 127.0.0.1:", port);
+
+    // PLAYING //////////////////////////////
+    Bot_Client_Metrics metrics = {};
+    Bot_Client_Metrics total = {};
+    uint32_t last_tick = NET_NO_TICK;
+    Net_World world = {};
+
+    const Uint64 begin = SDL_GetPerformanceCounter();
+    float next_input = 0.0f;
+    float next_report = 1.0f;
+    for (float t = 0.0f; t < seconds; t = seconds_since(begin)) {
+        Net_Address from = {};
+        for (auto n = socket.receive(&from, packet, NET_PACKET_CAPACITY);
+             n.has_value;
+             n = socket.receive(&from, packet, NET_PACKET_CAPACITY))
+        {
+            if (!(from == server_address)) continue;
+            if (n.unwrap < sizeof(Net_Snapshot_Header) || packet[0] != NET_PACKET_SNAPSHOT) continue;
+
+            metrics.bytes_received += n.unwrap;
+
+            Net_Snapshot_Header header = {};
+            memcpy(&header, packet, sizeof(header));
+
+            const Net_World *baseline = &empty_world;
+            if (header.baseline_tick != NET_NO_TICK) {
+                baseline = &history[header.baseline_tick % NET_HISTORY_CAPACITY];
+                if (baseline->tick != header.baseline_tick) {
+                    metrics.snapshots_dropped += 1;
+                    continue;
+                }
+            }
+
+            if (!net_delta_decode(baseline,
+                                  packet + sizeof(header),
+                                  n.unwrap - sizeof(header),
+                                  &world) ||
+                world.tick != header.tick)
+            {
+                metrics.snapshots_dropped += 1;
+                continue;
+            }
+
+            if (last_tick == NET_NO_TICK || world.tick > last_tick) {
+                history[world.tick % NET_HISTORY_CAPACITY] = world;
+                last_tick = world.tick;
+            }
+            metrics.snapshots_received += 1;
+        }
+
+        if (t >= next_input) {
+            // NOTE: walk back and forth, jump from time to time and
+            // shoot in the walking direction
+            const bool right = fmodf(t, 4.0f) < 2.0f;
+            Net_Input_Packet input = {};
+            input.type = NET_PACKET_INPUT;
+            input.input.ack_tick = last_tick;
+            input.input.buttons = right ? NET_BUTTON_RIGHT : NET_BUTTON_LEFT;
+            if (fmodf(t, 1.5f) < 0.1f) input.input.buttons |= NET_BUTTON_JUMP;
+            if (fmodf(t, 1.0f) < 0.2f) input.input.buttons |= NET_BUTTON_SHOOT;
+
+            Vec2f pos = {};
+            if (last_tick != NET_NO_TICK) {
+                pos = history[last_tick % NET_HISTORY_CAPACITY].entities[you.unwrap].pos;
+            }
+            input.input.aim = pos + vec2(right ? 300.0f : -300.0f, 0.0f);
+
+            socket.send(server_address, &input, sizeof(input));
+            next_input += SIMULATION_DELTA_TIME;
+        }
+
+        if (t >= next_report) {
+            size_t visible = 0;
+            if (last_tick != NET_NO_TICK) {
+                const Net_World *latest = &history[last_tick % NET_HISTORY_CAPACITY];
+                for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
+                    visible += latest->entities[i].present;
+                }
+            }
+
+            println(stdout, "[CLIENT ", you.unwrap, "] tick ", last_tick,
+                    " | snapshots ", metrics.snapshots_received,
+                    " dropped ", metrics.snapshots_dropped,
+                    " | in ", (float) metrics.bytes_received / 1024.0f, "KB/s",
+                    " | snapshot avg ", (float) metrics.bytes_received / (float) max(metrics.snapshots_received, (size_t) 1), " bytes",
+                    " | visible entities ", visible);
+
+            total.bytes_received += metrics.bytes_received;
+            total.snapshots_received += metrics.snapshots_received;
+            total.snapshots_dropped += metrics.snapshots_dropped;
+            metrics = {};
+            next_report += 1.0f;
+        }
+
+        SDL_Delay(1);
+    }
+
+    const Net_Packet_Type disconnect = NET_PACKET_DISCONNECT;
+    socket.send(server_address, &disconnect, sizeof(disconnect));
+
+    println(stdout, "[CLIENT ", you.unwrap, "] Total: ",
+            total.snapshots_received, " snapshots, ",
+            total.snapshots_dropped, " dropped, ",
+            (float) total.bytes_received / 1024.0f, "KB received, ",
+            (float) total.bytes_received / (float) max(total.snapshots_received, (size_t) 1), " bytes per snapshot");
+
+    SDL_Quit();
+    return 0;
+}
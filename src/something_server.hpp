@@ -0,0 +1,12 @@
+#ifndef SOMETHING_SERVER_HPP_
+#define SOMETHING_SERVER_HPP_
+
+// NOTE: `./something.debug --server [port] [seconds]` runs the
+// authoritative headless simulation. `./something.debug --client
+// [port] [seconds]` runs a headless bot client that connects to the
+// server on 127.0.0.1, moves around, shoots and reports what it
+// received. Start several of them to test the server locally.
+int server_main(Args args);
+int bot_client_main(Args args);
+
+#endif  // SOMETHING_SERVER_HPP_
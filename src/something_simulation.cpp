@@ -0,0 +1,125 @@
+#include "something_simulation.hpp"
+
+bool Input_Queue::push(const SDL_Event *event)
+{
+    const int current = SDL_AtomicGet(&end);
+    const int next = (current + 1) % (int) INPUT_QUEUE_CAPACITY;
+    if (next == SDL_AtomicGet(&begin)) {
+        return false;
+    }
+
+    events[current] = *event;
+    SDL_AtomicSet(&end, next);
+    return true;
+}
+
+bool Input_Queue::pop(SDL_Event *event)
+{
+    const int current = SDL_AtomicGet(&begin);
+    if (current == SDL_AtomicGet(&end)) {
+        return false;
+    }
+
+    *event = events[current];
+    SDL_AtomicSet(&begin, (current + 1) % (int) INPUT_QUEUE_CAPACITY);
+    return true;
+}
+
+void Simulation::set_mouse_screen_position(Vec2i position)
+{
+    SDL_AtomicLock(&mouse_lock);
+    mouse_screen_position = position;
+    SDL_AtomicUnlock(&mouse_lock);
+}
+
+void Simulation::handle_event(SDL_Event *event)
+{
+    switch (event->type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP: {
+        const auto scancode = event->key.keysym.scancode;
+        if (0 <= scancode && scancode < SDL_NUM_SCANCODES) {
+            keyboard[scancode] = event->type == SDL_KEYDOWN;
+        }
+
+        if (event->type == SDL_KEYDOWN &&
+            event->key.keysym.sym == SDLK_x &&
+            game->step_debug)
+        {
+            game->update(SIMULATION_DELTA_TIME);
+        }
+    } break;
+    }
+
+    game->handle_event(event);
+}
+
+int simulation_thread(void *data)
+{
+    Simulation *simulation = (Simulation *) data;
+    Game *game = simulation->game;
+    game->keyboard = simulation->keyboard;
+
+    // NOTE: the simulation sleeps until its next tick instead of
+    // polling every millisecond
+    Frame_Pacer pacer = {};
+    pacer.init();
+    float spin_sec = 0.0f;
+    float lag_sec = 0;
+    Vec2i prev_mouse_screen_position = {};
+    while (!SDL_AtomicGet(&simulation->stop)) {
+        lag_sec += pacer.begin_frame();
+
+        bool dirty = false;
+
+        sec(SDL_LockMutex(simulation->mutex));
+        {
+            //// HANDLE INPUT //////////////////////////////
+            SDL_AtomicLock(&simulation->mouse_lock);
+            const Vec2i mouse_screen_position = simulation->mouse_screen_position;
+            SDL_AtomicUnlock(&simulation->mouse_lock);
+
+            if (mouse_screen_position.x != prev_mouse_screen_position.x ||
+                mouse_screen_position.y != prev_mouse_screen_position.y)
+            {
+                prev_mouse_screen_position = mouse_screen_position;
+                dirty = true;
+            }
+
+            game->mouse_position =
+                game->camera.to_world(vec_cast<float>(mouse_screen_position));
+            game->collision_probe = game->mouse_position;
+
+            SDL_Event event;
+            while (simulation->inputs.pop(&event)) {
+                simulation->handle_event(&event);
+                dirty = true;
+            }
+            //// HANDLE INPUT END //////////////////////////////
+
+            //// UPDATE STATE //////////////////////////////
+            if (!game->step_debug) {
+                while (lag_sec >= SIMULATION_DELTA_TIME) {
+                    game->update(SIMULATION_DELTA_TIME);
+                    lag_sec -= SIMULATION_DELTA_TIME;
+                    dirty = true;
+                }
+            } else {
+                lag_sec = 0;
+            }
+            //// UPDATE STATE END //////////////////////////////
+
+            if (dirty) {
+                game->snapshot(simulation->snapshots->back_buffer());
+                simulation->snapshots->publish();
+            }
+
+            spin_sec = FRAME_PACER_SPIN_MS / 1000.0f;
+        }
+        sec(SDL_UnlockMutex(simulation->mutex));
+
+        pacer.wait(SIMULATION_DELTA_TIME, spin_sec, 0.0f);
+    }
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef SOMETHING_SIMULATION_HPP_
+#define SOMETHING_SIMULATION_HPP_
+
+#include "something_snapshot.hpp"
+
+const int SIMULATION_FPS = 60;
+const float SIMULATION_DELTA_TIME = 1.0f / SIMULATION_FPS;
+
+const size_t INPUT_QUEUE_CAPACITY = 1024;
+
+// NOTE: Single producer (main thread), single consumer (simulation
+// thread) queue of SDL events.
+struct Input_Queue
+{
+    SDL_Event events[INPUT_QUEUE_CAPACITY];
+    SDL_atomic_t begin;
+    SDL_atomic_t end;
+
+    bool push(const SDL_Event *event);
+    bool pop(SDL_Event *event);
+};
+
+// NOTE: The Game is updated on its own thread so the main thread can
+// keep rendering (and waiting for vsync) without stalling the
+// simulation. The main thread only touches the Game directly while
+// holding the mutex (asset and config reloading) and otherwise talks
+// to it through the input queue and the snapshots.
+struct Simulation
+{
+    Game *game;
+    Snapshot_Triple_Buffer *snapshots;
+    SDL_mutex *mutex;
+    SDL_atomic_t stop;
+
+    Input_Queue inputs;
+
+    SDL_SpinLock mouse_lock;
+    Vec2i mouse_screen_position;
+
+    Uint8 keyboard[SDL_NUM_SCANCODES];
+
+    void set_mouse_screen_position(Vec2i position);
+    void handle_event(SDL_Event *event);
+};
+
+int simulation_thread(void *data);
+
+#endif  // SOMETHING_SIMULATION_HPP_
@@ -0,0 +1,27 @@
+#include "something_snapshot.hpp"
+
+void Snapshot_Triple_Buffer::init()
+{
+    front = 0;
+    SDL_AtomicSet(&middle, 1);
+    back = 2;
+}
+
+Render_Snapshot *Snapshot_Triple_Buffer::back_buffer()
+{
+    return &buffers[back];
+}
+
+void Snapshot_Triple_Buffer::publish()
+{
+    back = SDL_AtomicSet(&middle, back | SNAPSHOT_DIRTY) & ~SNAPSHOT_DIRTY;
+}
+
+const Render_Snapshot *Snapshot_Triple_Buffer::acquire()
+{
+    if (SDL_AtomicGet(&middle) & SNAPSHOT_DIRTY) {
+        front = SDL_AtomicSet(&middle, front) & ~SNAPSHOT_DIRTY;
+    }
+
+    return &buffers[front];
+}
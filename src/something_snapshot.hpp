@@ -0,0 +1,86 @@
+#ifndef SOMETHING_SNAPSHOT_HPP_
+#define SOMETHING_SNAPSHOT_HPP_
+
+#include "something_game.hpp"
+
+const size_t SNAPSHOT_PARTICLES_CAPACITY = 4096;
+
+// NOTE: Render_Snapshot is a copy of everything the main thread needs
+// to render a frame. It is filled up by the simulation thread with
+// Game::snapshot() and never references the Game itself, so the
+// simulation can keep running while the frame is drawn.
+struct Render_Snapshot
+{
+    bool quit;
+    bool debug;
+    bool bfs_debug;
+    bool fps_debug;
+
+    Camera camera;
+    Maybe<Recti> lock;
+    Background background;
+    Tile_Window tile_window;
+    int bfs_trace[ROOM_WIDTH][ROOM_HEIGHT];
+
+    // NOTE: only the entities, projectiles and items that overlap
+    // the camera view are listed as visible (see Game::snapshot) and
+    // only the visible entities and particles are copied at all. The
+    // render paths iterate the visible lists only.
+    Entity_Snapshot entities[ENTITIES_COUNT];
+    size_t visible_entities[ENTITIES_COUNT];
+    size_t visible_entities_count;
+    Particle_Snapshot particles[SNAPSHOT_PARTICLES_CAPACITY];
+    size_t particles_count;
+    Projectile projectiles[PROJECTILES_COUNT];
+    size_t visible_projectiles[PROJECTILES_COUNT];
+    size_t visible_projectiles_count;
+    Item items[ITEMS_COUNT];
+    size_t visible_items[ITEMS_COUNT];
+    size_t visible_items_count;
+    Weapon_Preview weapon_preview;
+
+    // Player HUD
+    Weapon weapon_slots[WEAPON_SLOTS_CAPACITY];
+    size_t weapon_slots_count;
+    size_t weapon_current;
+
+    Popup popup;
+    Console_Snapshot console;
+
+    // Debug overlay
+    Toolbar_Snapshot debug_toolbar;
+    Vec2f mouse_position;
+    Vec2f collision_probe;
+    Vec2f player_pos;
+    Vec2f player_vel;
+    int alive_projectiles;
+    size_t ai_thinks;
+    size_t coarse_entities;
+    Maybe<Projectile_Index> tracking_projectile;
+    Maybe<Projectile_Index> hovered_projectile;
+};
+
+// NOTE: Classic lock-free triple buffer. The simulation thread owns
+// the back buffer, the render thread owns the front buffer and they
+// exchange buffers through the middle one. Neither side ever waits
+// for the other one.
+const int SNAPSHOT_DIRTY = 1 << 2;
+
+struct Snapshot_Triple_Buffer
+{
+    Render_Snapshot buffers[3];
+    SDL_atomic_t middle;
+    int back;
+    int front;
+
+    void init();
+
+    // Simulation thread
+    Render_Snapshot *back_buffer();
+    void publish();
+
+    // Render thread
+    const Render_Snapshot *acquire();
+};
+
+#endif  // SOMETHING_SNAPSHOT_HPP_
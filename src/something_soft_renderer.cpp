@@ -0,0 +1,320 @@
+#include "./something_soft_renderer.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
+static int soft_band_worker(void *data)
+{
+    const Soft_Band *band = (const Soft_Band*) data;
+    Soft_Renderer *soft = band->soft;
+    for (;;) {
+        sec(SDL_SemWait(band->start));
+        // NOTE: the semaphore orders the write of stopping in clean()
+        // before this read
+        if (soft->stopping) break;
+        soft->render_band(band);
+        sec(SDL_SemPost(soft->done));
+    }
+    return 0;
+}
+
+void Soft_Renderer::init(int width, int height, size_t threads_count)
+{
+    this->width = width;
+    this->height = height;
+    this->threads_count = max((size_t) 1, min(threads_count, SOFT_RENDERER_THREADS_CAPACITY));
+    pixels = (uint32_t*) malloc(sizeof(uint32_t) * (size_t) width * (size_t) height);
+    if (pixels == NULL) {
+        println(stderr, "ERROR: could not allocate the software framebuffer");
+        exit(1);
+    }
+    textures_count = 0;
+
+    const int band_height = (height + (int) this->threads_count - 1) / (int) this->threads_count;
+    for (size_t i = 0; i < this->threads_count; ++i) {
+        bands[i] = {};
+        bands[i].soft = this;
+        bands[i].y0 = min(height, (int) i * band_height);
+        bands[i].y1 = min(height, (int) (i + 1) * band_height);
+    }
+
+    stopping = false;
+    done = sec(SDL_CreateSemaphore(0));
+    for (size_t i = 1; i < this->threads_count; ++i) {
+        bands[i].start = sec(SDL_CreateSemaphore(0));
+        workers[i] = sec(SDL_CreateThread(soft_band_worker, "Soft Band", &bands[i]));
+    }
+}
+
+void Soft_Renderer::clean()
+{
+    stopping = true;
+    for (size_t i = 1; i < threads_count; ++i) {
+        sec(SDL_SemPost(bands[i].start));
+    }
+    for (size_t i = 1; i < threads_count; ++i) {
+        SDL_WaitThread(workers[i], NULL);
+        SDL_DestroySemaphore(bands[i].start);
+        workers[i] = NULL;
+        bands[i].start = NULL;
+    }
+    SDL_DestroySemaphore(done);
+    done = NULL;
+
+    free(pixels);
+    pixels = NULL;
+    textures_count = 0;
+}
+
+void Soft_Renderer::register_texture(SDL_Texture *texture, SDL_Surface *surface)
+{
+    assert(textures_count < SOFT_RENDERER_TEXTURES_CAPACITY);
+    assert(surface->format->format == SDL_PIXELFORMAT_RGBA32);
+    textures[textures_count].texture = texture;
+    textures[textures_count].pixels = (const uint32_t*) surface->pixels;
+    textures[textures_count].width = surface->w;
+    textures[textures_count].height = surface->h;
+    textures[textures_count].pitch = surface->pitch / (int) sizeof(uint32_t);
+    textures_count += 1;
+}
+
+const Soft_Texture *Soft_Renderer::find_texture(SDL_Texture *texture) const
+{
+    for (size_t i = 0; i < textures_count; ++i) {
+        if (textures[i].texture == texture) {
+            return &textures[i];
+        }
+    }
+    return NULL;
+}
+
+void Soft_Renderer::clear(SDL_Color color)
+{
+    const uint32_t pixel =
+        (uint32_t) color.r | ((uint32_t) color.g << 8) |
+        ((uint32_t) color.b << 16) | ((uint32_t) color.a << 24);
+    const size_t n = (size_t) width * (size_t) height;
+    for (size_t i = 0; i < n; ++i) {
+        pixels[i] = pixel;
+    }
+}
+
+// NOTE: the pixels are RGBA32, which is R, G, B, A in memory. The
+// blending is the same as SDL_BLENDMODE_BLEND:
+//   dst.rgb = src.rgb * src.a + dst.rgb * (1 - src.a)
+//   dst.a   = src.a + dst.a * (1 - src.a)
+// where src is the texel modulated by the tint.
+static inline uint32_t soft_div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline uint32_t soft_blend1(uint32_t dst, uint32_t src, SDL_Color tint)
+{
+    const uint32_t sr = soft_div255((src & 0xFF) * tint.r);
+    const uint32_t sg = soft_div255(((src >> 8) & 0xFF) * tint.g);
+    const uint32_t sb = soft_div255(((src >> 16) & 0xFF) * tint.b);
+    const uint32_t sa = soft_div255((src >> 24) * tint.a);
+    const uint32_t ia = 255 - sa;
+
+    const uint32_t r = soft_div255(sr * sa + (dst & 0xFF) * ia);
+    const uint32_t g = soft_div255(sg * sa + ((dst >> 8) & 0xFF) * ia);
+    const uint32_t b = soft_div255(sb * sa + ((dst >> 16) & 0xFF) * ia);
+    const uint32_t a = soft_div255(sa * 255 + (dst >> 24) * ia);
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+#ifdef __SSE2__
+static inline __m128i soft_div255_epi16(__m128i x)
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// NOTE: blends two pixels unpacked into 16 bit lanes
+static inline __m128i soft_blend2_epi16(__m128i dst, __m128i src, __m128i tint)
+{
+    src = soft_div255_epi16(_mm_mullo_epi16(src, tint));
+
+    // NOTE: the alpha of every pixel broadcast into its lanes, except
+    // the alpha lane itself that takes 255, which turns the blending
+    // of the alpha channel into `src.a + dst.a * (1 - src.a)`
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128i inv_alpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    const __m128i alpha_lanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+    alpha = _mm_or_si128(_mm_andnot_si128(alpha_lanes, alpha),
+                         _mm_and_si128(alpha_lanes, _mm_set1_epi16(255)));
+
+    return soft_div255_epi16(_mm_add_epi16(_mm_mullo_epi16(src, alpha),
+                                           _mm_mullo_epi16(dst, inv_alpha)));
+}
+
+static inline void soft_blend4(uint32_t *dst, const uint32_t src[4], __m128i tint)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i d = _mm_loadu_si128((const __m128i*) dst);
+    const __m128i s = _mm_loadu_si128((const __m128i*) src);
+    const __m128i lo = soft_blend2_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero), tint);
+    const __m128i hi = soft_blend2_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero), tint);
+    _mm_storeu_si128((__m128i*) dst, _mm_packus_epi16(lo, hi));
+}
+#endif // __SSE2__
+
+void Soft_Renderer::render_quad(const Sprite_Batch_Quad *quad, int y0, int y1) const
+{
+    const Soft_Texture *texture = NULL;
+    if (quad->texture) {
+        texture = find_texture(quad->texture);
+        if (texture == NULL) return;
+    }
+
+    const Rectf dst = quad->dstrect;
+    if (dst.w <= 0.0f || dst.h <= 0.0f) return;
+
+    // NOTE: a pixel is covered when its center is inside of the rect
+    const int x_begin = max(0, (int) ceilf(dst.x - 0.5f));
+    const int x_end = min(width, (int) ceilf(dst.x + dst.w - 0.5f));
+    const int y_begin = max(y0, (int) ceilf(dst.y - 0.5f));
+    const int y_end = min(y1, (int) ceilf(dst.y + dst.h - 0.5f));
+    if (x_begin >= x_end || y_begin >= y_end) return;
+
+    const SDL_Rect src = quad->srcrect;
+    const float su = texture ? (float) src.w / dst.w : 0.0f;
+    const float sv = texture ? (float) src.h / dst.h : 0.0f;
+    const bool flip_x = quad->flip & SDL_FLIP_HORIZONTAL;
+    const bool flip_y = quad->flip & SDL_FLIP_VERTICAL;
+
+#ifdef __SSE2__
+    const __m128i tint = _mm_setr_epi16(quad->color.r, quad->color.g, quad->color.b, quad->color.a,
+                                        quad->color.r, quad->color.g, quad->color.b, quad->color.a);
+#endif // __SSE2__
+
+    for (int y = y_begin; y < y_end; ++y) {
+        uint32_t *row = pixels + (size_t) y * (size_t) width;
+        const uint32_t *texels = NULL;
+        if (texture) {
+            int v = (int) (((float) y + 0.5f - dst.y) * sv);
+            v = min(max(v, 0), src.h - 1);
+            if (flip_y) v = src.h - 1 - v;
+            texels = texture->pixels + (size_t) (src.y + v) * (size_t) texture->pitch + src.x;
+        }
+
+        int x = x_begin;
+#ifdef __SSE2__
+        for (; x + 4 <= x_end; x += 4) {
+            uint32_t samples[4] = {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF};
+            if (texels) {
+                for (int i = 0; i < 4; ++i) {
+                    int u = (int) (((float) (x + i) + 0.5f - dst.x) * su);
+                    u = min(max(u, 0), src.w - 1);
+                    if (flip_x) u = src.w - 1 - u;
+                    samples[i] = texels[u];
+                }
+            }
+            soft_blend4(row + x, samples, tint);
+        }
+#endif // __SSE2__
+        for (; x < x_end; ++x) {
+            uint32_t sample = 0xFFFFFFFF;
+            if (texels) {
+                int u = (int) (((float) x + 0.5f - dst.x) * su);
+                u = min(max(u, 0), src.w - 1);
+                if (flip_x) u = src.w - 1 - u;
+                sample = texels[u];
+            }
+            row[x] = soft_blend1(row[x], sample, quad->color);
+        }
+    }
+}
+
+void Soft_Renderer::render_rotated_quad(const Sprite_Batch_Quad *quad, int y0, int y1) const
+{
+    const Soft_Texture *texture = NULL;
+    if (quad->texture) {
+        texture = find_texture(quad->texture);
+        if (texture == NULL) return;
+    }
+
+    const Rectf dst = quad->dstrect;
+    if (dst.w <= 0.0f || dst.h <= 0.0f) return;
+
+    // NOTE: same as SDL_RenderCopyEx the angle is in degrees clockwise
+    // around the center of the rect
+    const float radians = (float) (quad->angle * PI / 180.0);
+    const float c = cosf(radians);
+    const float s = sinf(radians);
+    const Vec2f center = vec2(dst.x + dst.w * 0.5f, dst.y + dst.h * 0.5f);
+    const float extent_x = fabsf(dst.w * 0.5f * c) + fabsf(dst.h * 0.5f * s);
+    const float extent_y = fabsf(dst.w * 0.5f * s) + fabsf(dst.h * 0.5f * c);
+
+    const int x_begin = max(0, (int) floorf(center.x - extent_x));
+    const int x_end = min(width, (int) ceilf(center.x + extent_x));
+    const int y_begin = max(y0, (int) floorf(center.y - extent_y));
+    const int y_end = min(y1, (int) ceilf(center.y + extent_y));
+
+    const SDL_Rect src = quad->srcrect;
+    for (int y = y_begin; y < y_end; ++y) {
+        uint32_t *row = pixels + (size_t) y * (size_t) width;
+        for (int x = x_begin; x < x_end; ++x) {
+            const float px = (float) x + 0.5f - center.x;
+            const float py = (float) y + 0.5f - center.y;
+            // NOTE: rotate back into the space of the rect
+            const float lx = px * c + py * s + dst.w * 0.5f;
+            const float ly = -px * s + py * c + dst.h * 0.5f;
+            if (lx < 0.0f || lx >= dst.w || ly < 0.0f || ly >= dst.h) continue;
+
+            uint32_t sample = 0xFFFFFFFF;
+            if (texture) {
+                int u = min((int) (lx / dst.w * (float) src.w), src.w - 1);
+                int v = min((int) (ly / dst.h * (float) src.h), src.h - 1);
+                if (quad->flip & SDL_FLIP_HORIZONTAL) u = src.w - 1 - u;
+                if (quad->flip & SDL_FLIP_VERTICAL) v = src.h - 1 - v;
+                sample = texture->pixels[(size_t) (src.y + v) * (size_t) texture->pitch + (size_t) (src.x + u)];
+            }
+            row[x] = soft_blend1(row[x], sample, quad->color);
+        }
+    }
+}
+
+void Soft_Renderer::render_band(const Soft_Band *band) const
+{
+    for (size_t i = 0; i < band->count; ++i) {
+        const Sprite_Batch_Quad *quad = &band->quads[band->order[i]];
+        if (quad->angle == 0.0) {
+            render_quad(quad, band->y0, band->y1);
+        } else {
+            render_rotated_quad(quad, band->y0, band->y1);
+        }
+    }
+}
+
+void Soft_Renderer::render(const Sprite_Batch_Quad *quads, const size_t *order, size_t count)
+{
+    for (size_t i = 0; i < threads_count; ++i) {
+        bands[i].quads = quads;
+        bands[i].order = order;
+        bands[i].count = count;
+    }
+
+    // NOTE: the bands do not overlap, so the threads never touch the
+    // same pixels and the order of the commands is kept in every band
+    for (size_t i = 1; i < threads_count; ++i) {
+        sec(SDL_SemPost(bands[i].start));
+    }
+    render_band(&bands[0]);
+    for (size_t i = 1; i < threads_count; ++i) {
+        sec(SDL_SemWait(done));
+    }
+}
+
+void Soft_Renderer::save_bmp(const char *file_path) const
+{
+    SDL_Surface *surface = sec(SDL_CreateRGBSurfaceWithFormatFrom(
+                                   pixels, width, height, 32,
+                                   width * (int) sizeof(uint32_t),
+                                   SDL_PIXELFORMAT_RGBA32));
+    sec(SDL_SaveBMP(surface, file_path));
+    SDL_FreeSurface(surface);
+}
@@ -0,0 +1,73 @@
+#ifndef SOMETHING_SOFT_RENDERER_HPP_
+#define SOMETHING_SOFT_RENDERER_HPP_
+
+#include "./something_sprite_batch.hpp"
+
+// NOTE: Soft_Renderer is a CPU backend for Sprite_Batch. When a batch
+// has it attached, the flushed commands are rasterized into an RGBA32
+// framebuffer instead of going to the SDL_Renderer: textured quads
+// and solid rects are alpha blended with their tint (the masks are
+// just textured quads with a tint), axis aligned quads go through an
+// SSE2 kernel. The screen is split into horizontal bands that are
+// rasterized in parallel by workers that are started once in init()
+// and woken up for every frame. Only the textures registered with
+// register_texture() can be sampled, everything else is skipped.
+const size_t SOFT_RENDERER_TEXTURES_CAPACITY = 32;
+const size_t SOFT_RENDERER_THREADS_CAPACITY = 16;
+
+struct Soft_Texture
+{
+    SDL_Texture *texture;
+    const uint32_t *pixels;
+    int width;
+    int height;
+    // in pixels
+    int pitch;
+};
+
+struct Soft_Renderer;
+
+struct Soft_Band
+{
+    Soft_Renderer *soft;
+    const Sprite_Batch_Quad *quads;
+    const size_t *order;
+    size_t count;
+    int y0;
+    int y1;
+
+    // NOTE: posted by render() when the band has a frame to rasterize
+    SDL_sem *start;
+};
+
+struct Soft_Renderer
+{
+    uint32_t *pixels;
+    int width;
+    int height;
+    size_t threads_count;
+
+    // NOTE: the band 0 is rasterized by the thread that calls render(),
+    // the rest by the workers
+    Soft_Band bands[SOFT_RENDERER_THREADS_CAPACITY];
+    SDL_Thread *workers[SOFT_RENDERER_THREADS_CAPACITY];
+    SDL_sem *done;
+    bool stopping;
+
+    Soft_Texture textures[SOFT_RENDERER_TEXTURES_CAPACITY];
+    size_t textures_count;
+
+    void init(int width, int height, size_t threads_count);
+    void clean();
+    void register_texture(SDL_Texture *texture, SDL_Surface *surface);
+    const Soft_Texture *find_texture(SDL_Texture *texture) const;
+
+    void clear(SDL_Color color);
+    void render(const Sprite_Batch_Quad *quads, const size_t *order, size_t count);
+    void render_band(const Soft_Band *band) const;
+    void render_quad(const Sprite_Batch_Quad *quad, int y0, int y1) const;
+    void render_rotated_quad(const Sprite_Batch_Quad *quad, int y0, int y1) const;
+    void save_bmp(const char *file_path) const;
+};
+
+#endif  // SOMETHING_SOFT_RENDERER_HPP_
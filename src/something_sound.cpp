@@ -1,88 +1,303 @@
 #include "./something_sound.hpp"
 
-void Sample_Mixer::clean()
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif // __SSE2__
+
+bool Sample_Mixer_Queue::push(const Sample_Mixer_Command *command)
 {
-    for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
-        slots[i].playing = false;
+    const int current = SDL_AtomicGet(&end);
+    const int next = (current + 1) % (int) SAMPLE_MIXER_COMMANDS_CAPACITY;
+    if (next == SDL_AtomicGet(&begin)) {
+        return false;
     }
+
+    commands[current] = *command;
+    SDL_AtomicSet(&end, next);
+    return true;
 }
 
-void Sample_Mixer::play_sample(Sample_S16_Index index)
+bool Sample_Mixer_Queue::pop(Sample_Mixer_Command *command)
 {
-    for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
-        if (!slots[i].playing) {
-            slots[i].cursor = 0;
-            slots[i].index = index;
-            slots[i].playing = true;
-            return;
-        }
+    const int current = SDL_AtomicGet(&begin);
+    if (current == SDL_AtomicGet(&end)) {
+        return false;
     }
+
+    *command = commands[current];
+    SDL_AtomicSet(&begin, (current + 1) % (int) SAMPLE_MIXER_COMMANDS_CAPACITY);
+    return true;
 }
 
-Sample_S16 load_wav_as_sample_s16(const char *file_path)
+void Sample_Mixer::post(Sample_Mixer_Command command)
 {
-    Sample_S16 sample = {};
-    SDL_AudioSpec want = {};
-    if (SDL_LoadWAV(file_path, &want, (Uint8**) &sample.audio_buf, &sample.audio_len) == nullptr) {
-        println(stderr, "SDL pooped itself: Failed to load ", file_path, ": ",
-                SDL_GetError());
-        abort();
+    if (queue.push(&command)) {
+        return;
     }
 
-    assert(SDL_AUDIO_BITSIZE(want.format) == 16);
-    assert(SDL_AUDIO_ISLITTLEENDIAN(want.format));
-    assert(SDL_AUDIO_ISSIGNED(want.format));
-    assert(SDL_AUDIO_ISINT(want.format));
-    assert(want.freq == SOMETHING_SOUND_FREQ);
-    assert(want.channels == SOMETHING_SOUND_CHANNELS);
-    assert(want.samples == SOMETHING_SOUND_SAMPLES);
+    if (command.type == SAMPLE_MIXER_COMMAND_PLAY) {
+        // NOTE: nobody drains the queue (there is no audio device,
+        // like on the server) or the callback is far behind. A
+        // missed sound is better than a stalled game.
+        dropped_count += 1;
+        return;
+    }
 
-    sample.audio_len /= 2;
+    // NOTE: the rest of the commands can not be lost. Waiting for the
+    // callback may take forever (the device is stopped or unplugged),
+    // so the queue is drained right here instead. There is a single
+    // producer, so the command always fits into the empty queue.
+    drain_locked();
+    queue.push(&command);
+}
 
-    return sample;
+void Sample_Mixer::drain_locked()
+{
+    if (device) SDL_LockAudioDevice(device);
+    drain();
+    if (device) SDL_UnlockAudioDevice(device);
 }
 
-Sample_S16 load_wav_as_sample_s16(String_View file_path)
+void Sample_Mixer::clean()
 {
-    char *filepath_cstr = (char*) malloc(file_path.count + 1);
-    assert(filepath_cstr != NULL);
-    memcpy(filepath_cstr, file_path.data, file_path.count);
-    filepath_cstr[file_path.count] = '\0';
-    auto result = load_wav_as_sample_s16(filepath_cstr);
-    free(filepath_cstr);
-    return result;
+    Sample_Mixer_Command command = {};
+    command.type = SAMPLE_MIXER_COMMAND_FLUSH;
+    post(command);
 }
 
-void sample_mixer_audio_callback(void *userdata, Uint8 *stream, int len)
+void Sample_Mixer::play_sample(Sample_S16_Index index, Vec2f position)
 {
-    Sample_Mixer *mixer = (Sample_Mixer *)userdata;
+    const Vec2f delta = position - listener;
+    const float distance = length(delta);
 
-    int16_t *output = (int16_t *)stream;
-    size_t output_len = (size_t) len / sizeof(*output);
+    float attenuation = 1.0f;
+    if (distance > SOUND_FULL_DISTANCE) {
+        const float falloff = max(SOUND_SILENT_DISTANCE - SOUND_FULL_DISTANCE, 1.0f);
+        const float t = clamp(1.0f - (distance - SOUND_FULL_DISTANCE) / falloff, 0.0f, 1.0f);
+        attenuation = t * t;
+    }
 
-    memset(stream, 0, (size_t) len);
-    for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
-        if (mixer->slots[i].playing) {
-            auto sample = assets.get_sound_by_index(mixer->slots[i].index);
+    // NOTE: the sound in the middle plays at full volume in both
+    // speakers, the one on the side fades out of the other speaker
+    const float pan = clamp(delta.x / max(SOUND_PAN_DISTANCE, 1.0f), -1.0f, 1.0f);
+    const float left = attenuation * min(1.0f, 1.0f - pan);
+    const float right = attenuation * min(1.0f, 1.0f + pan);
 
-            for (size_t j = 0; j < output_len; ++j) {
-                int16_t x = 0;
+    if (max(left, right) < SOUND_CULL_GAIN) {
+        culled_count += 1;
+        return;
+    }
 
-                if (mixer->slots[i].cursor < sample.audio_len) {
-                    x = sample.audio_buf[mixer->slots[i].cursor];
-                    mixer->slots[i].cursor += 1;
-                }
+    play(index, assets.get_sound_by_index(index), left, right);
+}
+
+void Sample_Mixer::play(Sample_S16_Index index, Sample_S16 sample, float left, float right)
+{
+    Sample_Mixer_Command command = {};
+    command.type = SAMPLE_MIXER_COMMAND_PLAY;
+    command.index = index;
+    command.sample = sample;
+    command.left = left;
+    command.right = right;
+    post(command);
+}
+
+void Sample_Mixer::stop_sample(Sample_S16_Index index)
+{
+    Sample_Mixer_Command command = {};
+    command.type = SAMPLE_MIXER_COMMAND_STOP;
+    command.index = index;
+    post(command);
+}
+
+void Sample_Mixer::set_volume(float volume)
+{
+    Sample_Mixer_Command command = {};
+    command.type = SAMPLE_MIXER_COMMAND_VOLUME;
+    command.volume = volume;
+    post(command);
+}
+
+void Sample_Mixer::sync()
+{
+    if (device == 0 || SDL_GetAudioDeviceStatus(device) != SDL_AUDIO_PLAYING) {
+        // NOTE: the callback is not running, so the commands are
+        // executed right here
+        drain_locked();
+        return;
+    }
 
-                output[j] = (int16_t) clamp(output[j] + x, (int) INT16_MIN, (int) INT16_MAX);
+    fences_count += 1;
+    Sample_Mixer_Command command = {};
+    command.type = SAMPLE_MIXER_COMMAND_FENCE;
+    command.fence = fences_count;
+    post(command);
+
+    // NOTE: the callback runs once per SOMETHING_SOUND_SAMPLES, so this
+    // takes a buffer at most, unless the device stops in the meantime
+    while (SDL_AtomicGet(&fence_done) - fences_count < 0) {
+        if (SDL_GetAudioDeviceStatus(device) != SDL_AUDIO_PLAYING) {
+            drain_locked();
+            break;
+        }
+        SDL_Delay(1);
+    }
+}
+
+void Sample_Mixer::execute(const Sample_Mixer_Command *command)
+{
+    switch (command->type) {
+    case SAMPLE_MIXER_COMMAND_PLAY: {
+        Maybe<size_t> voice = {};
+        for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY && !voice.has_value; ++i) {
+            if (!slots[i].playing) {
+                voice = {true, i};
             }
+        }
 
-            if (mixer->slots[i].cursor >= sample.audio_len) {
-                mixer->slots[i].playing = false;
+        if (!voice.has_value) {
+            voice = {true, 0};
+            for (size_t i = 1; i < SAMPLE_MIXER_CAPACITY; ++i) {
+                if (started_count - slots[i].started > started_count - slots[voice.unwrap].started) {
+                    voice = {true, i};
+                }
             }
+            steals_count += 1;
         }
+
+        Slot *slot = &slots[voice.unwrap];
+        slot->index = command->index;
+        slot->sample = command->sample;
+        slot->cursor = 0;
+        slot->started = started_count++;
+        slot->left = command->left;
+        slot->right = command->right;
+        slot->playing = true;
+    } break;
+
+    case SAMPLE_MIXER_COMMAND_STOP: {
+        for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
+            if (slots[i].playing && slots[i].index == command->index) {
+                slots[i].playing = false;
+            }
+        }
+    } break;
+
+    case SAMPLE_MIXER_COMMAND_VOLUME: {
+        volume = command->volume;
+    } break;
+
+    case SAMPLE_MIXER_COMMAND_FLUSH: {
+        for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
+            slots[i].playing = false;
+        }
+    } break;
+
+    case SAMPLE_MIXER_COMMAND_FENCE: {
+        SDL_AtomicSet(&fence_done, command->fence);
+    } break;
+    }
+}
+
+void Sample_Mixer::drain()
+{
+    Sample_Mixer_Command command = {};
+    while (queue.pop(&command)) {
+        execute(&command);
     }
+}
+
+// NOTE: x * gain / 32768 the same way the vector code below does it,
+// so the tails of the voices that are not a multiple of 8 samples get
+// exactly the same result as the rest
+static inline int16_t sample_mixer_gain(int16_t x, int16_t gain)
+{
+#if !defined(__SSE2__) && defined(__ARM_NEON)
+    return (int16_t) (((int) x * (int) gain) >> 15);
+#else
+    // NOTE: SSE2 has no rounding Q15 multiply (that is SSSE3), so the
+    // high half of the product is doubled, the lowest bit is lost
+    return (int16_t) ((((int) x * (int) gain) >> 16) * 2);
+#endif // __ARM_NEON
+}
+
+static inline int16_t sample_mixer_saturate(int16_t y, int16_t x)
+{
+    return (int16_t) clamp((int) y + (int) x, (int) INT16_MIN, (int) INT16_MAX);
+}
 
-    for (size_t i = 0; i < output_len; ++i) {
-        output[i] = (int16_t) (output[i] * mixer->volume);
+// NOTE: adds count frames of the mono input to the interleaved stereo
+// output. Every input sample is duplicated into a left/right pair and
+// multiplied by a vector of alternating gains.
+static void sample_mixer_add(int16_t *output, const int16_t *input, size_t count,
+                             int16_t left, int16_t right)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i g = _mm_set_epi16(right, left, right, left, right, left, right, left);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i*) (input + i));
+        const __m128i lo = _mm_slli_epi16(_mm_mulhi_epi16(_mm_unpacklo_epi16(x, x), g), 1);
+        const __m128i hi = _mm_slli_epi16(_mm_mulhi_epi16(_mm_unpackhi_epi16(x, x), g), 1);
+        __m128i *y = (__m128i*) (output + 2 * i);
+        _mm_storeu_si128(y + 0, _mm_adds_epi16(_mm_loadu_si128(y + 0), lo));
+        _mm_storeu_si128(y + 1, _mm_adds_epi16(_mm_loadu_si128(y + 1), hi));
+    }
+#elif defined(__ARM_NEON)
+    const int16_t gains[8] = {left, right, left, right, left, right, left, right};
+    const int16x8_t g = vld1q_s16(gains);
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t x = vld1q_s16(input + i);
+        const int16x8x2_t z = vzipq_s16(x, x);
+        int16_t *y = output + 2 * i;
+        vst1q_s16(y + 0, vqaddq_s16(vld1q_s16(y + 0), vqdmulhq_s16(z.val[0], g)));
+        vst1q_s16(y + 8, vqaddq_s16(vld1q_s16(y + 8), vqdmulhq_s16(z.val[1], g)));
+    }
+#endif // __SSE2__
+    for (; i < count; ++i) {
+        output[2 * i + 0] = sample_mixer_saturate(output[2 * i + 0], sample_mixer_gain(input[i], left));
+        output[2 * i + 1] = sample_mixer_saturate(output[2 * i + 1], sample_mixer_gain(input[i], right));
     }
 }
+
+static inline int16_t sample_mixer_q15(float gain)
+{
+    return (int16_t) clamp((int) (gain * 32767.0f + 0.5f), 0, (int) INT16_MAX);
+}
+
+void Sample_Mixer::mix(int16_t *output, size_t output_len)
+{
+    static_assert(SOMETHING_SOUND_CHANNELS == 2, "The mixer only does stereo");
+    static_assert(SOMETHING_SAMPLE_CHANNELS == 1, "The mixer only does mono sounds");
+
+    drain();
+
+    memset(output, 0, output_len * sizeof(*output));
+
+    const size_t frames = output_len / SOMETHING_SOUND_CHANNELS;
+    for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
+        Slot *slot = &slots[i];
+        if (!slot->playing) continue;
+
+        const size_t remaining = slot->cursor < slot->sample.audio_len
+            ? (size_t) (slot->sample.audio_len - slot->cursor)
+            : 0;
+        const size_t n = min(remaining, frames);
+        sample_mixer_add(output, slot->sample.audio_buf + slot->cursor, n,
+                         sample_mixer_q15(volume * slot->left),
+                         sample_mixer_q15(volume * slot->right));
+        slot->cursor += (Uint32) n;
+
+        if (slot->cursor >= slot->sample.audio_len) {
+            slot->playing = false;
+        }
+    }
+}
+
+void sample_mixer_audio_callback(void *userdata, Uint8 *stream, int len)
+{
+    Sample_Mixer *mixer = (Sample_Mixer *)userdata;
+    mixer->mix((int16_t *)stream, (size_t) len / sizeof(int16_t));
+}
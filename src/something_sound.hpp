@@ -7,32 +7,120 @@ struct Sample_S16
     Uint32 audio_len;
 };
 
-const size_t SAMPLE_MIXER_CAPACITY = 5;
+// NOTE: every sound takes a voice for itself. When all of the voices
+// are busy the one that has been playing the longest is stolen, so the
+// fresh sounds (hits, kills, shots) are never dropped.
+const size_t SAMPLE_MIXER_CAPACITY = 256;
+const size_t SAMPLE_MIXER_COMMANDS_CAPACITY = 1024;
 
+enum Sample_Mixer_Command_Type
+{
+    SAMPLE_MIXER_COMMAND_PLAY = 0,
+    SAMPLE_MIXER_COMMAND_STOP,
+    SAMPLE_MIXER_COMMAND_VOLUME,
+    SAMPLE_MIXER_COMMAND_FLUSH,
+    SAMPLE_MIXER_COMMAND_FENCE,
+};
+
+struct Sample_Mixer_Command
+{
+    Sample_Mixer_Command_Type type;
+    Sample_S16_Index index;
+    Sample_S16 sample;
+    // NOTE: the gains of the speakers for PLAY, the master volume
+    // for VOLUME
+    float left;
+    float right;
+    float volume;
+    int fence;
+};
 
+// NOTE: wait-free single producer single consumer ring, same as
+// Input_Queue. The producer is whoever holds the simulation mutex
+// (the game update or the asset reloading), the consumer is the audio
+// callback.
+struct Sample_Mixer_Queue
+{
+    Sample_Mixer_Command commands[SAMPLE_MIXER_COMMANDS_CAPACITY];
+    SDL_atomic_t begin;
+    SDL_atomic_t end;
+
+    bool push(const Sample_Mixer_Command *command);
+    bool pop(Sample_Mixer_Command *command);
+};
+
+// NOTE: The game never touches the voices. It posts commands that the
+// audio callback executes at the beginning of every buffer, so the
+// voices are owned by the audio thread alone. sync() is the handshake
+// for the asset reloading: once it returns, the mixer has executed
+// every command posted before it and does not refer to the samples
+// that were stopped.
 struct Sample_Mixer
 {
     struct Slot
     {
         Sample_S16_Index index;
+        // NOTE: resolved when the sound starts, so the mixing itself
+        // does not go through the assets
+        Sample_S16 sample;
         Uint32 cursor;
+        // NOTE: the value of started_count when the sound started
+        Uint32 started;
+        float left;
+        float right;
         bool playing;
     };
 
+    // Game side
+    Sample_Mixer_Queue queue;
+    // NOTE: 0 when there is no audio device (the server, the headless
+    // mode), then the commands are executed by whoever posts them
+    SDL_AudioDeviceID device;
+    int fences_count;
+    size_t dropped_count;
+    // NOTE: the sounds are heard from here, the game keeps it at the
+    // camera
+    Vec2f listener;
+    size_t culled_count;
+
+    // Audio side
     float volume;
+    Uint32 started_count;
+    size_t steals_count;
     Slot slots[SAMPLE_MIXER_CAPACITY];
+    SDL_atomic_t fence_done;
 
-    void play_sample(Sample_S16_Index sample);
+    void post(Sample_Mixer_Command command);
+    // NOTE: attenuated and panned by the distance from the listener.
+    // The sounds that would not be heard are dropped right away and
+    // do not take a voice.
+    void play_sample(Sample_S16_Index sample, Vec2f position);
+    void play(Sample_S16_Index index, Sample_S16 sample, float left, float right);
+    void stop_sample(Sample_S16_Index sample);
+    void set_volume(float volume);
     void clean();
+    void sync();
+
+    void execute(const Sample_Mixer_Command *command);
+    void drain();
+    // NOTE: drains the queue on the calling thread with the callback
+    // locked out
+    void drain_locked();
+    // NOTE: executes the pending commands and overwrites the
+    // interleaved stereo output with the playing voices, the gains are
+    // applied to every voice as it is added. output_len is in samples,
+    // not frames.
+    void mix(int16_t *output, size_t output_len);
 };
 
 const size_t SOMETHING_SOUND_FREQ = 48000;
 const size_t SOMETHING_SOUND_FORMAT = 32784;
-const size_t SOMETHING_SOUND_CHANNELS = 1;
+const size_t SOMETHING_SOUND_CHANNELS = 2;
+// NOTE: the sounds themselves are mono, the mixer pans them into the
+// channels of the output
+const size_t SOMETHING_SAMPLE_CHANNELS = 1;
 const size_t SOMETHING_SOUND_SAMPLES = 4096;
 
-Sample_S16 load_wav_as_sample_s16(const char *file_path);
-Sample_S16 load_wav_as_sample_s16(String_View file_path);
 void sample_mixer_audio_callback(void *userdata, Uint8 *stream, int len);
 
 #endif  // SOMETHING_SOUND_HPP_
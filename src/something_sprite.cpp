@@ -6,11 +6,8 @@ Sprite sprite_from_texture_index(Texture_Index texture_index)
 {
     Sprite result = {};
     result.texture_index = texture_index;
-    sec(SDL_QueryTexture(assets.get_texture_by_index(texture_index).texture,
-                         NULL,
-                         NULL,
-                         &result.srcrect.w,
-                         &result.srcrect.h));
+    result.srcrect.w = assets.get_texture_by_index(texture_index).rect.w;
+    result.srcrect.h = assets.get_texture_by_index(texture_index).rect.h;
     return result;
 }
 
@@ -21,41 +18,48 @@ void Sprite::render(SDL_Renderer *renderer,
                     double angle) const
 {
     if (texture_index.unwrap < assets.textures_count) {
+        const Texture texture = assets.get_texture_by_index(texture_index);
+        SDL_Texture *atlas = assets.get_atlas_of_texture(texture_index).texture;
         SDL_Rect rect = rectf_for_sdl(destrect);
         SDL_Color sdl_shade = rgba_to_sdl(shade);
 
+        const SDL_Rect atlas_srcrect = texture.to_atlas(srcrect);
         sec(SDL_RenderCopyEx(
                 renderer,
-                assets.get_texture_by_index(texture_index).texture,
-                &srcrect,
+                atlas,
+                &atlas_srcrect,
                 &rect,
                 angle,
                 nullptr,
                 flip));
 
-        sec(SDL_SetTextureColorMod(
-                assets.get_texture_by_index(texture_index).texture_mask,
-                sdl_shade.r, sdl_shade.g, sdl_shade.b));
-        sec(SDL_SetTextureAlphaMod(
-                assets.get_texture_by_index(texture_index).texture_mask,
-                sdl_shade.a));
+        // NOTE: fully transparent shade is the default for most of
+        // the sprites, no need to draw the mask for them
+        if (sdl_shade.a == 0) {
+            return;
+        }
+
+        // NOTE: the mask lives in the same atlas as the sprite itself,
+        // so the modulation has to be reset right after drawing it
+        const SDL_Rect atlas_mask_srcrect = texture.to_atlas_mask(srcrect);
+        sec(SDL_SetTextureColorMod(atlas, sdl_shade.r, sdl_shade.g, sdl_shade.b));
+        sec(SDL_SetTextureAlphaMod(atlas, sdl_shade.a));
 
         sec(SDL_RenderCopyEx(
                 renderer,
-                assets.get_texture_by_index(texture_index).texture_mask,
-                &srcrect,
+                atlas,
+                &atlas_mask_srcrect,
                 &rect,
                 0.0,
                 nullptr,
                 flip));
+
+        sec(SDL_SetTextureColorMod(atlas, 255, 255, 255));
+        sec(SDL_SetTextureAlphaMod(atlas, 255));
     }
 }
 
-void Sprite::render(SDL_Renderer *renderer,
-                    Vec2f pos,
-                    SDL_RendererFlip flip,
-                    RGBA shade,
-                    double angle) const
+Rectf Sprite::centered_at(Vec2f pos) const
 {
     const Rectf destrect = {
         pos.x - (float) srcrect.w * 0.5f,
@@ -63,8 +67,49 @@ void Sprite::render(SDL_Renderer *renderer,
         (float) srcrect.w,
         (float) srcrect.h
     };
+    return destrect;
+}
 
-    render(renderer, destrect, flip, shade, angle);
+void Sprite::render(SDL_Renderer *renderer,
+                    Vec2f pos,
+                    SDL_RendererFlip flip,
+                    RGBA shade,
+                    double angle) const
+{
+    render(renderer, centered_at(pos), flip, shade, angle);
+}
+
+void Sprite::render(Sprite_Batch *batch,
+                    Sprite_Layer layer,
+                    Rectf destrect,
+                    SDL_RendererFlip flip,
+                    RGBA shade,
+                    double angle) const
+{
+    // NOTE: empty sprites (like the one of TILE_EMPTY) are not recorded
+    if (texture_index.unwrap < assets.textures_count && srcrect.w > 0 && srcrect.h > 0) {
+        const Texture texture = assets.get_texture_by_index(texture_index);
+        const Texture_Atlas atlas = assets.get_atlas_of_texture(texture_index);
+
+        batch->texture(layer, atlas.texture, atlas.size,
+                       texture.to_atlas(srcrect), destrect, flip, {255, 255, 255, 255}, angle);
+
+        const SDL_Color sdl_shade = rgba_to_sdl(shade);
+        if (sdl_shade.a > 0) {
+            batch->texture(layer, atlas.texture, atlas.size,
+                           texture.to_atlas_mask(srcrect), destrect, flip, sdl_shade, angle);
+        }
+    }
+}
+
+void Sprite::render(Sprite_Batch *batch,
+                    Sprite_Layer layer,
+                    Vec2f pos,
+                    SDL_RendererFlip flip,
+                    RGBA shade,
+                    double angle) const
+{
+    render(batch, layer, centered_at(pos), flip, shade, angle);
 }
 
 void Frames_Animat::reset()
@@ -78,9 +123,9 @@ void Frames_Animat::render(SDL_Renderer *renderer,
                            RGBA shade,
                            double angle) const
 {
-    auto frames = assets.get_frames_by_index(frames_index);
-    if (frames.count > 0) {
-        frames.sprites[frame_current % frames.count].render(renderer, dstrect, flip, shade, angle);
+    const Frames *frames = assets.get_frames_by_index(frames_index);
+    if (frames->count > 0) {
+        frames->sprites[frame_current % frames->count].render(renderer, dstrect, flip, shade, angle);
     }
 }
 
@@ -90,20 +135,46 @@ void Frames_Animat::render(SDL_Renderer *renderer,
                            RGBA shade,
                            double angle) const
 {
-    auto frames = assets.get_frames_by_index(frames_index);
-    if (frames.count > 0) {
-        frames.sprites[frame_current % frames.count].render(renderer, pos, flip, shade, angle);
+    const Frames *frames = assets.get_frames_by_index(frames_index);
+    if (frames->count > 0) {
+        frames->sprites[frame_current % frames->count].render(renderer, pos, flip, shade, angle);
+    }
+}
+
+void Frames_Animat::render(Sprite_Batch *batch,
+                           Sprite_Layer layer,
+                           Rectf dstrect,
+                           SDL_RendererFlip flip,
+                           RGBA shade,
+                           double angle) const
+{
+    const Frames *frames = assets.get_frames_by_index(frames_index);
+    if (frames->count > 0) {
+        frames->sprites[frame_current % frames->count].render(batch, layer, dstrect, flip, shade, angle);
+    }
+}
+
+void Frames_Animat::render(Sprite_Batch *batch,
+                           Sprite_Layer layer,
+                           Vec2f pos,
+                           SDL_RendererFlip flip,
+                           RGBA shade,
+                           double angle) const
+{
+    const Frames *frames = assets.get_frames_by_index(frames_index);
+    if (frames->count > 0) {
+        frames->sprites[frame_current % frames->count].render(batch, layer, pos, flip, shade, angle);
     }
 }
 
 void Frames_Animat::update(float dt)
 {
-    auto frames = assets.get_frames_by_index(frames_index);
+    const Frames *frames = assets.get_frames_by_index(frames_index);
     if (dt < frame_cooldown) {
         frame_cooldown -= dt;
-    } else if (frames.count > 0) {
-        frame_current = (frame_current + 1) % frames.count;
-        frame_cooldown = frames.duration;
+    } else if (frames->count > 0) {
+        frame_current = (frame_current + 1) % frames->count;
+        frame_cooldown = frames->duration;
     }
 }
 
@@ -204,5 +275,5 @@ struct Compose_Rubber_Animat
 
 bool Frames_Animat::has_finished() const
 {
-    return frame_current >= assets.get_frames_by_index(frames_index).count - 1;
+    return frame_current >= assets.get_frames_by_index(frames_index)->count - 1;
 }
@@ -2,6 +2,7 @@
 #define SOMETHING_SPRITE_HPP_
 
 #include "./something_index.hpp"
+#include "./something_sprite_batch.hpp"
 
 struct Sprite
 {
@@ -18,11 +19,24 @@ struct Sprite
                 SDL_RendererFlip flip = SDL_FLIP_NONE,
                 RGBA shade = {0, 0, 0, 0},
                 double angle = 0.0) const;
+    void render(Sprite_Batch *batch,
+                Sprite_Layer layer,
+                Rectf destrect,
+                SDL_RendererFlip flip = SDL_FLIP_NONE,
+                RGBA shade = {0, 0, 0, 0},
+                double angle = 0.0) const;
+    void render(Sprite_Batch *batch,
+                Sprite_Layer layer,
+                Vec2f pos,
+                SDL_RendererFlip flip = SDL_FLIP_NONE,
+                RGBA shade = {0, 0, 0, 0},
+                double angle = 0.0) const;
+    Rectf centered_at(Vec2f pos) const;
 };
 
 struct Frames
 {
-    Sprite *sprites;
+    const Sprite *sprites;
     size_t count;
     float duration;
 };
@@ -48,6 +62,20 @@ struct Frames_Animat
                 RGBA shade = {0, 0, 0, 0},
                 double angle = 0.0) const;
 
+    void render(Sprite_Batch *batch,
+                Sprite_Layer layer,
+                Rectf dstrect,
+                SDL_RendererFlip flip = SDL_FLIP_NONE,
+                RGBA shade = {0, 0, 0, 0},
+                double angle = 0.0) const;
+
+    void render(Sprite_Batch *batch,
+                Sprite_Layer layer,
+                Vec2f pos,
+                SDL_RendererFlip flip = SDL_FLIP_NONE,
+                RGBA shade = {0, 0, 0, 0},
+                double angle = 0.0) const;
+
     void update(float dt);
 
     bool has_finished() const;
@@ -0,0 +1,295 @@
+#include "something_sprite_batch.hpp"
+#include "something_soft_renderer.hpp"
+
+void Sprite_Batch::begin_frame(SDL_Renderer *renderer)
+{
+    this->renderer = renderer;
+    quads.size = 0;
+    groups_count = 0;
+    last_texture = NULL;
+    last_blend = SDL_BLENDMODE_NONE;
+    frame_quads = 0;
+    frame_state_changes = 0;
+    frame_draw_calls = 0;
+
+    if (dump) {
+        dump_textures_count = 0;
+        println(dump, "frame");
+    }
+}
+
+void Sprite_Batch::push(Sprite_Batch_Quad quad)
+{
+    Maybe<size_t> group = {};
+    for (size_t i = groups_count; !group.has_value && i > 0; --i) {
+        if (groups[i - 1].layer == quad.layer &&
+            groups[i - 1].texture == quad.texture &&
+            groups[i - 1].blend == quad.blend) {
+            group = {true, i - 1};
+        }
+    }
+
+    if (!group.has_value) {
+        if (groups_count >= SPRITE_BATCH_GROUPS_CAPACITY) {
+            flush();
+        }
+
+        groups[groups_count].layer = quad.layer;
+        groups[groups_count].texture = quad.texture;
+        groups[groups_count].blend = quad.blend;
+        groups[groups_count].count = 0;
+        groups[groups_count].offset = 0;
+        group = {true, groups_count++};
+    }
+
+    groups[group.unwrap].count += 1;
+    quad.group = group.unwrap;
+    quads.push(quad);
+}
+
+void Sprite_Batch::texture(Sprite_Layer layer,
+                           SDL_Texture *texture, Vec2i texture_size,
+                           SDL_Rect srcrect, Rectf dstrect,
+                           SDL_RendererFlip flip, SDL_Color color, double angle,
+                           SDL_BlendMode blend)
+{
+    Sprite_Batch_Quad quad = {};
+    quad.layer = layer;
+    quad.texture = texture;
+    quad.texture_size = texture_size;
+    quad.blend = blend;
+    quad.srcrect = srcrect;
+    quad.dstrect = dstrect;
+    quad.flip = flip;
+    quad.color = color;
+    quad.angle = angle;
+    push(quad);
+}
+
+void Sprite_Batch::fill_rect(Sprite_Layer layer, Rectf rect, RGBA color)
+{
+    Sprite_Batch_Quad quad = {};
+    quad.layer = layer;
+    quad.blend = SDL_BLENDMODE_BLEND;
+    quad.dstrect = rect;
+    quad.color = rgba_to_sdl(color);
+    push(quad);
+}
+
+void Sprite_Batch::draw_rect(Sprite_Layer layer, Rectf rect, RGBA color)
+{
+    fill_rect(layer, {rect.x, rect.y, rect.w, 1.0f}, color);
+    fill_rect(layer, {rect.x, rect.y + rect.h - 1.0f, rect.w, 1.0f}, color);
+    fill_rect(layer, {rect.x, rect.y, 1.0f, rect.h}, color);
+    fill_rect(layer, {rect.x + rect.w - 1.0f, rect.y, 1.0f, rect.h}, color);
+}
+
+void Sprite_Batch::line(Sprite_Layer layer, Vec2f begin, Vec2f end, RGBA color)
+{
+    const Vec2f d = end - begin;
+    const float length = sqrtf(d.x * d.x + d.y * d.y);
+    const Vec2f center = (begin + end) * 0.5f;
+
+    Sprite_Batch_Quad quad = {};
+    quad.layer = layer;
+    quad.blend = SDL_BLENDMODE_BLEND;
+    quad.dstrect = {center.x - length * 0.5f, center.y - 0.5f, length, 1.0f};
+    quad.color = rgba_to_sdl(color);
+    quad.angle = atan2(d.y, d.x) * 180.0 / PI;
+    push(quad);
+}
+
+static void sprite_batch_quad_vertices(const Sprite_Batch_Quad *quad, SDL_Vertex vertices[4])
+{
+    const Rectf r = quad->dstrect;
+    const Vec2f center = vec2(r.x + r.w * 0.5f, r.y + r.h * 0.5f);
+    const Vec2f corners[4] = {
+        vec2(-r.w * 0.5f, -r.h * 0.5f),
+        vec2( r.w * 0.5f, -r.h * 0.5f),
+        vec2( r.w * 0.5f,  r.h * 0.5f),
+        vec2(-r.w * 0.5f,  r.h * 0.5f),
+    };
+
+    // NOTE: same as SDL_RenderCopyEx the angle is in degrees clockwise
+    const float radians = (float) (quad->angle * PI / 180.0);
+    const float c = cosf(radians);
+    const float s = sinf(radians);
+
+    float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+    if (quad->texture) {
+        u0 = (float) quad->srcrect.x / (float) quad->texture_size.x;
+        v0 = (float) quad->srcrect.y / (float) quad->texture_size.y;
+        u1 = (float) (quad->srcrect.x + quad->srcrect.w) / (float) quad->texture_size.x;
+        v1 = (float) (quad->srcrect.y + quad->srcrect.h) / (float) quad->texture_size.y;
+        if (quad->flip & SDL_FLIP_HORIZONTAL) swap(&u0, &u1);
+        if (quad->flip & SDL_FLIP_VERTICAL) swap(&v0, &v1);
+    }
+    const Vec2f uvs[4] = {vec2(u0, v0), vec2(u1, v0), vec2(u1, v1), vec2(u0, v1)};
+
+    for (int i = 0; i < 4; ++i) {
+        vertices[i].position.x = center.x + corners[i].x * c - corners[i].y * s;
+        vertices[i].position.y = center.y + corners[i].x * s + corners[i].y * c;
+        vertices[i].color = quad->color;
+        vertices[i].tex_coord.x = uvs[i].x;
+        vertices[i].tex_coord.y = uvs[i].y;
+    }
+}
+
+static const char *blend_mode_as_cstr(SDL_BlendMode blend)
+{
+    // NOTE: not a switch, SDL_BlendMode has more values depending on
+    // the version of SDL
+    if (blend == SDL_BLENDMODE_NONE) return "none";
+    if (blend == SDL_BLENDMODE_BLEND) return "blend";
+    if (blend == SDL_BLENDMODE_ADD) return "add";
+    if (blend == SDL_BLENDMODE_MOD) return "mod";
+    return "other";
+}
+
+size_t Sprite_Batch::dump_texture_id(SDL_Texture *texture)
+{
+    for (size_t i = 0; i < dump_textures_count; ++i) {
+        if (dump_textures[i] == texture) {
+            return i;
+        }
+    }
+
+    assert(dump_textures_count < SPRITE_BATCH_DUMP_TEXTURES_CAPACITY);
+    dump_textures[dump_textures_count] = texture;
+    return dump_textures_count++;
+}
+
+void Sprite_Batch::dump_group(const Sprite_Batch_Group *group, size_t begin)
+{
+    for (size_t j = begin; j < begin + group->count; ++j) {
+        const Sprite_Batch_Quad *quad = &quads.data[order.data[j]];
+        print(dump, "  ", (int) quad->layer, " ");
+        if (quad->texture) {
+            print(dump, "texture:", dump_texture_id(quad->texture));
+        } else {
+            print(dump, "solid");
+        }
+        println(dump, " ", blend_mode_as_cstr(quad->blend),
+                " src ", quad->srcrect.x, " ", quad->srcrect.y, " ", quad->srcrect.w, " ", quad->srcrect.h,
+                " dst ", quad->dstrect.x, " ", quad->dstrect.y, " ", quad->dstrect.w, " ", quad->dstrect.h,
+                " tint ", (int) quad->color.r, " ", (int) quad->color.g, " ", (int) quad->color.b, " ", (int) quad->color.a,
+                " angle ", (float) quad->angle);
+    }
+}
+
+void Sprite_Batch::flush()
+{
+    if (quads.size == 0) {
+        groups_count = 0;
+        return;
+    }
+
+    // NOTE: groups are stably sorted by layer, so the groups of the
+    // same layer stay in the order they first appeared in
+    size_t sorted[SPRITE_BATCH_GROUPS_CAPACITY];
+    for (size_t i = 0; i < groups_count; ++i) {
+        sorted[i] = i;
+        for (size_t j = i; j > 0 && groups[sorted[j - 1]].layer > groups[sorted[j]].layer; --j) {
+            swap(&sorted[j - 1], &sorted[j]);
+        }
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < groups_count; ++i) {
+        groups[sorted[i]].offset = offset;
+        offset += groups[sorted[i]].count;
+    }
+
+    while (order.capacity < quads.size) {
+        order.expand_capacity();
+    }
+    order.size = quads.size;
+    for (size_t i = 0; i < quads.size; ++i) {
+        order.data[groups[quads.data[i].group].offset++] = i;
+    }
+
+    if (soft) {
+        soft->render(quads.data, order.data, quads.size);
+    }
+
+    size_t begin = 0;
+    for (size_t i = 0; i < groups_count; ++i) {
+        const Sprite_Batch_Group *group = &groups[sorted[i]];
+
+        if (dump) {
+            dump_group(group, begin);
+        }
+
+        if (soft) {
+            frame_draw_calls += 1;
+            begin += group->count;
+            continue;
+        }
+
+        if (group->texture != last_texture || group->blend != last_blend) {
+            if (group->texture) {
+                sec(SDL_SetTextureBlendMode(group->texture, group->blend));
+            } else {
+                sec(SDL_SetRenderDrawBlendMode(renderer, group->blend));
+            }
+            last_texture = group->texture;
+            last_blend = group->blend;
+            frame_state_changes += 1;
+        }
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        vertices.size = 0;
+        indices.size = 0;
+        for (size_t j = begin; j < begin + group->count; ++j) {
+            SDL_Vertex quad_vertices[4];
+            sprite_batch_quad_vertices(&quads.data[order.data[j]], quad_vertices);
+
+            const int base = (int) vertices.size;
+            for (int k = 0; k < 4; ++k) {
+                vertices.push(quad_vertices[k]);
+            }
+            const int quad_indices[6] = {base, base + 1, base + 2, base, base + 2, base + 3};
+            for (int k = 0; k < 6; ++k) {
+                indices.push(quad_indices[k]);
+            }
+        }
+
+        sec(SDL_RenderGeometry(renderer, group->texture,
+                               vertices.data, (int) vertices.size,
+                               indices.data, (int) indices.size));
+        frame_draw_calls += 1;
+#else
+        // NOTE: SDL_RenderGeometry is not available before SDL 2.0.18,
+        // so the quads are still sorted but drawn one by one.
+        for (size_t j = begin; j < begin + group->count; ++j) {
+            const Sprite_Batch_Quad *quad = &quads.data[order.data[j]];
+            if (quad->texture) {
+                const SDL_Rect dstrect = rectf_for_sdl(quad->dstrect);
+                sec(SDL_SetTextureColorMod(quad->texture, quad->color.r, quad->color.g, quad->color.b));
+                sec(SDL_SetTextureAlphaMod(quad->texture, quad->color.a));
+                sec(SDL_RenderCopyEx(renderer, quad->texture, &quad->srcrect, &dstrect,
+                                     quad->angle, nullptr, quad->flip));
+            } else {
+                sec(SDL_SetRenderDrawColor(renderer, quad->color.r, quad->color.g, quad->color.b, quad->color.a));
+                if (quad->angle == 0.0) {
+                    const SDL_Rect dstrect = rectf_for_sdl(quad->dstrect);
+                    sec(SDL_RenderFillRect(renderer, &dstrect));
+                } else {
+                    SDL_Vertex line[4];
+                    sprite_batch_quad_vertices(quad, line);
+                    sec(SDL_RenderDrawLine(renderer,
+                                           (int) line[0].position.x, (int) line[0].position.y,
+                                           (int) line[1].position.x, (int) line[1].position.y));
+                }
+            }
+            frame_draw_calls += 1;
+        }
+#endif // SDL_VERSION_ATLEAST(2, 0, 18)
+
+        begin += group->count;
+    }
+
+    frame_quads += quads.size;
+    quads.size = 0;
+    groups_count = 0;
+}
@@ -0,0 +1,105 @@
+#ifndef SOMETHING_SPRITE_BATCH_HPP_
+#define SOMETHING_SPRITE_BATCH_HPP_
+
+// NOTE: Sprite_Batch is the render command list of a frame. Every
+// command is a quad with a layer, a texture, a blend mode, a rect and a
+// tint, recorded into a linear array. On flush the commands are sorted
+// by layer and, within a layer, grouped by texture and blend mode, so
+// the order between different textures of the same layer is not
+// preserved. Anything that has to be on top of something else within
+// the same frame must be on a higher layer.
+enum Sprite_Layer
+{
+    SPRITE_LAYER_BACKGROUND = 0,
+    SPRITE_LAYER_TILES,
+    SPRITE_LAYER_PARTICLES,
+    SPRITE_LAYER_ENTITIES,
+    SPRITE_LAYER_ENTITY_BARS,
+    SPRITE_LAYER_WEAPON_PREVIEW,
+    SPRITE_LAYER_PROJECTILES,
+    SPRITE_LAYER_ITEMS,
+    SPRITE_LAYER_UI_BACKGROUND,
+    SPRITE_LAYER_UI_ICONS,
+    SPRITE_LAYER_UI_SHADE,
+    SPRITE_LAYER_COUNT
+};
+
+const size_t SPRITE_BATCH_GROUPS_CAPACITY = 128;
+const size_t SPRITE_BATCH_DUMP_TEXTURES_CAPACITY = 256;
+
+struct Sprite_Batch_Quad
+{
+    Sprite_Layer layer;
+    // NOTE: NULL texture means a solid color quad
+    SDL_Texture *texture;
+    Vec2i texture_size;
+    SDL_BlendMode blend;
+    SDL_Rect srcrect;
+    Rectf dstrect;
+    SDL_RendererFlip flip;
+    SDL_Color color;
+    double angle;
+    size_t group;
+};
+
+struct Sprite_Batch_Group
+{
+    Sprite_Layer layer;
+    SDL_Texture *texture;
+    SDL_BlendMode blend;
+    size_t count;
+    size_t offset;
+};
+
+struct Soft_Renderer;
+
+struct Sprite_Batch
+{
+    SDL_Renderer *renderer;
+    // NOTE: when set, the commands are rasterized by the CPU backend
+    // instead of the renderer (see something_soft_renderer.hpp)
+    Soft_Renderer *soft;
+
+    Dynamic_Array<Sprite_Batch_Quad> quads;
+    Sprite_Batch_Group groups[SPRITE_BATCH_GROUPS_CAPACITY];
+    size_t groups_count;
+
+    // Flush scratch buffers
+    Dynamic_Array<size_t> order;
+    Dynamic_Array<SDL_Vertex> vertices;
+    Dynamic_Array<int> indices;
+
+    // NOTE: the texture and the blend mode of the last submitted
+    // group to count the state changes
+    SDL_Texture *last_texture;
+    SDL_BlendMode last_blend;
+
+    // Stats of the current frame
+    size_t frame_quads;
+    size_t frame_state_changes;
+    size_t frame_draw_calls;
+
+    // NOTE: when set, every flush also writes the sorted commands
+    // into this file (see something_headless.hpp). The textures are
+    // dumped as the order of their first use in the frame, because
+    // the pointers are different from run to run.
+    FILE *dump;
+    SDL_Texture *dump_textures[SPRITE_BATCH_DUMP_TEXTURES_CAPACITY];
+    size_t dump_textures_count;
+
+    void begin_frame(SDL_Renderer *renderer);
+    void push(Sprite_Batch_Quad quad);
+    void texture(Sprite_Layer layer,
+                 SDL_Texture *texture, Vec2i texture_size,
+                 SDL_Rect srcrect, Rectf dstrect,
+                 SDL_RendererFlip flip, SDL_Color color, double angle,
+                 SDL_BlendMode blend = SDL_BLENDMODE_BLEND);
+    void fill_rect(Sprite_Layer layer, Rectf rect, RGBA color);
+    void draw_rect(Sprite_Layer layer, Rectf rect, RGBA color);
+    void line(Sprite_Layer layer, Vec2f begin, Vec2f end, RGBA color);
+    size_t dump_texture_id(SDL_Texture *texture);
+    void dump_group(const Sprite_Batch_Group *group, size_t begin);
+    void flush();
+};
+
+#endif  // SOMETHING_SPRITE_BATCH_HPP_
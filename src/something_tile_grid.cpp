@@ -22,10 +22,35 @@ Tile Tile_Grid::get_tile(Vec2i coord)
     return TILE_EMPTY;
 }
 
+void Tile_Grid::mark_chunk_dirty(Vec2i coord)
+{
+    if (is_tile_coord_inbounds(coord)) {
+        dirty_chunks[coord.y / TILE_CHUNK_SIZE][coord.x / TILE_CHUNK_SIZE] = true;
+    }
+}
+
+void Tile_Grid::mark_tile_changed(Vec2i coord)
+{
+    mark_chunk_dirty(coord);
+
+    if (changes_count < TILE_CHANGES_CAPACITY) {
+        changes[changes_count++] = coord;
+    } else {
+        changes_overflow = true;
+    }
+}
+
+void Tile_Grid::mark_all_tiles_changed()
+{
+    changes_count = 0;
+    changes_overflow = true;
+}
+
 void Tile_Grid::set_tile(Vec2i coord, Tile tile)
 {
     if (is_tile_coord_inbounds(coord)) {
         tiles[coord.y][coord.x] = tile;
+        mark_tile_changed(coord);
     }
 }
 
@@ -33,6 +58,7 @@ void Tile_Grid::copy_tile(Vec2i coord_dst, Vec2i coord_src)
 {
     if (is_tile_coord_inbounds(coord_dst) && is_tile_coord_inbounds(coord_src)) {
         tiles[coord_dst.y][coord_dst.x] = tiles[coord_src.y][coord_src.x];
+        mark_tile_changed(coord_dst);
     }
 }
 
@@ -56,12 +82,52 @@ Tile *Tile_Grid::tile_at_abs(Vec2f pos)
     return NULL;
 }
 
-void Tile_Grid::render(SDL_Renderer *renderer, Camera camera, Recti *lock)
+Vec2i camera_tile_begin(Camera camera)
+{
+    return vec2(
+        (int) floorf((camera.pos.x - SCREEN_WIDTH  * 0.5f) / TILE_SIZE),
+        (int) floorf((camera.pos.y - SCREEN_HEIGHT * 0.5f) / TILE_SIZE));
+}
+
+Vec2i camera_tile_end(Camera camera)
+{
+    return vec2(
+        (int) floorf((camera.pos.x + SCREEN_WIDTH  * 0.5f) / TILE_SIZE),
+        (int) floorf((camera.pos.y + SCREEN_HEIGHT * 0.5f) / TILE_SIZE));
+}
+
+void Tile_Grid::copy_window(Tile_Window *window, Camera camera)
+{
+    window->origin = camera_tile_begin(camera) - vec2(0, 1);
+
+    for (int y = 0; y < TILE_WINDOW_HEIGHT; ++y) {
+        for (int x = 0; x < TILE_WINDOW_WIDTH; ++x) {
+            window->tiles[y][x] = get_tile(window->origin + vec2(x, y));
+        }
+    }
+}
+
+Tile Tile_Window::get_tile(Vec2i coord) const
+{
+    const Vec2i p = coord - origin;
+    if (0 <= p.x && p.x < TILE_WINDOW_WIDTH &&
+        0 <= p.y && p.y < TILE_WINDOW_HEIGHT)
+    {
+        return tiles[p.y][p.x];
+    }
+
+    return TILE_EMPTY;
+}
+
+bool Tile_Window::is_tile_empty_tile(Vec2i coord) const
+{
+    return !tile_defs[get_tile(coord)].is_collidable;
+}
+
+void Tile_Window::render(Sprite_Batch *batch, Camera camera, const Recti *lock) const
 {
-    const Vec2i begin = abs_to_tile_coord(
-        camera.pos - vec2(SCREEN_WIDTH, SCREEN_HEIGHT) * 0.5f);
-    const Vec2i end = abs_to_tile_coord(
-        camera.pos + vec2(SCREEN_WIDTH, SCREEN_HEIGHT) * 0.5f);
+    const Vec2i begin = camera_tile_begin(camera);
+    const Vec2i end = camera_tile_end(camera);
 
     for (int y = begin.y; y <= end.y; ++y) {
         for (int x = begin.x; x <= end.x; ++x) {
@@ -78,9 +144,9 @@ void Tile_Grid::render(SDL_Renderer *renderer, Camera camera, Recti *lock)
             }
 
             if (is_tile_empty_tile(vec2(coord.x, coord.y - 1))) {
-                tile_defs[tile].top_texture.render(renderer, dstrect, SDL_FLIP_NONE, shade_color);
+                tile_defs[tile].top_texture.render(batch, SPRITE_LAYER_TILES, dstrect, SDL_FLIP_NONE, shade_color);
             } else {
-                tile_defs[tile].bottom_texture.render(renderer, dstrect, SDL_FLIP_NONE, shade_color);
+                tile_defs[tile].bottom_texture.render(batch, SPRITE_LAYER_TILES, dstrect, SDL_FLIP_NONE, shade_color);
             }
         }
     }
@@ -200,7 +266,8 @@ void fill_rect(SDL_Renderer *renderer, Camera *camera,
     sec(SDL_RenderFillRect(renderer, &rect));
 }
 
-void Tile_Grid::render_debug_bfs_overlay(SDL_Renderer *renderer, Camera *camera, Recti *lock)
+void render_debug_bfs_overlay(SDL_Renderer *renderer, Camera *camera, const Recti *lock,
+                              const int bfs_trace[ROOM_WIDTH][ROOM_HEIGHT])
 {
     for (int y = 0; y < lock->h; ++y) {
         for (int x = 0; x < lock->w; ++x) {
@@ -244,6 +311,8 @@ void Tile_Grid::load_from_file(const char *filepath)
 
     size_t n = fread(tiles, sizeof(Tile), TILE_GRID_WIDTH * TILE_GRID_HEIGHT, f);
     assert(n == TILE_GRID_WIDTH * TILE_GRID_HEIGHT);
+    memset(dirty_chunks, 1, sizeof(dirty_chunks));
+    mark_all_tiles_changed();
 
     fclose(f);
 }
@@ -267,6 +336,7 @@ void Tile_Grid::load_room_from_file(const char *filepath, Vec2i coord)
             size_t y = coord.y + dy;
             if (x < (size_t) TILE_GRID_WIDTH && y < (size_t) TILE_GRID_HEIGHT) {
                 tiles[y][x] = tmp[dy][dx];
+                mark_tile_changed(vec2((int) x, (int) y));
             }
         }
     }
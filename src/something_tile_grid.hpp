@@ -18,6 +18,17 @@ const Tile TILE_COUNT  = 10;
 const size_t TILE_GRID_WIDTH = 4096;
 const size_t TILE_GRID_HEIGHT = 4096;
 
+// NOTE: The grid is split into chunks to keep track of which parts of
+// it have ever been modified. Only those are stored in the save states.
+const int TILE_CHUNK_SIZE = 32;
+const size_t TILE_CHUNKS_WIDTH = TILE_GRID_WIDTH / TILE_CHUNK_SIZE;
+const size_t TILE_CHUNKS_HEIGHT = TILE_GRID_HEIGHT / TILE_CHUNK_SIZE;
+
+// NOTE: how many tile modifications are remembered between the
+// navigation graph updates (see something_nav.cpp). If there are more
+// of them the whole graph is rebuilt.
+const size_t TILE_CHANGES_CAPACITY = 256;
+
 struct Tile_Def
 {
     bool is_collidable;
@@ -85,14 +96,43 @@ struct Queue
 
 using Room_Queue = Queue<Vec2i, ROOM_WIDTH * ROOM_HEIGHT>;
 
+// NOTE: Tile_Window is a copy of the part of the Tile_Grid that is
+// visible through the camera. It is what the renderer sees instead of
+// the whole Tile_Grid (see something_snapshot.hpp). One extra row on
+// top is needed to pick between top and bottom textures.
+const int TILE_WINDOW_WIDTH  = (int) (SCREEN_WIDTH  / TILE_SIZE) + 3;
+const int TILE_WINDOW_HEIGHT = (int) (SCREEN_HEIGHT / TILE_SIZE) + 4;
+
+struct Tile_Window
+{
+    Vec2i origin;
+    Tile tiles[TILE_WINDOW_HEIGHT][TILE_WINDOW_WIDTH];
+
+    Tile get_tile(Vec2i coord) const;
+    bool is_tile_empty_tile(Vec2i coord) const;
+    void render(Sprite_Batch *batch, Camera camera, const Recti *lock) const;
+};
+
+Vec2i camera_tile_begin(Camera camera);
+Vec2i camera_tile_end(Camera camera);
+
 struct Tile_Grid
 {
     Tile tiles[TILE_GRID_HEIGHT][TILE_GRID_WIDTH];
+    bool dirty_chunks[TILE_CHUNKS_HEIGHT][TILE_CHUNKS_WIDTH];
+
+    Vec2i changes[TILE_CHANGES_CAPACITY];
+    size_t changes_count;
+    bool changes_overflow;
+
+    void mark_chunk_dirty(Vec2i coord);
+    void mark_tile_changed(Vec2i coord);
+    void mark_all_tiles_changed();
 
     void load_from_file(const char *filepath);
     void load_room_from_file(const char *filepath, Vec2i coord);
 
-    void render(SDL_Renderer *renderer, Camera camera, Recti *lock);
+    void copy_window(Tile_Window *window, Camera camera);
     void resolve_point_collision(Vec2f *origin);
     Vec2i abs_to_tile_coord(Vec2f pos);
 
@@ -110,8 +150,10 @@ struct Tile_Grid
     int bfs_trace[ROOM_WIDTH][ROOM_HEIGHT];
     void bfs_to_tile(Vec2i src, Recti *lock);
     Maybe<Vec2i> next_in_bfs(Vec2i dst0, Recti *lock);
-    void render_debug_bfs_overlay(SDL_Renderer *renderer, Camera *camera, Recti *lock);
     bool a_sees_b(Vec2f a, Vec2f b);
 };
 
+void render_debug_bfs_overlay(SDL_Renderer *renderer, Camera *camera, const Recti *lock,
+                              const int bfs_trace[ROOM_WIDTH][ROOM_HEIGHT]);
+
 #endif  // TILE_GRID_HPP_
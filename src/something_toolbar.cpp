@@ -44,41 +44,37 @@ Rectf Toolbar::button_hitbox(size_t button)
     return hitbox;
 }
 
-void Toolbar::render(SDL_Renderer *renderer, Bitmap_Font font)
+void Toolbar::snapshot(Toolbar_Snapshot *output) const
+{
+    output->buttons_count = buttons_count;
+    output->active_button = active_button;
+    output->hovered_button = hovered_button;
+    output->tooltip_position = tooltip_position;
+
+    for (size_t i = 0; i < buttons_count; ++i) {
+        output->icons[i] = buttons[i].icon;
+        output->tooltips[i] = buttons[i].tooltip;
+    }
+}
+
+void Toolbar_Snapshot::render(Sprite_Batch *batch, Bitmap_Font font) const
 {
     for (size_t i = 0; i < buttons_count; ++i) {
-        SDL_Color shade = {};
+        auto hitbox = Toolbar::button_hitbox(i);
+
+        batch->fill_rect(SPRITE_LAYER_UI_BACKGROUND, hitbox, TOOLBAR_BUTTON_COLOR);
+        icons[i].render(batch, SPRITE_LAYER_UI_ICONS, rect_shrink(hitbox, TOOLBAR_BUTTON_ICON_PADDING));
 
         if (i != active_button) {
-            shade = rgba_to_sdl(TOOLBAR_INACTIVE_SHADE);
+            batch->fill_rect(SPRITE_LAYER_UI_SHADE, hitbox, TOOLBAR_INACTIVE_SHADE);
         }
-
-        auto hitbox = button_hitbox(i);
-        const auto shade_rect = rectf_for_sdl(hitbox);
-
-        const SDL_Color toolbar_button_color = rgba_to_sdl(TOOLBAR_BUTTON_COLOR);
-        sec(SDL_SetRenderDrawColor(
-                renderer,
-                toolbar_button_color.r,
-                toolbar_button_color.g,
-                toolbar_button_color.b,
-                toolbar_button_color.a));
-        sec(SDL_RenderFillRect(renderer, &shade_rect));
-
-        buttons[i].icon.render(renderer, rect_shrink(hitbox, TOOLBAR_BUTTON_ICON_PADDING));
-
-        sec(SDL_SetRenderDrawColor(
-                renderer,
-                shade.r,
-                shade.g,
-                shade.b,
-                shade.a));
-        sec(SDL_RenderFillRect(renderer, &shade_rect));
     }
+    batch->flush();
 
+    SDL_Renderer *renderer = batch->renderer;
     if (hovered_button.has_value) {
         render_tooltip(renderer, font,
-                       buttons[hovered_button.unwrap].tooltip,
+                       tooltips[hovered_button.unwrap],
                        tooltip_position);
     }
 }
@@ -65,6 +65,20 @@ struct Button
 
 const size_t TOOLBAR_BUTTONS_CAPACITY =  69;
 
+// NOTE: Toolbar_Snapshot does not copy the Tools of the buttons,
+// only what is needed to draw them.
+struct Toolbar_Snapshot
+{
+    Sprite icons[TOOLBAR_BUTTONS_CAPACITY];
+    String_View tooltips[TOOLBAR_BUTTONS_CAPACITY];
+    size_t buttons_count;
+    size_t active_button;
+    Maybe<size_t> hovered_button;
+    Vec2f tooltip_position;
+
+    void render(Sprite_Batch *batch, Bitmap_Font font) const;
+};
+
 struct Toolbar
 {
     Button buttons[TOOLBAR_BUTTONS_CAPACITY];
@@ -73,10 +87,10 @@ struct Toolbar
     Maybe<size_t> hovered_button;
     Vec2f tooltip_position;
 
-    void render(SDL_Renderer *renderer, Bitmap_Font font);
+    void snapshot(Toolbar_Snapshot *output) const;
     bool handle_click_at(Vec2f position);
     bool handle_mouse_hover(Vec2f position);
-    Rectf button_hitbox(size_t button);
+    static Rectf button_hitbox(size_t button);
 };
 
 #endif  // SOMETHING_TOOLBAR_HPP_
@@ -0,0 +1,301 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#  include <direct.h>
+#endif // _WIN32
+
+#include "./something_wav.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif // __SSE2__
+
+void free_sample_s16(Sample_S16 sample)
+{
+    SDL_free(sample.audio_buf);
+}
+
+// NOTE: averages the channels of every frame. Stereo (which is most of
+// the sounds that are not mono already) is done 8 frames at a time,
+// the vector code floors the same way the scalar code does.
+static void wav_downmix(int16_t *output, const int16_t *input, size_t frames_count, size_t channels)
+{
+    size_t i = 0;
+    if (channels == 2) {
+#if defined(__SSE2__)
+        const __m128i ones = _mm_set1_epi16(1);
+        for (; i + 8 <= frames_count; i += 8) {
+            const __m128i a = _mm_madd_epi16(_mm_loadu_si128((const __m128i*) (input + 2 * i)), ones);
+            const __m128i b = _mm_madd_epi16(_mm_loadu_si128((const __m128i*) (input + 2 * i + 8)), ones);
+            _mm_storeu_si128((__m128i*) (output + i),
+                             _mm_packs_epi32(_mm_srai_epi32(a, 1), _mm_srai_epi32(b, 1)));
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 8 <= frames_count; i += 8) {
+            const int16x8x2_t x = vld2q_s16(input + 2 * i);
+            vst1q_s16(output + i, vhaddq_s16(x.val[0], x.val[1]));
+        }
+#endif // __SSE2__
+        for (; i < frames_count; ++i) {
+            output[i] = (int16_t) (((int) input[2 * i] + (int) input[2 * i + 1]) >> 1);
+        }
+        return;
+    }
+
+    for (; i < frames_count; ++i) {
+        int sum = 0;
+        for (size_t c = 0; c < channels; ++c) {
+            sum += input[i * channels + c];
+        }
+        output[i] = (int16_t) (sum / (int) channels);
+    }
+}
+
+// NOTE: the position in the input is 32.32 fixed point and the weight
+// of the next input sample is Q14, so a pair of neighbouring samples
+// is interpolated with a single multiply-add of 16 bit lanes
+const uint64_t WAV_ONE = 1ULL << 32;
+const int WAV_WEIGHT_ONE = 1 << 14;
+
+static inline uint32_t wav_pair(const int16_t *input, uint64_t position)
+{
+    uint32_t pair;
+    memcpy(&pair, input + (position >> 32), sizeof(pair));
+    return pair;
+}
+
+static inline int wav_weight(uint64_t position)
+{
+    return (int) ((position >> 18) & (uint64_t) (WAV_WEIGHT_ONE - 1));
+}
+
+// NOTE: linear interpolation. The input has one more sample at the end
+// (a copy of the last one), so the pair of the last output sample is
+// always in bounds.
+static void wav_resample(int16_t *output, size_t output_count, const int16_t *input, uint64_t step)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= output_count; i += 8) {
+        __m128i sums[2];
+        for (size_t half = 0; half < 2; ++half) {
+            uint32_t pairs[4];
+            uint32_t weights[4];
+            for (size_t j = 0; j < 4; ++j) {
+                const uint64_t position = (uint64_t) (i + half * 4 + j) * step;
+                const int w = wav_weight(position);
+                pairs[j] = wav_pair(input, position);
+                weights[j] = ((uint32_t) w << 16) | (uint32_t) (WAV_WEIGHT_ONE - w);
+            }
+            const __m128i p = _mm_loadu_si128((const __m128i*) pairs);
+            const __m128i w = _mm_loadu_si128((const __m128i*) weights);
+            sums[half] = _mm_srai_epi32(_mm_madd_epi16(p, w), 14);
+        }
+        _mm_storeu_si128((__m128i*) (output + i), _mm_packs_epi32(sums[0], sums[1]));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= output_count; i += 4) {
+        int16_t a[4], b[4], wa[4], wb[4];
+        for (size_t j = 0; j < 4; ++j) {
+            const uint64_t position = (uint64_t) (i + j) * step;
+            const int w = wav_weight(position);
+            a[j] = input[position >> 32];
+            b[j] = input[(position >> 32) + 1];
+            wa[j] = (int16_t) (WAV_WEIGHT_ONE - w);
+            wb[j] = (int16_t) w;
+        }
+        const int32x4_t sum = vmlal_s16(vmull_s16(vld1_s16(a), vld1_s16(wa)), vld1_s16(b), vld1_s16(wb));
+        vst1_s16(output + i, vmovn_s32(vshrq_n_s32(sum, 14)));
+    }
+#endif // __SSE2__
+    for (; i < output_count; ++i) {
+        const uint64_t position = (uint64_t) i * step;
+        const int w = wav_weight(position);
+        const int a = input[position >> 32];
+        const int b = input[(position >> 32) + 1];
+        output[i] = (int16_t) ((a * (WAV_WEIGHT_ONE - w) + b * w) >> 14);
+    }
+}
+
+static Sample_S16 wav_convert(const void *wav_data, size_t wav_size, const char *file_path)
+{
+    SDL_AudioSpec spec = {};
+    Uint8 *audio_buf = NULL;
+    Uint32 audio_len = 0;
+    if (SDL_LoadWAV_RW(SDL_RWFromConstMem(wav_data, (int) wav_size), 1,
+                       &spec, &audio_buf, &audio_len) == nullptr) {
+        println(stderr, "SDL pooped itself: Failed to load ", file_path, ": ", SDL_GetError());
+        abort();
+    }
+    defer(SDL_FreeWAV(audio_buf));
+
+    // NOTE: SDL only changes the sample format here, the channels and
+    // the rate are done by wav_downmix() and wav_resample()
+    SDL_AudioCVT cvt = {};
+    const int needed = SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                                         AUDIO_S16SYS, spec.channels, spec.freq);
+    if (needed < 0 || spec.channels == 0 || spec.freq <= 0) {
+        println(stderr, "SDL pooped itself: Failed to convert ", file_path, ": ", SDL_GetError());
+        abort();
+    }
+
+    Uint8 *converted = NULL;
+    defer(SDL_free(converted));
+    const int16_t *frames = (const int16_t*) audio_buf;
+    size_t frames_size = audio_len;
+    if (needed > 0) {
+        converted = (Uint8*) SDL_malloc((size_t) audio_len * (size_t) cvt.len_mult);
+        assert(converted != NULL);
+        memcpy(converted, audio_buf, audio_len);
+        cvt.buf = converted;
+        cvt.len = (int) audio_len;
+        if (SDL_ConvertAudio(&cvt) < 0) {
+            println(stderr, "SDL pooped itself: Failed to convert ", file_path, ": ", SDL_GetError());
+            abort();
+        }
+        frames = (const int16_t*) cvt.buf;
+        frames_size = (size_t) cvt.len_cvt;
+    }
+
+    const size_t channels = spec.channels;
+    const size_t frames_count = frames_size / (sizeof(int16_t) * channels);
+
+    int16_t *mono = (int16_t*) malloc((frames_count + 1) * sizeof(int16_t));
+    assert(mono != NULL);
+    defer(free(mono));
+    wav_downmix(mono, frames, frames_count, channels);
+    mono[frames_count] = frames_count > 0 ? mono[frames_count - 1] : 0;
+
+    const uint64_t freq = (uint64_t) spec.freq;
+    Sample_S16 sample = {};
+    sample.audio_len = (Uint32) (frames_count * SOMETHING_SOUND_FREQ / freq);
+    sample.audio_buf = (int16_t*) SDL_malloc(max((size_t) sample.audio_len, (size_t) 1) * sizeof(int16_t));
+    assert(sample.audio_buf != NULL);
+
+    if (freq == SOMETHING_SOUND_FREQ) {
+        memcpy(sample.audio_buf, mono, sample.audio_len * sizeof(int16_t));
+    } else {
+        wav_resample(sample.audio_buf, sample.audio_len, mono, (freq * WAV_ONE) / SOMETHING_SOUND_FREQ);
+    }
+
+    return sample;
+}
+
+static bool wav_cache_load(const char *cache_path, uint64_t hash, Sample_S16 *sample)
+{
+    FILE *cache = fopen(cache_path, "rb");
+    if (cache == NULL) {
+        return false;
+    }
+    defer(fclose(cache));
+
+    Wav_Cache_Header header = {};
+    if (fread(&header, sizeof(header), 1, cache) != 1 ||
+        header.magic != WAV_CACHE_MAGIC ||
+        header.version != WAV_CACHE_VERSION ||
+        header.freq != SOMETHING_SOUND_FREQ ||
+        header.channels != SOMETHING_SAMPLE_CHANNELS ||
+        header.hash != hash ||
+        header.samples_count > UINT32_MAX) {
+        return false;
+    }
+
+    Sample_S16 result = {};
+    result.audio_len = (Uint32) header.samples_count;
+    result.audio_buf = (int16_t*) SDL_malloc(max((size_t) result.audio_len, (size_t) 1) * sizeof(int16_t));
+    assert(result.audio_buf != NULL);
+
+    // NOTE: a cache file that was cut short (the game was killed while
+    // writing it) is converted again
+    if (fread(result.audio_buf, sizeof(int16_t), result.audio_len, cache) != result.audio_len) {
+        free_sample_s16(result);
+        return false;
+    }
+
+    *sample = result;
+    return true;
+}
+
+static void wav_cache_save(const char *cache_path, uint64_t hash, Sample_S16 sample)
+{
+#ifdef _WIN32
+    _mkdir(WAV_CACHE_DIR_PATH);
+#else
+    mkdir(WAV_CACHE_DIR_PATH, 0755);
+#endif // _WIN32
+
+    // NOTE: the sounds are loaded on several threads and two assets
+    // may have the same content, so the file is written under a name
+    // of its own and renamed into place when it is complete
+    char temp_path[WAV_CACHE_PATH_CAPACITY];
+    const int n = snprintf(temp_path, sizeof(temp_path), "%s.%lu.tmp", cache_path, (unsigned long) SDL_ThreadID());
+    if (n < 0 || (size_t) n >= sizeof(temp_path)) {
+        return;
+    }
+
+    FILE *cache = fopen(temp_path, "wb");
+    if (cache == NULL) {
+        println(stderr, "[WARN] Could not cache the sound into ", temp_path, ": ", strerror(errno));
+        return;
+    }
+
+    Wav_Cache_Header header = {};
+    header.magic = WAV_CACHE_MAGIC;
+    header.version = WAV_CACHE_VERSION;
+    header.freq = SOMETHING_SOUND_FREQ;
+    header.channels = SOMETHING_SAMPLE_CHANNELS;
+    header.hash = hash;
+    header.samples_count = sample.audio_len;
+
+    const bool written =
+        fwrite(&header, sizeof(header), 1, cache) == 1 &&
+        fwrite(sample.audio_buf, sizeof(int16_t), sample.audio_len, cache) == sample.audio_len;
+    fclose(cache);
+
+    remove(cache_path);
+    if (!written || rename(temp_path, cache_path) != 0) {
+        println(stderr, "[WARN] Could not cache the sound into ", cache_path, ": ", strerror(errno));
+        remove(temp_path);
+    }
+}
+
+Sample_S16 load_wav_as_sample_s16(const char *file_path)
+{
+    auto wav = read_file_as_string_view(file_path);
+    if (!wav.has_value) {
+        println(stderr, "Failed to load ", file_path, ": ", strerror(errno));
+        abort();
+    }
+    defer(free((void*) wav.unwrap.data));
+
+    // NOTE: the file names of the cache come from the hash
+    const uint64_t hash = fnv1a_64(wav.unwrap.data, wav.unwrap.count);
+    char cache_path[WAV_CACHE_PATH_CAPACITY];
+    snprintf(cache_path, sizeof(cache_path), "%s/%016llx.s16", WAV_CACHE_DIR_PATH, (unsigned long long) hash);
+
+    Sample_S16 sample = {};
+    if (wav_cache_load(cache_path, hash, &sample)) {
+        return sample;
+    }
+
+    const Uint64 begin = SDL_GetPerformanceCounter();
+    sample = wav_convert(wav.unwrap.data, wav.unwrap.count, file_path);
+    wav_cache_save(cache_path, hash, sample);
+    println(stdout, "Converted ", file_path, " in ",
+            (float) (SDL_GetPerformanceCounter() - begin) / (float) SDL_GetPerformanceFrequency() * 1000.0f, "ms");
+
+    return sample;
+}
+
+Sample_S16 load_wav_as_sample_s16(String_View file_path)
+{
+    char *filepath_cstr = (char*) malloc(file_path.count + 1);
+    assert(filepath_cstr != NULL);
+    memcpy(filepath_cstr, file_path.data, file_path.count);
+    filepath_cstr[file_path.count] = '\0';
+    auto result = load_wav_as_sample_s16(filepath_cstr);
+    free(filepath_cstr);
+    return result;
+}
@@ -0,0 +1,35 @@
+#ifndef SOMETHING_WAV_HPP_
+#define SOMETHING_WAV_HPP_
+
+#include "./something_sound.hpp"
+#include "./something_parsers.hpp"
+
+// NOTE: the sounds can be any WAV that SDL is able to load, in any
+// sample format, rate and amount of channels. They are converted into
+// the format of the mixer (signed 16 bit, SOMETHING_SOUND_FREQ,
+// SOMETHING_SAMPLE_CHANNELS) when they are loaded the first time and
+// the result is saved into WAV_CACHE_DIR_PATH under the hash of the
+// content of the file. The next loads of the same content read the
+// converted samples from there and skip the conversion.
+const char *const WAV_CACHE_DIR_PATH = "./.cache";
+const size_t WAV_CACHE_PATH_CAPACITY = 256;
+const uint32_t WAV_CACHE_MAGIC = 0x4C504D53; // "SMPL"
+const uint32_t WAV_CACHE_VERSION = 1;
+
+struct Wav_Cache_Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t freq;
+    uint32_t channels;
+    uint64_t hash;
+    uint64_t samples_count;
+};
+
+// NOTE: the sample is allocated with SDL_malloc() and is freed with
+// free_sample_s16()
+Sample_S16 load_wav_as_sample_s16(const char *file_path);
+Sample_S16 load_wav_as_sample_s16(String_View file_path);
+void free_sample_s16(Sample_S16 sample);
+
+#endif  // SOMETHING_WAV_HPP_
@@ -1,24 +1,34 @@
 #include "./something_game.hpp"
 #include "./something_weapon.hpp"
 
-void Weapon::render(SDL_Renderer *renderer, Game *game, Entity_Index entity)
+Weapon_Preview Weapon::preview(Game *game, Entity_Index entity)
 {
+    Weapon_Preview result = {};
+
     switch (type) {
     case Weapon_Type::Gun: {} break;
     case Weapon_Type::Placer: {
         bool can_place = false;
         auto target_tile = game->where_entity_can_place_block(entity, &can_place);
         can_place = can_place && placer.amount > 0;
-        tile_defs[placer.tile].top_texture.render(
-            renderer,
-            rect(game->camera.to_screen(
-                     vec2((float) target_tile.x,
-                          (float) target_tile.y) * TILE_SIZE),
-                 TILE_SIZE, TILE_SIZE),
-            SDL_FLIP_NONE,
-            can_place ? CAN_PLACE_BLOCK_COLOR : CANNOT_PLACE_BLOCK_COLOR);
+        result.visible = true;
+        result.sprite = tile_defs[placer.tile].top_texture;
+        result.rect = rect(
+            vec2((float) target_tile.x,
+                 (float) target_tile.y) * TILE_SIZE,
+            TILE_SIZE, TILE_SIZE);
+        result.shade = can_place ? CAN_PLACE_BLOCK_COLOR : CANNOT_PLACE_BLOCK_COLOR;
     } break;
     }
+
+    return result;
+}
+
+void Weapon_Preview::render(Sprite_Batch *batch, Camera camera) const
+{
+    if (visible) {
+        sprite.render(batch, SPRITE_LAYER_WEAPON_PREVIEW, camera.to_screen(rect), SDL_FLIP_NONE, shade);
+    }
 }
 
 void Weapon::shoot(Game *game, Entity_Index shooter)
@@ -47,9 +57,9 @@ Sprite Weapon::icon() const
 {
     switch (type) {
     case Weapon_Type::Gun: {
-        auto frames = assets.get_frames_by_index(gun.projectile.active_animat.frames_index);
-        assert(frames.count > 0);
-        return frames.sprites[0];
+        const Frames *frames = assets.get_frames_by_index(gun.projectile.active_animat.frames_index);
+        assert(frames->count > 0);
+        return frames->sprites[0];
     }
 
     case Weapon_Type::Placer:
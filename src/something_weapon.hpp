@@ -22,6 +22,18 @@ enum class Weapon_Type
     Placer,
 };
 
+// NOTE: what the current weapon wants to draw on top of the world,
+// like the block placement marker of the Placer.
+struct Weapon_Preview
+{
+    bool visible;
+    Sprite sprite;
+    Rectf rect;
+    RGBA shade;
+
+    void render(Sprite_Batch *batch, Camera camera) const;
+};
+
 struct Weapon
 {
     Weapon_Type type;
@@ -30,7 +42,7 @@ struct Weapon
 
     Maybe<Sample_S16_Index> shoot_sample;
 
-    void render(SDL_Renderer *renderer, Game *game, Entity_Index entity);
+    Weapon_Preview preview(Game *game, Entity_Index entity);
     void shoot(Game *game, Entity_Index shooter);
     Sprite icon() const;
 };